@@ -0,0 +1,37 @@
+# Builds the DSP routines as a plain host library plus a test driver, so the
+# kernels can be validated and benchmarked on Linux without the Hexagon SDK.
+#
+#   make -f build/host.mk
+#   ./host/hetcompute_dsp_host_bench [image.tga] [num_tiles]
+#   ./host/hetcompute_gemm_host_bench [matrix_size] [num_tiles]
+
+CC      ?= gcc
+CFLAGS  ?= -O2
+OUT     ?= host
+
+HOST_CFLAGS = $(CFLAGS) -std=gnu99 -fPIC -Iinclude -I../../include -DHETCOMPUTE_DSP_HOST_BUILD
+
+all: $(OUT)/libhetcompute_dsp_host.a $(OUT)/libhetcompute_dsp_host.so $(OUT)/hetcompute_dsp_host_bench $(OUT)/hetcompute_gemm_host_bench
+
+$(OUT):
+	mkdir -p $(OUT)
+
+$(OUT)/hetcompute_dsp_imp.o: src/hetcompute_dsp_imp.c src/macrodefinitions_dsp_1d.h src/macrodefinitions_dsp_2d.h include/hetcompute_dsp.h ../../include/hetcompute/gemm.h | $(OUT)
+	$(CC) $(HOST_CFLAGS) -c $< -o $@
+
+$(OUT)/libhetcompute_dsp_host.a: $(OUT)/hetcompute_dsp_imp.o
+	$(AR) rcs $@ $^
+
+$(OUT)/libhetcompute_dsp_host.so: $(OUT)/hetcompute_dsp_imp.o
+	$(CC) -shared $^ -o $@ -lm
+
+$(OUT)/hetcompute_dsp_host_bench: src/hetcompute_dsp_host_bench.c $(OUT)/libhetcompute_dsp_host.a
+	$(CC) $(HOST_CFLAGS) $^ -o $@ -lm
+
+$(OUT)/hetcompute_gemm_host_bench: src/hetcompute_gemm_host_bench.c $(OUT)/libhetcompute_dsp_host.a
+	$(CC) $(HOST_CFLAGS) $^ -o $@ -lm
+
+clean:
+	rm -rf $(OUT)
+
+.PHONY: all clean
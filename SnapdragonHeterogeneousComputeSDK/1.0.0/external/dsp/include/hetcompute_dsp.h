@@ -47,10 +47,14 @@ __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_vadd)(int first, int last,
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_constant_add)(int first, int last, const float* avec, int avecLen, float* cvec, int cvecLen) __QAIC_HEADER_ATTRIBUTE;
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_vwrite)(int first, int last, float* avec, int avecLen, int val) __QAIC_HEADER_ATTRIBUTE;
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_matmul)(int first_x, int last_x, int first_y, int last_y, const float* avec, int avecLen, const float* bvec, int bvecLen, float* cvec, int cvecLen, int M, int N, int P) __QAIC_HEADER_ATTRIBUTE;
+__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_gemm_f32)(int first_x, int last_x, int first_y, int last_y, const float* a, int aLen, const float* b, int bLen, float* c, int cLen, int M, int N, int K) __QAIC_HEADER_ATTRIBUTE;
+__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_gemm_s16)(int first_x, int last_x, int first_y, int last_y, const int16* a, int aLen, const int16* b, int bLen, int16* c, int cLen, int M, int N, int K, int shift) __QAIC_HEADER_ATTRIBUTE;
+__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_gemm_s8)(int first_x, int last_x, int first_y, int last_y, const int8* a, int aLen, const int8* b, int bLen, int8* c, int cLen, int M, int N, int K, int shift) __QAIC_HEADER_ATTRIBUTE;
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_math_cbrt)(int first, int last, const float* a, int aLen, float* b, int bLen, int sz) __QAIC_HEADER_ATTRIBUTE;
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_matrix_buffer)(const int* matrixA, int matrixALen, int* matrixB, int matrixBLen) __QAIC_HEADER_ATTRIBUTE;
 __QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_compute_intensity_dist_weight_table)(float* simTable, int simTableLen) __QAIC_HEADER_ATTRIBUTE;
-__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_denoise_image_process)(char* input_buffer, int input_buffer_len, float* output_buffer, int output_buffer_len, const float* similarity_weights_buffer, int similarity_weights_buffer_len, const int searchWindowSize, const int similarityWindowSize, const int imgWidth, const int imgHeight, const int width, const int height) __QAIC_HEADER_ATTRIBUTE;
+__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_denoise_image_process)(const char* input_buffer, int input_buffer_len, float* output_buffer, int output_buffer_len, const float* similarity_weights_buffer, int similarity_weights_buffer_len, const int searchWindowSize, const int similarityWindowSize, const int imgWidth, const int imgHeight, const int width, const int height) __QAIC_HEADER_ATTRIBUTE;
+__QAIC_HEADER_EXPORT int __QAIC_HEADER(hetcompute_dsp_denoise_image_process_tile)(int first_x, int last_x, int first_y, int last_y, const char* input_buffer, int input_buffer_len, float* output_buffer, int output_buffer_len, const float* similarity_weights_buffer, int similarity_weights_buffer_len, int searchWindowSize, int similarityWindowSize, int imgWidth, int imgHeight) __QAIC_HEADER_ATTRIBUTE;
 #ifdef __cplusplus
 }
 #endif
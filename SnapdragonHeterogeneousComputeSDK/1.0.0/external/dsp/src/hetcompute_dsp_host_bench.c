@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "hetcompute_dsp.h"
+
+/* Host driver that validates hetcompute_dsp_denoise_image_process_tile
+ * against the per-pixel hetcompute_dsp_denoise_image_process and times both.
+ * Built by build/host.mk. */
+
+#define MAX_DIST (255 * 255)
+#define SEARCH_WINDOW_SIZE 21
+#define SIMILARITY_WINDOW_SIZE 7
+
+static double
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Loads an uncompressed 8-bit gray TGA, or makes a noisy gradient if path is NULL. */
+static char*
+load_image(const char* path, int* width, int* height)
+{
+    char* image;
+    if (path == NULL) {
+        *width  = 128;
+        *height = 96;
+        image   = malloc(*width * *height);
+        srand(1);
+        for (int i = 0; i < *width * *height; i++) {
+            image[i] = (char)((i % *width) + (rand() % 32));
+        }
+        return image;
+    }
+
+    FILE* file = fopen(path, "rb");
+    unsigned char header[18];
+    if (file == NULL || fread(header, 1, sizeof(header), file) != sizeof(header) || header[16] != 8) {
+        printf("Could not read 8-bit gray TGA image %s\n", path);
+        exit(1);
+    }
+    *width  = header[12] | (header[13] << 8);
+    *height = header[14] | (header[15] << 8);
+    image   = malloc(*width * *height);
+    if (fread(image, 1, *width * *height, file) != (size_t)(*width * *height)) {
+        printf("Truncated image %s\n", path);
+        exit(1);
+    }
+    fclose(file);
+    return image;
+}
+
+int
+main(int argc, char* argv[])
+{
+    int num_tiles = argc > 2 ? atoi(argv[2]) : 4;
+    int width, height;
+    char* input = load_image(argc > 1 ? argv[1] : NULL, &width, &height);
+    int size = width * height;
+
+    float* weights = malloc(MAX_DIST * sizeof(float));
+    float* per_pixel = calloc(size, sizeof(float));
+    float* tiled = calloc(size, sizeof(float));
+    hetcompute_dsp_compute_intensity_dist_weight_table(weights, MAX_DIST);
+
+    double begin = now_ms();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            hetcompute_dsp_denoise_image_process(input, size, per_pixel, size, weights, MAX_DIST,
+                                                 SEARCH_WINDOW_SIZE, SIMILARITY_WINDOW_SIZE, width, height, x, y);
+        }
+    }
+    double per_pixel_time = now_ms() - begin;
+
+    begin = now_ms();
+    int rows = (height + num_tiles - 1) / num_tiles;
+    for (int t = 0; t < num_tiles; t++) {
+        int first_y = t * rows;
+        int last_y = first_y + rows < height ? first_y + rows : height;
+        hetcompute_dsp_denoise_image_process_tile(0, width, first_y, last_y, input, size, tiled, size, weights, MAX_DIST,
+                                                  SEARCH_WINDOW_SIZE, SIMILARITY_WINDOW_SIZE, width, height);
+    }
+    double tiled_time = now_ms() - begin;
+
+    int mismatches = 0;
+    for (int i = 0; i < size; i++) {
+        mismatches += memcmp(&per_pixel[i], &tiled[i], sizeof(float)) != 0;
+    }
+
+    printf("%dx%d image: per-pixel %d calls %.1f ms, %d tiles %.1f ms, %d mismatches\n",
+           width, height, size, per_pixel_time, num_tiles, tiled_time, mismatches);
+
+    free(input);
+    free(weights);
+    free(per_pixel);
+    free(tiled);
+    return mismatches != 0;
+}
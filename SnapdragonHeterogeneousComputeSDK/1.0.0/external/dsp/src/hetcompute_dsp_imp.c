@@ -6,8 +6,14 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#ifdef HETCOMPUTE_DSP_HOST_BUILD
+// Host builds (see build/host.mk) have no Hexagon SDK logging
+#define FARF(level, ...) ((void)0)
+#else
 #include "HAP_farf.h"
+#endif
 #include "hetcompute_dsp.h"
+#include "hetcompute/gemm.h"
 #include "macrodefinitions_dsp_1d.h"
 #include "macrodefinitions_dsp_2d.h"
 
@@ -383,15 +389,18 @@ hetcompute_dsp_compute_weights(const char* input_buffer,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-int 
-hetcompute_dsp_denoise_image_process(const char* input_buffer, int input_buffer_len, 
-                                     float* output_buffer, int output_buffer_len, 
-                                     const float* similarity_weights_buffer, int similarity_weights_buffer_len, 
-                                     const int searchWindowSize, const int similarityWindowSize, 
-                                     const int imgWidth, const int imgHeight, 
-                                     const int width, const int height)
+static void
+hetcompute_dsp_denoise_pixel(const char* input_buffer,
+                             float* output_buffer,
+                             float* reusable_buffer,
+                             const float* similarity_weights_buffer,
+                             const int searchWindowSize,
+                             const int similarityWindowSize,
+                             const int imgWidth,
+                             const int imgHeight,
+                             const int width,
+                             const int height)
 {
-    float reusable_buffer[searchWindowSize * searchWindowSize];
     struct Point point;
     point.x = width;
     point.y = height;
@@ -416,6 +425,44 @@ hetcompute_dsp_denoise_image_process(const char* input_buffer, int input_buffer_
 
     temp /= weight_sum;
     output_buffer[height * imgWidth + width] = temp;
+}
+
+int 
+hetcompute_dsp_denoise_image_process(const char* input_buffer, int input_buffer_len, 
+                                     float* output_buffer, int output_buffer_len, 
+                                     const float* similarity_weights_buffer, int similarity_weights_buffer_len, 
+                                     const int searchWindowSize, const int similarityWindowSize, 
+                                     const int imgWidth, const int imgHeight, 
+                                     const int width, const int height)
+{
+    float reusable_buffer[searchWindowSize * searchWindowSize];
+    hetcompute_dsp_denoise_pixel(input_buffer, output_buffer, reusable_buffer, similarity_weights_buffer,
+                                 searchWindowSize, similarityWindowSize, imgWidth, imgHeight, width, height);
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/* Denoises the pixels in [first_x, last_x) x [first_y, last_y) in a single call,
+ * so the buffers are marshalled once per tile instead of once per pixel. */
+int
+hetcompute_dsp_denoise_image_process_tile(const int first_x, const int last_x,
+                                          const int first_y, const int last_y,
+                                          const char* input_buffer, int input_buffer_len,
+                                          float* output_buffer, int output_buffer_len,
+                                          const float* similarity_weights_buffer, int similarity_weights_buffer_len,
+                                          const int searchWindowSize, const int similarityWindowSize,
+                                          const int imgWidth, const int imgHeight)
+{
+    float reusable_buffer[searchWindowSize * searchWindowSize];
+
+    for (int height = first_y; height < last_y; height++) {
+        for (int width = first_x; width < last_x; width++) {
+            hetcompute_dsp_denoise_pixel(input_buffer, output_buffer, reusable_buffer, similarity_weights_buffer,
+                                         searchWindowSize, similarityWindowSize, imgWidth, imgHeight, width, height);
+        }
+    }
 
     return 0;
 }
@@ -446,19 +493,48 @@ HETCOMPUTE_POINT_KERNEL_1D_3(vwrite, int, i, first, last,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-HETCOMPUTE_POINT_KERNEL_2D_9(matmul, int, i,j, first_x, last_x, first_y, last_y,
-                           const float*, a, int, num_elemsa,
-                           const float*, b, int, num_elemsb,
-                           float*, c, int, num_elemsc,
-                           int, M, int, P, int, N,
-                           {
-                             if (i < M && j < N){
-                               c[i * N + j] = 0;
-                               for (int k = 0; k < P; k++) {
-                                  c[i * N + j] += a[i * P + k] * b[k * N + j];
-                               }
-                             }
-                           });
+/* C = A * B, with A M x P and B P x N, computed by the blocked GEMM of hetcompute/gemm.h */
+int
+hetcompute_dsp_matmul(int first_x, int last_x, int first_y, int last_y,
+                      const float* a, int num_elemsa,
+                      const float* b, int num_elemsb,
+                      float* c, int num_elemsc,
+                      int M, int P, int N)
+{
+    return hetcompute_gemm_f32(first_x, last_x, first_y, last_y, a, num_elemsa, b, num_elemsb, c, num_elemsc, M, N, P);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+/* The GEMM kernels compute the block of C given by the range, as their
+ * counterparts hetcompute::pgemm runs on the CPU. */
+int
+hetcompute_dsp_gemm_f32(int first_x, int last_x, int first_y, int last_y,
+                        const float* a, int aLen, const float* b, int bLen, float* c, int cLen,
+                        int M, int N, int K)
+{
+    return hetcompute_gemm_f32(first_x, last_x, first_y, last_y, a, aLen, b, bLen, c, cLen, M, N, K);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+hetcompute_dsp_gemm_s16(int first_x, int last_x, int first_y, int last_y,
+                        const int16* a, int aLen, const int16* b, int bLen, int16* c, int cLen,
+                        int M, int N, int K, int shift)
+{
+    return hetcompute_gemm_s16(first_x, last_x, first_y, last_y, a, aLen, b, bLen, c, cLen, M, N, K, shift);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+hetcompute_dsp_gemm_s8(int first_x, int last_x, int first_y, int last_y,
+                       const int8* a, int aLen, const int8* b, int bLen, int8* c, int cLen,
+                       int M, int N, int K, int shift)
+{
+    return hetcompute_gemm_s8(first_x, last_x, first_y, last_y, a, aLen, b, bLen, c, cLen, M, N, K, shift);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
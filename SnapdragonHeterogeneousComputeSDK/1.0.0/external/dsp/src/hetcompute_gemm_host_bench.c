@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "hetcompute_dsp.h"
+
+/* Host driver that validates the GEMM kernels against the naive loops they
+ * replace and times both, in float and in int16/int8 fixed point.
+ * Built by build/host.mk. */
+
+static double
+now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* The loop of the matmul point kernel before it called the GEMM */
+static void
+naive_f32(const float* a, const float* b, float* c, int M, int N, int K)
+{
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) {
+            c[i * N + j] = 0;
+            for (int k = 0; k < K; k++) {
+                c[i * N + j] += a[i * K + k] * b[k * N + j];
+            }
+        }
+    }
+}
+
+static void
+naive_fixed(const void* a, const void* b, void* c, int M, int N, int K, int shift, int is_s16)
+{
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) {
+            long long acc = 0;
+            for (int k = 0; k < K; k++) {
+                acc += is_s16 ? (long long)((const int16*)a)[i * K + k] * ((const int16*)b)[k * N + j]
+                              : (long long)((const int8*)a)[i * K + k] * ((const int8*)b)[k * N + j];
+            }
+            acc = (acc + (1LL << (shift - 1))) >> shift;
+            if (is_s16) {
+                ((int16*)c)[i * N + j] = (int16)(acc > 32767 ? 32767 : (acc < -32768 ? -32768 : acc));
+            } else {
+                ((int8*)c)[i * N + j] = (int8)(acc > 127 ? 127 : (acc < -128 ? -128 : acc));
+            }
+        }
+    }
+}
+
+static void
+report(const char* name, int n, double naive_time, double gemm_time, int mismatches)
+{
+    double gflop = 2.0 * n * n * n / 1e9;
+    printf("%-4s %dx%d: naive %.1f ms (%.2f GFLOPS), gemm %.1f ms (%.2f GFLOPS), %d mismatches\n", name, n, n, naive_time,
+           gflop / (naive_time / 1000.0), gemm_time, gflop / (gemm_time / 1000.0), mismatches);
+}
+
+int
+main(int argc, char* argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : 256;
+    int num_tiles = argc > 2 ? atoi(argv[2]) : 4;
+    int size = n * n;
+    int rows = (n + num_tiles - 1) / num_tiles;
+    int failures = 0;
+    double begin, naive_time, gemm_time;
+
+    if (n <= 0 || num_tiles <= 0) {
+        printf("usage: %s [matrix_size] [num_tiles]\n", argv[0]);
+        return 1;
+    }
+
+    /* float, compared with a tolerance since the sums are reordered */
+    float* fa = malloc(size * sizeof(float));
+    float* fb = malloc(size * sizeof(float));
+    float* fc_naive = malloc(size * sizeof(float));
+    float* fc = malloc(size * sizeof(float));
+    srand(1);
+    for (int i = 0; i < size; i++) {
+        fa[i] = (float)(rand() % 200 - 100) / 100.0f;
+        fb[i] = (float)(rand() % 200 - 100) / 100.0f;
+    }
+
+    begin = now_ms();
+    naive_f32(fa, fb, fc_naive, n, n, n);
+    naive_time = now_ms() - begin;
+
+    begin = now_ms();
+    for (int t = 0; t < num_tiles; t++) {
+        failures += hetcompute_dsp_gemm_f32(t * rows, (t + 1) * rows, 0, n, fa, size, fb, size, fc, size, n, n, n) != 0;
+    }
+    gemm_time = now_ms() - begin;
+
+    int mismatches = 0;
+    for (int i = 0; i < size; i++) {
+        float d = fc[i] - fc_naive[i];
+        mismatches += d > 1e-3f || d < -1e-3f;
+    }
+    report("f32", n, naive_time, gemm_time, mismatches);
+    failures += mismatches;
+    free(fa);
+    free(fb);
+    free(fc_naive);
+    free(fc);
+
+    /* int16 Q15 and int8 Q7, exact */
+    for (int is_s16 = 1; is_s16 >= 0; is_s16--) {
+        size_t elem = is_s16 ? sizeof(int16) : sizeof(int8);
+        int shift = is_s16 ? 15 : 7;
+        char* a = malloc(size * elem);
+        char* b = malloc(size * elem);
+        char* c_naive = malloc(size * elem);
+        char* c = malloc(size * elem);
+        for (int i = 0; i < size; i++) {
+            if (is_s16) {
+                ((int16*)a)[i] = (int16)(rand() % 65536 - 32768);
+                ((int16*)b)[i] = (int16)(rand() % 65536 - 32768);
+            } else {
+                ((int8*)a)[i] = (int8)(rand() % 256 - 128);
+                ((int8*)b)[i] = (int8)(rand() % 256 - 128);
+            }
+        }
+
+        begin = now_ms();
+        naive_fixed(a, b, c_naive, n, n, n, shift, is_s16);
+        naive_time = now_ms() - begin;
+
+        begin = now_ms();
+        for (int t = 0; t < num_tiles; t++) {
+            failures += (is_s16 ? hetcompute_dsp_gemm_s16(t * rows, (t + 1) * rows, 0, n, (const int16*)a, size,
+                                                          (const int16*)b, size, (int16*)c, size, n, n, n, shift)
+                                : hetcompute_dsp_gemm_s8(t * rows, (t + 1) * rows, 0, n, (const int8*)a, size,
+                                                         (const int8*)b, size, (int8*)c, size, n, n, n, shift)) != 0;
+        }
+        gemm_time = now_ms() - begin;
+
+        mismatches = 0;
+        for (int i = 0; i < size; i++) {
+            mismatches += memcmp(c + i * elem, c_naive + i * elem, elem) != 0;
+        }
+        report(is_s16 ? "s16" : "s8", n, naive_time, gemm_time, mismatches);
+        failures += mismatches;
+        free(a);
+        free(b);
+        free(c_naive);
+        free(c);
+    }
+
+    return failures != 0;
+}
@@ -249,7 +249,7 @@ namespace hetcompute
          *  assert(b == nullptr);
          *  @endcode
          */
-        buffer_ptr() : base(), _num_elems(0)
+        buffer_ptr() : base(), _num_elems(0), _offset(0)
         {
         }
 
@@ -272,7 +272,7 @@ namespace hetcompute
          *  @endcode
          */
         buffer_ptr(buffer_ptr<typename std::remove_const<T>::type> const& other)
-            : base(reinterpret_cast<buffer_ptr_base const&>(other)), _num_elems(other.size())
+            : base(reinterpret_cast<buffer_ptr_base const&>(other)), _num_elems(other.size()), _offset(other._offset)
         {
         }
 
@@ -303,6 +303,7 @@ namespace hetcompute
 
             base::operator=(reinterpret_cast<buffer_ptr_base const&>(other));
             _num_elems    = other.size();
+            _offset       = other._offset;
             return *this;
         }
 
@@ -527,7 +528,7 @@ namespace hetcompute
          */
         inline void* host_data() const
         {
-            return base::host_data();
+            return view_data(base::host_data());
         }
 
         /**
@@ -564,7 +565,7 @@ namespace hetcompute
          */
         inline void* saved_host_data() const
         {
-            return base::saved_host_data();
+            return view_data(base::saved_host_data());
         }
 
         /**
@@ -601,13 +602,64 @@ namespace hetcompute
          *  buffer pointed to by this buffer_ptr.
          *
          *  The number of elements of datatype <code>T</code> in the underlying buffer
-         *  pointed to by this buffer_ptr.
+         *  pointed to by this buffer_ptr, or in the view if this buffer_ptr is a
+         *  slice.
          */
         inline size_t size() const
         {
             return _num_elems;
         }
 
+        /**
+         *  @brief Creates a view of a range of the elements of the buffer.
+         *
+         *  Returns a buffer_ptr to the elements <code>[offset, offset + count)</code>
+         *  of this buffer_ptr. The slice shares the storage and the coherence state
+         *  of the underlying buffer: no data is copied, and the writes through the
+         *  slice are visible through the buffer.
+         *
+         *  Element 0 of the slice is element <code>offset</code> of this
+         *  buffer_ptr, for host accesses, cpu tasks, gpu kernels and dsp kernels
+         *  alike, and <code>size()</code> is <code>count</code>.
+         *
+         *  Acquires of a slice, by tasks or by the host, acquire the whole
+         *  buffer, and copies between devices copy the whole buffer. Tasks
+         *  writing disjoint slices of a buffer therefore still take turns,
+         *  as if they wrote the buffer itself.
+         *
+         *  For gpu kernels, <code>offset * sizeof(T)</code> must be a multiple
+         *  of the base address alignment of the OpenCL device.
+         *
+         *  @param offset First element of the slice, relative to this buffer_ptr.
+         *  @param count  Number of elements in the slice.
+         *
+         *  @return A buffer_ptr to the slice, nullptr if this buffer_ptr is nullptr.
+         *
+         *  @throws api_exception if the range exceeds this buffer_ptr.
+         *
+         *  Example:
+         *  @code
+         *  auto b     = hetcompute::create_buffer<float>(1024);
+         *  auto first = b.slice(0, 512);
+         *  auto last  = b.slice(512, 512);
+         *  @endcode
+         */
+        buffer_ptr slice(size_t offset, size_t count) const
+        {
+            HETCOMPUTE_API_THROW(offset <= _num_elems && count <= _num_elems - offset,
+                                 "Slice [%zu, %zu) exceeds the %zu elements of the buffer_ptr",
+                                 offset,
+                                 offset + count,
+                                 _num_elems);
+            buffer_ptr view(*this);
+            if (!view.is_null())
+            {
+                view._offset += offset;
+                view._num_elems = count;
+            }
+            return view;
+        }
+
         /**
          *  @brief Indexed lookup of buffer data.
          *
@@ -743,20 +795,24 @@ namespace hetcompute
 
         size_t _num_elems;
 
+        // first element of the view in the underlying buffer, 0 unless this is a slice
+        size_t _offset;
+
         // Not user-constructible. Use create_buffer().
         buffer_ptr(size_t num_elems, device_set const& device_hints)
-            : base(num_elems * sizeof(T), device_hints), _num_elems(num_elems)
+            : base(num_elems * sizeof(T), device_hints), _num_elems(num_elems), _offset(0)
         {
         }
 
         buffer_ptr(T* preallocated_ptr, size_t num_elems, device_set const& device_hints)
-            : base(const_cast<bare_T*>(preallocated_ptr), num_elems * sizeof(T), device_hints), _num_elems(num_elems)
+            : base(const_cast<bare_T*>(preallocated_ptr), num_elems * sizeof(T), device_hints), _num_elems(num_elems), _offset(0)
         {
         }
 
         buffer_ptr(memregion const& mr, size_t num_elems, device_set const& device_hints)
             : base(mr, num_elems > 0 ? num_elems * sizeof(T) : mr.get_num_bytes(), device_hints),
-              _num_elems(num_elems > 0 ? num_elems : mr.get_num_bytes() / sizeof(T))
+              _num_elems(num_elems > 0 ? num_elems : mr.get_num_bytes() / sizeof(T)),
+              _offset(0)
         {
             HETCOMPUTE_API_THROW(num_elems == 0 || num_elems * sizeof(T) <= mr.get_num_bytes(),
                                 "num_elems=%zu exceed the capacity of the memory region size=%zu bytes",
@@ -782,6 +838,16 @@ namespace hetcompute
             return base::get_buffer();
         }
 
+        inline void* view_data(void* buffer_data) const
+        {
+            return buffer_data == nullptr ? nullptr : static_cast<void*>(reinterpret_cast<bare_T*>(buffer_data) + _offset);
+        }
+
+        template <typename U>
+        friend class buffer_ptr;
+
+        friend class internal::buffer_accessor;
+
         template <typename U>
         friend bool operator==(::hetcompute::buffer_ptr<U> const& b, ::std::nullptr_t);
 
@@ -17,6 +17,11 @@ namespace hetcompute
 
         struct cpu_kernel_caller;
 
+        namespace hetero
+        {
+            class profile_cache;
+        }; // namespace hetcompute::internal::hetero
+
     }; // namespace hetcompute::internal
 
     /**
@@ -46,6 +51,8 @@ namespace hetcompute
 
         friend struct ::hetcompute::internal::cpu_kernel_caller;
 
+        friend class ::hetcompute::internal::hetero::profile_cache;
+
         static_assert(std::is_copy_constructible<Fn>::value, "CPU kernels must be copy constructible.");
 
         static_assert(std::is_move_constructible<Fn>::value, "CPU kernels must be move constructible.");
@@ -175,6 +182,8 @@ namespace hetcompute
 
         friend struct ::hetcompute::internal::cpu_kernel_caller;
 
+        friend class ::hetcompute::internal::hetero::profile_cache;
+
     public:
         using size_type   = typename parent::size_type;
         using return_type = typename parent::return_type;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <tuple>
+
 #if defined(HETCOMPUTE_HAVE_QTI_DSP)
 
 #include <hetcompute/internal/task/dspkernel.hh>
@@ -116,3 +118,69 @@ namespace hetcompute
 }; // namespace hetcompute
 
 #endif // defined(HETCOMPUTE_HAVE_QTI_DSP)
+
+namespace hetcompute
+{
+    /** @addtogroup kernelclass_doc
+        @{ */
+
+    template <typename Fn>
+    class dsp_stand_in;
+
+    /**
+     *  Host function that stands in for a DSP kernel in the DSP stages of a
+     *  pipeline, so that they can be developed and tested on hosts without
+     *  a DSP, e.g. Linux workstations.
+     *
+     *  The function has the parameter list of the DSP kernel it stands for,
+     *  as generated from its IDL: each <tt>hetcompute::buffer_ptr</tt> argument
+     *  is passed as a pointer to the buffer data followed by the number of
+     *  elements, and buffers passed through a pointer to const are only read.
+     *  The function runs on the CPU, in the task that executes the stage
+     *  iteration. It returns 0 on success.
+     *
+     *  @tparam Args Arguments of the host function.
+     *
+     *  @sa create_dsp_stand_in() for creating a <tt>dsp_stand_in</tt>.
+     *  @sa hetcompute::pattern::pipeline::add_dsp_stage()
+     */
+    template <typename... Args>
+    class dsp_stand_in<int (*)(Args...)>
+    {
+    public:
+        using fn_type    = int (*)(Args...);
+        using args_tuple = std::tuple<Args...>;
+
+        /**
+         * Constructor
+         *
+         * @param fn The host function to be called.
+         */
+        explicit dsp_stand_in(fn_type fn) : _fn(fn) {}
+
+        /// @cond
+        // Not a callable object, so that pipeline stages do not mistake it
+        // for a cpu body.
+        fn_type get_fn() const { return _fn; }
+        /// @endcond
+
+    private:
+        fn_type _fn;
+    }; // dsp_stand_in<int(*)(Args...)>
+
+    /**
+     * Creates a host stand-in for a DSP kernel with the same parameter list.
+     *
+     * @param fn The host function, returning 0 on success.
+     *
+     * @sa hetcompute::dsp_stand_in
+     */
+    template <typename... Args>
+    hetcompute::dsp_stand_in<int (*)(Args...)> create_dsp_stand_in(int (*fn)(Args...))
+    {
+        return hetcompute::dsp_stand_in<int (*)(Args...)>(fn);
+    }
+
+    /** @} */ /* end_addtogroup kernelclass_doc */
+
+}; // namespace hetcompute
@@ -0,0 +1,352 @@
+#ifndef HETCOMPUTE_GEMM_H
+#define HETCOMPUTE_GEMM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup gemm_doc
+@{ */
+/**
+ * C GEMM kernels, C = A * B on row-major matrices, where A is M x K,
+ * B is K x N and C is M x N.
+ *
+ * Each kernel computes the block of C given by a 2D range, rows
+ * [first_x, last_x) and columns [first_y, last_y), with the signature of a
+ * 2D dsp kernel generated from the IDL: the range, then each matrix as a
+ * pointer and a number of elements, then the sizes. The same function is
+ * called by the dsp kernels in external/dsp and, per tile, by
+ * <code>hetcompute::pgemm</code> on the CPU. It is plain C, so it can be built
+ * and benchmarked on any host.
+ *
+ * The block is computed in cache blocks of HETCOMPUTE_GEMM_MC rows,
+ * HETCOMPUTE_GEMM_NC columns and HETCOMPUTE_GEMM_KC steps of K. Each panel
+ * of B is packed once into slivers of HETCOMPUTE_GEMM_NR columns and reused
+ * for all the blocks of rows, each block of A is packed into slivers of
+ * HETCOMPUTE_GEMM_MR rows, both contiguous in K, and a micro-kernel
+ * computes each MR x NR tile of C in registers. The inner loop of the
+ * micro-kernel has a constant trip count over contiguous data, so the
+ * compiler vectorizes it. Edges are zero padded, so
+ * the micro-kernel always computes full tiles.
+ *
+ * The fixed point kernels multiply int16 (Q15 for shift = 15) or int8 (Q7 for
+ * shift = 7) matrices, accumulate into 64-bit and 32-bit integers
+ * respectively, and store each element of C shifted right by shift bits, with
+ * rounding, and saturated.
+ *
+ * @sa include/hetcompute/pgemm.hh for the C++ API
+ */
+
+#ifndef HETCOMPUTE_GEMM_MR
+/** Rows of the register tile of the micro-kernel */
+#define HETCOMPUTE_GEMM_MR 4
+#endif
+
+#ifndef HETCOMPUTE_GEMM_NR
+/** Columns of the register tile of the micro-kernel */
+#define HETCOMPUTE_GEMM_NR 8
+#endif
+
+#ifndef HETCOMPUTE_GEMM_MC
+/** Rows of a cache block of A, a multiple of HETCOMPUTE_GEMM_MR */
+#define HETCOMPUTE_GEMM_MC 64
+#endif
+
+#ifndef HETCOMPUTE_GEMM_NC
+/** Columns of a cache block of B, a multiple of HETCOMPUTE_GEMM_NR */
+#define HETCOMPUTE_GEMM_NC 128
+#endif
+
+#ifndef HETCOMPUTE_GEMM_KC
+/** Steps of K of a cache block of A and B */
+#define HETCOMPUTE_GEMM_KC 256
+#endif
+
+/// @cond
+// Ignore this code fragment
+
+static inline float
+hetcompute_gemm_store_f32(float acc, int shift)
+{
+    (void)shift;
+    return acc;
+}
+
+static inline int16_t
+hetcompute_gemm_store_s16(int64_t acc, int shift)
+{
+    if (shift > 0)
+    {
+        acc = (acc + ((int64_t)1 << (shift - 1))) >> shift;
+    }
+    return (int16_t)(acc > INT16_MAX ? INT16_MAX : (acc < INT16_MIN ? INT16_MIN : acc));
+}
+
+static inline int8_t
+hetcompute_gemm_store_s8(int32_t acc, int shift)
+{
+    if (shift > 0)
+    {
+        acc = (int32_t)(((int64_t)acc + ((int64_t)1 << (shift - 1))) >> shift);
+    }
+    return (int8_t)(acc > INT8_MAX ? INT8_MAX : (acc < INT8_MIN ? INT8_MIN : acc));
+}
+
+/*
+ * Defines the kernel family of one element type T, accumulated as ACC:
+ *   hetcompute_gemm_<S>_pack_a, packs an mc x kc block of A into MR row slivers
+ *   hetcompute_gemm_<S>_pack_b, packs a kc x nc panel of B into NR column slivers
+ *   hetcompute_gemm_<S>_micro,  adds the product of two slivers to an MR x NR tile
+ *   hetcompute_gemm_<S>_block,  computes a block of C
+ */
+#define HETCOMPUTE_GEMM_DEFINE(S, T, ACC)                                                                                    \
+    static inline void hetcompute_gemm_##S##_pack_a(const T* a, int lda, int mc, int kc, T* ap)                            \
+    {                                                                                                                      \
+        int ir, i, k;                                                                                                      \
+        for (ir = 0; ir < mc; ir += HETCOMPUTE_GEMM_MR)                                                                    \
+        {                                                                                                                  \
+            for (k = 0; k < kc; k++)                                                                                       \
+            {                                                                                                              \
+                for (i = 0; i < HETCOMPUTE_GEMM_MR; i++)                                                                   \
+                {                                                                                                          \
+                    *ap++ = ir + i < mc ? a[(ir + i) * lda + k] : (T)0;                                                    \
+                }                                                                                                          \
+            }                                                                                                              \
+        }                                                                                                                  \
+    }                                                                                                                      \
+                                                                                                                           \
+    static inline void hetcompute_gemm_##S##_pack_b(const T* b, int ldb, int kc, int nc, T* bp)                            \
+    {                                                                                                                      \
+        int jr, j, k;                                                                                                      \
+        for (jr = 0; jr < nc; jr += HETCOMPUTE_GEMM_NR)                                                                    \
+        {                                                                                                                  \
+            for (k = 0; k < kc; k++)                                                                                       \
+            {                                                                                                              \
+                for (j = 0; j < HETCOMPUTE_GEMM_NR; j++)                                                                   \
+                {                                                                                                          \
+                    *bp++ = jr + j < nc ? b[k * ldb + jr + j] : (T)0;                                                      \
+                }                                                                                                          \
+            }                                                                                                              \
+        }                                                                                                                  \
+    }                                                                                                                      \
+                                                                                                                           \
+    static inline void hetcompute_gemm_##S##_micro(int kc, const T* ap, const T* bp, ACC* c, int ldc)                      \
+    {                                                                                                                      \
+        ACC acc[HETCOMPUTE_GEMM_MR][HETCOMPUTE_GEMM_NR];                                                                   \
+        int i, j, k;                                                                                                       \
+        for (i = 0; i < HETCOMPUTE_GEMM_MR; i++)                                                                           \
+        {                                                                                                                  \
+            for (j = 0; j < HETCOMPUTE_GEMM_NR; j++)                                                                       \
+            {                                                                                                              \
+                acc[i][j] = 0;                                                                                             \
+            }                                                                                                              \
+        }                                                                                                                  \
+        for (k = 0; k < kc; k++, ap += HETCOMPUTE_GEMM_MR, bp += HETCOMPUTE_GEMM_NR)                                       \
+        {                                                                                                                  \
+            for (i = 0; i < HETCOMPUTE_GEMM_MR; i++)                                                                       \
+            {                                                                                                              \
+                ACC ai = (ACC)ap[i];                                                                                       \
+                for (j = 0; j < HETCOMPUTE_GEMM_NR; j++)                                                                   \
+                {                                                                                                          \
+                    acc[i][j] += ai * (ACC)bp[j];                                                                          \
+                }                                                                                                          \
+            }                                                                                                              \
+        }                                                                                                                  \
+        for (i = 0; i < HETCOMPUTE_GEMM_MR; i++)                                                                           \
+        {                                                                                                                  \
+            for (j = 0; j < HETCOMPUTE_GEMM_NR; j++)                                                                       \
+            {                                                                                                              \
+                c[i * ldc + j] += acc[i][j];                                                                               \
+            }                                                                                                              \
+        }                                                                                                                  \
+    }                                                                                                                      \
+                                                                                                                           \
+    static inline int hetcompute_gemm_##S##_block(int first_x, int last_x, int first_y, int last_y, const T* a, int a_len, \
+                                                  const T* b, int b_len, T* c, int c_len, int M, int N, int K, int shift)  \
+    {                                                                                                                      \
+        T*     ap;                                                                                                         \
+        T*     bp;                                                                                                         \
+        ACC*   acc;                                                                                                        \
+        size_t mp;                                                                                                         \
+        int    ic, jc, pc, ir, jr, i, j;                                                                                   \
+                                                                                                                           \
+        if (M <= 0 || N <= 0 || K <= 0 || a_len < 0 || b_len < 0 || c_len < 0 || (size_t)a_len < (size_t)M * (size_t)K ||  \
+            (size_t)b_len < (size_t)K * (size_t)N || (size_t)c_len < (size_t)M * (size_t)N)                                \
+        {                                                                                                                  \
+            return -1;                                                                                                     \
+        }                                                                                                                  \
+        /* Ranges may be rounded up past the matrix, as with the point kernels */                                          \
+        first_x = first_x < 0 ? 0 : first_x;                                                                               \
+        first_y = first_y < 0 ? 0 : first_y;                                                                               \
+        last_x  = last_x > M ? M : last_x;                                                                                 \
+        last_y  = last_y > N ? N : last_y;                                                                                 \
+        if (first_x >= last_x || first_y >= last_y)                                                                        \
+        {                                                                                                                  \
+            return 0;                                                                                                      \
+        }                                                                                                                  \
+                                                                                                                           \
+        /* The sums of a column panel of C, for all the rows of the block */                                               \
+        mp  = (size_t)(last_x - first_x + HETCOMPUTE_GEMM_MR - 1) / HETCOMPUTE_GEMM_MR * HETCOMPUTE_GEMM_MR;               \
+        ap  = (T*)malloc(sizeof(T) * HETCOMPUTE_GEMM_MC * HETCOMPUTE_GEMM_KC);                                             \
+        bp  = (T*)malloc(sizeof(T) * HETCOMPUTE_GEMM_KC * HETCOMPUTE_GEMM_NC);                                             \
+        acc = (ACC*)malloc(sizeof(ACC) * mp * HETCOMPUTE_GEMM_NC);                                                         \
+        if (ap == NULL || bp == NULL || acc == NULL)                                                                       \
+        {                                                                                                                  \
+            free(ap);                                                                                                      \
+            free(bp);                                                                                                      \
+            free(acc);                                                                                                     \
+            return -1;                                                                                                     \
+        }                                                                                                                  \
+                                                                                                                           \
+        /* jc, pc, ic order: each panel of B is packed once and reused by all the blocks of A */                           \
+        for (jc = first_y; jc < last_y; jc += HETCOMPUTE_GEMM_NC)                                                          \
+        {                                                                                                                  \
+            int nc  = last_y - jc < HETCOMPUTE_GEMM_NC ? last_y - jc : HETCOMPUTE_GEMM_NC;                                 \
+            int ncp = (nc + HETCOMPUTE_GEMM_NR - 1) / HETCOMPUTE_GEMM_NR * HETCOMPUTE_GEMM_NR;                             \
+            memset(acc, 0, sizeof(ACC) * mp * ncp);                                                                        \
+            for (pc = 0; pc < K; pc += HETCOMPUTE_GEMM_KC)                                                                 \
+            {                                                                                                              \
+                int kc = K - pc < HETCOMPUTE_GEMM_KC ? K - pc : HETCOMPUTE_GEMM_KC;                                        \
+                hetcompute_gemm_##S##_pack_b(b + (size_t)pc * N + jc, N, kc, nc, bp);                                      \
+                for (ic = first_x; ic < last_x; ic += HETCOMPUTE_GEMM_MC)                                                  \
+                {                                                                                                          \
+                    int  mc  = last_x - ic < HETCOMPUTE_GEMM_MC ? last_x - ic : HETCOMPUTE_GEMM_MC;                        \
+                    int  mcp = (mc + HETCOMPUTE_GEMM_MR - 1) / HETCOMPUTE_GEMM_MR * HETCOMPUTE_GEMM_MR;                    \
+                    ACC* cc  = acc + (size_t)(ic - first_x) * ncp;                                                         \
+                    hetcompute_gemm_##S##_pack_a(a + (size_t)ic * K + pc, K, mc, kc, ap);                                  \
+                    for (jr = 0; jr < ncp; jr += HETCOMPUTE_GEMM_NR)                                                       \
+                    {                                                                                                      \
+                        for (ir = 0; ir < mcp; ir += HETCOMPUTE_GEMM_MR)                                                   \
+                        {                                                                                                  \
+                            hetcompute_gemm_##S##_micro(kc, ap + ir * kc, bp + jr * kc, cc + ir * ncp + jr, ncp);          \
+                        }                                                                                                  \
+                    }                                                                                                      \
+                }                                                                                                          \
+            }                                                                                                              \
+            for (i = first_x; i < last_x; i++)                                                                             \
+            {                                                                                                              \
+                for (j = 0; j < nc; j++)                                                                                   \
+                {                                                                                                          \
+                    c[(size_t)i * N + jc + j] = hetcompute_gemm_store_##S(acc[(size_t)(i - first_x) * ncp + j], shift);    \
+                }                                                                                                          \
+            }                                                                                                              \
+        }                                                                                                                  \
+                                                                                                                           \
+        free(ap);                                                                                                          \
+        free(bp);                                                                                                          \
+        free(acc);                                                                                                         \
+        return 0;                                                                                                          \
+    }
+
+HETCOMPUTE_GEMM_DEFINE(f32, float, float)
+HETCOMPUTE_GEMM_DEFINE(s16, int16_t, int64_t)
+HETCOMPUTE_GEMM_DEFINE(s8, int8_t, int32_t)
+
+#undef HETCOMPUTE_GEMM_DEFINE
+/// @endcond
+
+/**
+ * Compute a block of C = A * B, on float matrices.
+ *
+ * @param first_x first row of the block of C
+ * @param last_x  last row of the block of C, excluded, clamped to M
+ * @param first_y first column of the block of C
+ * @param last_y  last column of the block of C, excluded, clamped to N
+ * @param a       M x K matrix A, row-major
+ * @param a_len   number of elements of a, at least M * K
+ * @param b       K x N matrix B, row-major
+ * @param b_len   number of elements of b, at least K * N
+ * @param c       M x N matrix C, row-major
+ * @param c_len   number of elements of c, at least M * N
+ * @param M       rows of A and C
+ * @param N       columns of B and C
+ * @param K       columns of A and rows of B
+ * @return 0 on success, -1 if the sizes are invalid or the packing buffers
+ *         cannot be allocated
+ */
+static inline int
+hetcompute_gemm_f32(int          first_x,
+                    int          last_x,
+                    int          first_y,
+                    int          last_y,
+                    const float* a,
+                    int          a_len,
+                    const float* b,
+                    int          b_len,
+                    float*       c,
+                    int          c_len,
+                    int          M,
+                    int          N,
+                    int          K)
+{
+    return hetcompute_gemm_f32_block(first_x, last_x, first_y, last_y, a, a_len, b, b_len, c, c_len, M, N, K, 0);
+}
+
+/**
+ * Compute a block of C = A * B, on int16 fixed point matrices.
+ *
+ * Each element of C is the 64-bit sum of the products, shifted right by
+ * shift bits with rounding, and saturated to int16.
+ *
+ * @param shift number of fractional bits to drop, e.g. 15 for Q15 matrices
+ * @sa hetcompute_gemm_f32 for the other parameters
+ */
+static inline int
+hetcompute_gemm_s16(int            first_x,
+                    int            last_x,
+                    int            first_y,
+                    int            last_y,
+                    const int16_t* a,
+                    int            a_len,
+                    const int16_t* b,
+                    int            b_len,
+                    int16_t*       c,
+                    int            c_len,
+                    int            M,
+                    int            N,
+                    int            K,
+                    int            shift)
+{
+    return hetcompute_gemm_s16_block(first_x, last_x, first_y, last_y, a, a_len, b, b_len, c, c_len, M, N, K, shift);
+}
+
+/**
+ * Compute a block of C = A * B, on int8 fixed point matrices.
+ *
+ * Each element of C is the 32-bit sum of the products, shifted right by
+ * shift bits with rounding, and saturated to int8. The sum does not
+ * overflow for K < 2^17.
+ *
+ * @param shift number of fractional bits to drop, e.g. 7 for Q7 matrices
+ * @sa hetcompute_gemm_f32 for the other parameters
+ */
+static inline int
+hetcompute_gemm_s8(int           first_x,
+                   int           last_x,
+                   int           first_y,
+                   int           last_y,
+                   const int8_t* a,
+                   int           a_len,
+                   const int8_t* b,
+                   int           b_len,
+                   int8_t*       c,
+                   int           c_len,
+                   int           M,
+                   int           N,
+                   int           K,
+                   int           shift)
+{
+    return hetcompute_gemm_s8_block(first_x, last_x, first_y, last_y, a, a_len, b, b_len, c, c_len, M, N, K, shift);
+}
+
+/** @} */ /* end_addtogroup gemm_doc */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HETCOMPUTE_GEMM_H
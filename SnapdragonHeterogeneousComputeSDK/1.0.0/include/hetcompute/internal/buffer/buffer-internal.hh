@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <hetcompute/devicetypes.hh>
 #include <hetcompute/memregion.hh>
 #include <hetcompute/texturetype.hh>
@@ -312,6 +313,13 @@ namespace hetcompute
                 return bb._tex_info;
             }
 
+            /// Byte range [first, second) of the buffer viewed by b, narrower than the buffer for slices.
+            template <typename T>
+            static std::pair<size_t, size_t> get_byte_range(buffer_ptr<T> const& b)
+            {
+                return std::make_pair(b._offset * sizeof(T), (b._offset + b._num_elems) * sizeof(T));
+            }
+
             static void set_name_locked(buffer_ptr_base const& bb, std::string const& name)
             {
                 auto p_bufstate = hetcompute::internal::c_ptr(bb._bufstate);
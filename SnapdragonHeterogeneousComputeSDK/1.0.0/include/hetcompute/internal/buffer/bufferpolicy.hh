@@ -1436,6 +1436,8 @@ namespace hetcompute
                                  preacquired_arenas_base const*             p_preacquired_arenas        = nullptr,
                                  override_device_sets_base const*           p_override_device_sets      = nullptr)
             {
+                log::fire_event<log::events::buffer_acquire_initiated>();
+
                 acquire_precheck_and_setup(edb);
 
                 auto bp = get_current_bufferpolicy();
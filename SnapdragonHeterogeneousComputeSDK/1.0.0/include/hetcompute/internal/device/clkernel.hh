@@ -4,6 +4,7 @@
 #ifdef HETCOMPUTE_HAVE_OPENCL
 
 #include <mutex>
+#include <vector>
 
 // Include user-visible headers first
 #include <hetcompute/texture.hh>
@@ -27,9 +28,13 @@ namespace hetcompute
             size_t      _opt_local_size;
             std::mutex  _dispatch_mutex;
 
+            // sub-buffers set as kernel arguments, indexed by argument, kept alive until the next
+            // sub-buffer for the argument. Enqueued kernels retain the sub-buffers they use.
+            std::vector<cl::Buffer> _sub_buffer_args;
+
         public:
             clkernel(legacy::device_ptr const& device, const std::string& task_str, const std::string& task_name, const std::string& build_options)
-                : _ocl_program(), _ocl_kernel(), _opt_local_size(0), _dispatch_mutex()
+                : _ocl_program(), _ocl_kernel(), _opt_local_size(0), _dispatch_mutex(), _sub_buffer_args()
             {
                 auto d_ptr = internal::c_ptr(device);
                 HETCOMPUTE_INTERNAL_ASSERT((d_ptr != nullptr), "null device ptr");
@@ -101,7 +106,7 @@ namespace hetcompute
                      size_t                    kernel_size,
                      const std::string&        kernel_name,
                      const std::string&        build_options)
-                : _ocl_program(), _ocl_kernel(), _opt_local_size(0), _dispatch_mutex()
+                : _ocl_program(), _ocl_kernel(), _opt_local_size(0), _dispatch_mutex(), _sub_buffer_args()
             {
                 auto d_ptr = internal::c_ptr(device);
                 HETCOMPUTE_INTERNAL_ASSERT((d_ptr != nullptr), "null device ptr");
@@ -337,6 +342,47 @@ namespace hetcompute
 #endif
             }
 
+            // handle the [offset, offset + size) bytes of a cl::Buffer, as a sub-buffer.
+            // offset must be aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN.
+            inline void set_arg_sub_buffer(size_t arg_index, cl::Buffer const& cl_buffer, size_t offset, size_t size)
+            {
+                if (size == 0)
+                {
+                    // empty sub-buffers are invalid, and the kernel cannot access any byte anyway
+                    set_arg(arg_index, cl_buffer);
+                    return;
+                }
+
+                cl_buffer_region region = { offset, size };
+                cl_int           status = CL_SUCCESS;
+                cl::Buffer       sub_buffer;
+#ifndef HETCOMPUTE_DISABLE_EXCEPTIONS
+                try
+                {
+#endif
+                    // flags of 0 inherit the access flags of cl_buffer
+                    sub_buffer = const_cast<cl::Buffer&>(cl_buffer).createSubBuffer(0, CL_BUFFER_CREATE_TYPE_REGION, &region, &status);
+                    HETCOMPUTE_DLOG("cl::Buffer::createSubBuffer(%p, %zu, %zu)->%d", &cl_buffer, offset, size, status);
+#ifndef HETCOMPUTE_DISABLE_EXCEPTIONS
+                }
+                catch (cl::Error& err)
+                {
+                    HETCOMPUTE_FATAL("cl::Buffer::createSubBuffer(%p, %zu, %zu)->%s", &cl_buffer, offset, size, get_cl_error_string(err.err()));
+                }
+#else
+                if (status != CL_SUCCESS)
+                {
+                    HETCOMPUTE_FATAL("cl::Buffer::createSubBuffer(%p, %zu, %zu)->%s", &cl_buffer, offset, size, get_cl_error_string(status));
+                }
+#endif
+                set_arg(arg_index, sub_buffer);
+                if (_sub_buffer_args.size() <= arg_index)
+                {
+                    _sub_buffer_args.resize(arg_index + 1);
+                }
+                _sub_buffer_args[arg_index] = sub_buffer;
+            }
+
             // handle value types.
             template <typename T>
             void set_arg(size_t arg_index, T value)
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <hetcompute/internal/util/debug.hh>
+#include <hetcompute/internal/log/loggerbase.hh>
+#include <hetcompute/internal/log/objectid.hh>
+#include <hetcompute/internal/log/sharded_buffer.hh>
+#include <hetcompute/internal/log/userlogapi.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        namespace log
+        {
+            /**
+               Records task, group and buffer events with timestamps in the
+               per-thread sharded buffers and exports them as Chrome Trace Event
+               JSON. The file can be opened with chrome://tracing or
+               ui.perfetto.dev. It shows one track per thread with a slice for each
+               task execution and buffer acquire, and markers for steals, waits and
+               GPU launches.
+
+               chrome_trace_logger is not one of the loggers in log::loggers:
+               log::init() and log::shutdown() are part of the prebuilt runtime
+               and only drive the loggers it was built with. Instead, start()
+               registers user event handlers, which the runtime invokes for the
+               events it fires, and write_trace() exports what was recorded:
+
+                 hetcompute::runtime::init();
+                 chrome_trace_logger::start();
+                 ...
+                 chrome_trace_logger::stop();
+                 chrome_trace_logger::write_trace("trace.json");
+
+               Events are only delivered if the runtime and the application are
+               built with HETCOMPUTE_LOG_FIRE_EVENT.
+            */
+            class chrome_trace_logger : public logger_base
+            {
+            public:
+                // Payload of the records written by chrome_trace_logger
+                struct payload
+                {
+                    // Task or group the event refers to
+                    uint64_t _object;
+                    // Event specific argument
+                    uint64_t _arg;
+                    // Event specific flags
+                    uint32_t _flags;
+                };
+
+                // Flags of task_executes records
+                enum task_flags : uint32_t
+                {
+                    gpu_task      = 1,
+                    blocking_task = 2,
+                    inlined_task  = 4
+                };
+
+                // Starts recording by registering an event handler for each
+                // recorded event. Must be called after runtime::init() and while
+                // no tasks are running, because handler registration is not
+                // thread safe. Calling it again before stop() has no effect.
+                static void start()
+                {
+                    if (!get_unregisterers().empty())
+                    {
+                        return;
+                    }
+
+                    add_handler<events::buffer_acquire_initiated>();
+                    add_handler<events::buffer_release_initiated>();
+                    add_handler<events::buffer_set_acquired>();
+                    add_handler<events::group_canceled>();
+                    add_handler<events::group_wait_for_ended>();
+                    add_handler<events::task_executes>();
+                    add_handler<events::task_finished>();
+                    add_handler<events::task_gpu_completion_callback_invoked>();
+#ifdef HETCOMPUTE_HAVE_GPU
+                    add_handler<events::task_launched_into_gpu>();
+#endif // HETCOMPUTE_HAVE_GPU
+                    add_handler<events::task_stolen>();
+                    add_handler<events::task_wait>();
+                }
+
+                // Stops recording by unregistering the event handlers. Same
+                // restrictions as start(). Recorded events are kept until the
+                // sharded buffers wrap around.
+                static void stop()
+                {
+                    auto& unregisterers = get_unregisterers();
+                    for (auto& unregister : unregisterers)
+                    {
+                        unregister();
+                    }
+                    unregisterers.clear();
+                }
+
+                // Writes all records logged so far as Chrome Trace Event JSON. Returns false on I/O errors.
+                static bool write_trace(const char* path)
+                {
+                    auto records = sharded_buffer::merge(s_myloggerid);
+                    if (records.empty())
+                    {
+                        return false;
+                    }
+
+                    FILE* file = std::fopen(path, "w");
+                    if (file == nullptr)
+                    {
+                        HETCOMPUTE_ELOG("Unable to open trace file %s", path);
+                        return false;
+                    }
+
+                    trace_writer writer(file, records.front()._timestamp);
+                    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+                    writer.process_name();
+
+                    // Task executions become complete events spanning from task_executes to
+                    // task_finished, which may be logged by another thread (e.g. GPU tasks).
+                    std::map<uint64_t, trace_record const*> running;
+                    std::map<uint16_t, uint32_t>            thread_kinds;
+                    // Buffer acquires become complete events spanning from buffer_acquire_initiated
+                    // to buffer_set_acquired, both logged by the thread that calls acquire_buffers().
+                    // An acquire that ends in a conflict fires no buffer_set_acquired, so its
+                    // initiated record is replaced by the next acquire on that thread.
+                    std::map<uint16_t, trace_record const*> acquiring;
+                    for (auto const& record : records)
+                    {
+                        auto const& p   = get_payload(record);
+                        auto&       kind = thread_kinds[record._thread_index];
+                        switch (static_cast<events::event_id_list>(record._event_id))
+                        {
+                        case events::event_id_list::task_executes:
+                            running[p._object] = &record;
+                            kind |= (p._flags == 0 ? s_cpu_thread : p._flags);
+                            break;
+                        case events::event_id_list::task_finished:
+                        {
+                            auto it = running.find(p._object);
+                            if (it != running.end())
+                            {
+                                writer.task(*it->second, record._timestamp);
+                                running.erase(it);
+                            }
+                            break;
+                        }
+                        case events::event_id_list::buffer_acquire_initiated:
+                            acquiring[record._thread_index] = &record;
+                            break;
+                        case events::event_id_list::buffer_set_acquired:
+                        {
+                            auto it = acquiring.find(record._thread_index);
+                            if (it != acquiring.end())
+                            {
+                                writer.complete(*it->second, record._timestamp, "buffer acquire", "buffer");
+                                acquiring.erase(it);
+                            }
+                            else
+                            {
+                                writer.instant(record, sharded_buffer::get_event_name(record._event_id), "buffer");
+                            }
+                            break;
+                        }
+                        case events::event_id_list::task_wait:
+                            if (p._flags != 0)
+                            {
+                                writer.instant(record, "task_wait", "task");
+                            }
+                            break;
+                        case events::event_id_list::task_launched_into_gpu:
+                        case events::event_id_list::task_gpu_completion_callback_invoked:
+                            kind |= gpu_task;
+                            writer.instant(record, sharded_buffer::get_event_name(record._event_id), "gpu");
+                            break;
+                        default:
+                            writer.instant(record, sharded_buffer::get_event_name(record._event_id), "runtime");
+                            break;
+                        }
+                    }
+
+                    // Tasks still running when the trace is written
+                    for (auto const& entry : running)
+                    {
+                        writer.task(*entry.second, records.back()._timestamp);
+                    }
+
+                    for (auto const& entry : thread_kinds)
+                    {
+                        writer.thread_name(entry.first, entry.second);
+                    }
+
+                    std::fputs("\n]}\n", file);
+                    bool ok = std::ferror(file) == 0;
+                    ok      = (std::fclose(file) == 0) && ok;
+                    if (!ok)
+                    {
+                        HETCOMPUTE_ELOG("Error while writing trace file %s", path);
+                    }
+                    return ok;
+                }
+
+            private:
+                // Logger ID
+                static const logger_id s_myloggerid = logger_id::chrometracelogger;
+
+                // Thread kind for threads that execute regular CPU tasks
+                static const uint32_t s_cpu_thread = 8;
+
+                // Undo the registrations done by start()
+                static std::vector<std::function<void()>>& get_unregisterers()
+                {
+                    static std::vector<std::function<void()>> unregisterers;
+                    return unregisterers;
+                }
+
+                template <typename Event>
+                static void add_handler()
+                {
+                    auto id = register_event_handler<Event>([](Event&& e, event_context&) { record(std::forward<Event>(e)); });
+                    get_unregisterers().push_back([id] { unregister_event_handler<Event>(id); });
+                }
+
+                static void append(event_id eid, uint64_t object, uint64_t arg = 0, uint32_t flags = 0)
+                {
+                    payload p;
+                    p._object = object;
+                    p._arg    = arg;
+                    p._flags  = flags;
+                    sharded_buffer::get_this_thread_buffer()->append(eid, s_myloggerid, p);
+                }
+
+                static uint64_t to_object(void const* object)
+                {
+                    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object));
+                }
+
+                static void record(events::buffer_acquire_initiated&& e)
+                {
+                    append(e.get_id(), 0);
+                }
+
+                static void record(events::buffer_release_initiated&& e)
+                {
+                    append(e.get_id(), 0);
+                }
+
+                static void record(events::buffer_set_acquired&& e)
+                {
+                    append(e.get_id(), 0);
+                }
+
+                static void record(events::group_canceled&& e)
+                {
+                    append(e.get_id(), to_object(e.get_group()));
+                }
+
+                static void record(events::group_wait_for_ended&& e)
+                {
+                    append(e.get_id(), to_object(e.get_group()));
+                }
+
+                static void record(events::task_executes&& e)
+                {
+                    uint32_t flags = (e.is_gpu() ? static_cast<uint32_t>(gpu_task) : 0) | (e.is_blocking() ? static_cast<uint32_t>(blocking_task) : 0) |
+                                     (e.is_inline() ? static_cast<uint32_t>(inlined_task) : 0);
+                    // The device thread id is only valid for tasks executed by CPU workers
+                    append(e.get_id(), to_object(e.get_task()), flags == 0 ? e.get_tid() : 0, flags);
+                }
+
+                static void record(events::task_finished&& e)
+                {
+                    append(e.get_id(), to_object(e.get_task()));
+                }
+
+                static void record(events::task_gpu_completion_callback_invoked&& e)
+                {
+                    append(e.get_id(), to_object(e.get_task()));
+                }
+
+#ifdef HETCOMPUTE_HAVE_GPU
+                static void record(events::task_launched_into_gpu&& e)
+                {
+                    append(e.get_id(), to_object(e.get_task()));
+                }
+#endif // HETCOMPUTE_HAVE_GPU
+
+                static void record(events::task_stolen&& e)
+                {
+                    append(e.get_id(), to_object(e.get_task()), e.get_tq_from());
+                }
+
+                static void record(events::task_wait&& e)
+                {
+                    append(e.get_id(), to_object(e.get_task()), 0, e.get_wait_required() ? 1 : 0);
+                }
+
+                static payload const& get_payload(trace_record const& record)
+                {
+                    return *reinterpret_cast<payload const*>(record._payload);
+                }
+
+                // Formats trace events. Timestamps are in microseconds relative to the first record.
+                class trace_writer
+                {
+                public:
+                    trace_writer(FILE* file, uint64_t base) : _file(file), _base(base), _first(true)
+                    {
+                    }
+
+                    void process_name()
+                    {
+                        separator();
+                        std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"hetcompute\"}}", _file);
+                    }
+
+                    void thread_name(uint16_t thread, uint32_t kind)
+                    {
+                        const char* name = "thread";
+                        if (kind & gpu_task)
+                        {
+                            name = "gpu dispatch";
+                        }
+                        else if (kind & blocking_task)
+                        {
+                            name = "blocking tasks";
+                        }
+                        else if (kind & s_cpu_thread)
+                        {
+                            name = "cpu worker";
+                        }
+                        else if (kind & inlined_task)
+                        {
+                            name = "main/foreign";
+                        }
+                        separator();
+                        std::fprintf(_file,
+                                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                                     static_cast<unsigned>(thread),
+                                     name,
+                                     static_cast<unsigned>(thread));
+                    }
+
+                    void task(trace_record const& executes, uint64_t finished)
+                    {
+                        auto const& p = get_payload(executes);
+                        separator();
+                        std::fprintf(_file,
+                                     "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                                     "\"args\":{\"task\":\"0x%llx\",\"exec_ctx\":%llu}}",
+                                     (p._flags & gpu_task) ? "gpu task" : ((p._flags & blocking_task) ? "blocking task" : "task"),
+                                     static_cast<unsigned>(executes._thread_index),
+                                     to_us(executes._timestamp),
+                                     static_cast<double>(finished - executes._timestamp) / 1000.0,
+                                     static_cast<unsigned long long>(p._object),
+                                     static_cast<unsigned long long>(p._arg));
+                    }
+
+                    void complete(trace_record const& record, uint64_t end, const char* name, const char* cat)
+                    {
+                        separator();
+                        std::fprintf(_file,
+                                     "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                                     name,
+                                     cat,
+                                     static_cast<unsigned>(record._thread_index),
+                                     to_us(record._timestamp),
+                                     static_cast<double>(end - record._timestamp) / 1000.0);
+                    }
+
+                    void instant(trace_record const& record, const char* name, const char* cat)
+                    {
+                        phase(record, name, cat, "i");
+                    }
+
+                private:
+                    void phase(trace_record const& record, const char* name, const char* cat, const char* ph)
+                    {
+                        auto const& p = get_payload(record);
+                        separator();
+                        std::fprintf(_file,
+                                     "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"s\":\"t\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,"
+                                     "\"args\":{\"object\":\"0x%llx\",\"arg\":%llu}}",
+                                     name,
+                                     cat,
+                                     ph,
+                                     static_cast<unsigned>(record._thread_index),
+                                     to_us(record._timestamp),
+                                     static_cast<unsigned long long>(p._object),
+                                     static_cast<unsigned long long>(p._arg));
+                    }
+
+                    void separator()
+                    {
+                        if (!_first)
+                        {
+                            std::fputs(",\n", _file);
+                        }
+                        _first = false;
+                    }
+
+                    double to_us(uint64_t timestamp) const
+                    {
+                        return static_cast<double>(timestamp - _base) / 1000.0;
+                    }
+
+                    FILE*          _file;
+                    uint64_t const _base;
+                    bool           _first;
+                };
+
+                HETCOMPUTE_DELETE_METHOD(chrome_trace_logger());
+                HETCOMPUTE_DELETE_METHOD(chrome_trace_logger(chrome_trace_logger const&));
+                HETCOMPUTE_DELETE_METHOD(chrome_trace_logger(chrome_trace_logger&&));
+                HETCOMPUTE_DELETE_METHOD(chrome_trace_logger& operator=(chrome_trace_logger const&));
+                HETCOMPUTE_DELETE_METHOD(chrome_trace_logger& operator=(chrome_trace_logger&&));
+
+            }; // class chrome_trace_logger
+
+        }; // namespace hetcompute::internal::log
+    };     // namespace hetcompute::internal
+};         // namespace hetcompute
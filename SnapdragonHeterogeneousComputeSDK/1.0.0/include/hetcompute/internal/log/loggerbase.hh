@@ -25,10 +25,11 @@ namespace hetcompute
 
                 enum class logger_id : int8_t
                 {
-                    unknown         = -1,
-                    corelogger      = 0,
-                    schedulerlogger = 1,
-                    userlogger      = 2
+                    unknown           = -1,
+                    corelogger        = 0,
+                    schedulerlogger   = 1,
+                    userlogger        = 2,
+                    chrometracelogger = 3
                 };
             }; // class logger_base
 
@@ -0,0 +1,542 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <hetcompute/internal/log/common.hh>
+#include <hetcompute/internal/log/eventids.hh>
+#include <hetcompute/internal/log/loggerbase.hh>
+#include <hetcompute/internal/util/debug.hh>
+#include <hetcompute/internal/util/memorder.hh>
+#include <hetcompute/internal/util/tlsptr.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        namespace log
+        {
+            // --------------------------------------
+            // Per-thread sharded event buffers.
+            //
+            // Unlike fast_buffer, where every writer bumps the same global counter and
+            // copies into a 512-byte slot of one shared array, each thread writes into
+            // its own ring of compact, cache-line sized records. A write is a timestamp
+            // read, a copy of at most one cache line and a release store of the thread
+            // private write index. No cache line is shared between writers.
+            //
+            // Rings register themselves in a lock-free list the first time a thread logs.
+            // Dumping takes a snapshot of every ring without stopping the writers, drops
+            // the records that might have been overwritten while they were copied, and
+            // merges all rings by timestamp.
+            // --------------------------------------
+
+            // trace_record represents an entry in a per-thread ring. It is also the
+            // on-disk format of the binary dump, so it only contains plain data.
+            struct trace_record
+            {
+                // Size of the record. Keep it a multiple of the cache line size.
+#if defined(HETCOMPUTE_THREAD_LOGGER_RECORD_SIZE)
+                static constexpr size_t s_record_size = HETCOMPUTE_THREAD_LOGGER_RECORD_SIZE;
+#else
+                static constexpr size_t s_record_size = 64;
+#endif
+
+                // Bytes left for the event payload.
+                static constexpr size_t s_payload_size = s_record_size - 2 * sizeof(uint64_t);
+
+                // Nanoseconds since the logging epoch (steady clock).
+                uint64_t _timestamp;
+                // ID of the event.
+                event_id _event_id;
+                // Index of the thread that caused the event, see sharded_buffer::get_thread_ids()
+                uint16_t _thread_index;
+                // ID of the logger
+                int8_t _logger_id;
+                // Number of valid bytes in _payload
+                uint8_t _payload_size;
+                // Event payload
+                char _payload[s_payload_size];
+            };
+
+            static_assert(sizeof(trace_record) == trace_record::s_record_size, "Unexpected padding in trace_record.");
+
+            // thread_buffer is the ring written by a single thread.
+            class thread_buffer
+            {
+            public:
+                // Number of records per thread. Must be a power of two.
+#if defined(HETCOMPUTE_THREAD_LOGGER_SIZE)
+                static constexpr size_t s_size = HETCOMPUTE_THREAD_LOGGER_SIZE;
+#else
+                static constexpr size_t s_size = 4096;
+#endif
+                static_assert((s_size & (s_size - 1)) == 0, "HETCOMPUTE_THREAD_LOGGER_SIZE must be a power of two.");
+
+                // Constructor
+                thread_buffer(uint16_t thread_index, std::thread::id thread_id)
+                    : _next(0), _thread_index(thread_index), _thread_id(thread_id), _next_buffer(nullptr), _records()
+                {
+                }
+
+                // Appends a record whose payload is the raw bytes of payload.
+                template <typename Payload>
+                void append(event_id eid, logger_base::logger_id lid, Payload const& payload)
+                {
+                    static_assert(sizeof(Payload) <= trace_record::s_payload_size, "Payload is larger than record payload.");
+                    trace_record& record = begin_record(eid, lid);
+                    std::memcpy(record._payload, &payload, sizeof(Payload));
+                    record._payload_size = static_cast<uint8_t>(sizeof(Payload));
+                    end_record();
+                }
+
+                // Appends a record whose payload is str. The string is truncated to the payload size.
+                void append(event_id eid, logger_base::logger_id lid, const char* str, size_t len)
+                {
+                    trace_record& record = begin_record(eid, lid);
+                    len                  = std::min(len, static_cast<size_t>(trace_record::s_payload_size));
+                    std::memcpy(record._payload, str, len);
+                    record._payload_size = static_cast<uint8_t>(len);
+                    end_record();
+                }
+
+                // Appends a record without payload.
+                void append(event_id eid, logger_base::logger_id lid)
+                {
+                    begin_record(eid, lid)._payload_size = 0;
+                    end_record();
+                }
+
+                // Copies the records that are guaranteed not to have been overwritten
+                // during the copy into records, oldest first.
+                void snapshot(std::vector<trace_record>& records) const
+                {
+                    size_t last  = _next.load(hetcompute::mem_order_acquire);
+                    size_t first = last > s_size ? last - s_size : 0;
+                    size_t begin = records.size();
+                    for (size_t i = first; i < last; i++)
+                    {
+                        records.push_back(_records[i & (s_size - 1)]);
+                    }
+
+                    // The owner may have wrapped around while we were copying.
+                    // Drop the records it might have overwritten, including the
+                    // slot of record now, which it may be writing right now.
+                    std::atomic_thread_fence(hetcompute::mem_order_acquire);
+                    size_t now  = _next.load(hetcompute::mem_order_relaxed);
+                    size_t safe = now + 1 > s_size ? now + 1 - s_size : 0;
+                    if (safe > first)
+                    {
+                        size_t drop = std::min(safe - first, last - first);
+                        records.erase(records.begin() + begin, records.begin() + begin + drop);
+                    }
+                }
+
+                uint16_t get_thread_index() const
+                {
+                    return _thread_index;
+                }
+
+                std::thread::id get_thread_id() const
+                {
+                    return _thread_id;
+                }
+
+                // Total number of records ever written to this ring.
+                size_t get_count() const
+                {
+                    return _next.load(hetcompute::mem_order_relaxed);
+                }
+
+                HETCOMPUTE_DELETE_METHOD(thread_buffer(thread_buffer const&));
+                HETCOMPUTE_DELETE_METHOD(thread_buffer& operator=(thread_buffer const&));
+
+            private:
+                trace_record& begin_record(event_id eid, logger_base::logger_id lid)
+                {
+                    trace_record& record = _records[_next.load(hetcompute::mem_order_relaxed) & (s_size - 1)];
+                    record._timestamp    = get_timestamp();
+                    record._event_id     = eid;
+                    record._thread_index = _thread_index;
+                    record._logger_id    = static_cast<int8_t>(lid);
+                    return record;
+                }
+
+                // Publishes the record. Only the owner thread writes _next.
+                void end_record()
+                {
+                    _next.store(_next.load(hetcompute::mem_order_relaxed) + 1, hetcompute::mem_order_release);
+                }
+
+                static uint64_t get_timestamp()
+                {
+                    return static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+                }
+
+                // Number of records written so far. The next record goes to _next % s_size.
+                std::atomic<size_t> _next;
+
+                uint16_t const        _thread_index;
+                std::thread::id const _thread_id;
+
+                // Next ring in the registry list
+                thread_buffer* _next_buffer;
+
+                std::array<trace_record, s_size> _records;
+
+                friend class sharded_buffer;
+            }; // class thread_buffer
+
+            // --------------------------------------
+            // Registry of all per-thread rings, plus dump, binary writer and reader.
+            //
+            // Binary file layout (native endianness):
+            //   file_header
+            //   file_header::_num_threads x thread_entry
+            //   file_header::_num_records x trace_record, sorted by timestamp
+            // --------------------------------------
+            class sharded_buffer
+            {
+            public:
+                struct file_header
+                {
+                    char     _magic[8];
+                    uint32_t _version;
+                    uint32_t _record_size;
+                    uint32_t _num_threads;
+                    uint32_t _reserved;
+                    uint64_t _num_records;
+                };
+
+                struct thread_entry
+                {
+                    uint64_t _thread_hash;
+                    uint16_t _thread_index;
+                    uint16_t _reserved[3];
+                };
+
+                static constexpr uint32_t s_file_version = 1;
+
+                // Returns the ring of the calling thread, creating and registering it on first use.
+                static thread_buffer* get_this_thread_buffer()
+                {
+                    auto& tls = get_tls();
+                    if (auto buffer = tls.get())
+                    {
+                        return buffer;
+                    }
+
+                    auto index  = get_thread_counter().fetch_add(1, hetcompute::mem_order_relaxed);
+                    auto buffer = new thread_buffer(static_cast<uint16_t>(index), std::this_thread::get_id());
+                    tls         = buffer;
+
+                    // Rings are never unregistered, so that the events of finished threads can still be dumped.
+                    auto& head = get_head();
+                    auto  old  = head.load(hetcompute::mem_order_relaxed);
+                    do
+                    {
+                        buffer->_next_buffer = old;
+                    } while (!head.compare_exchange_weak(old, buffer, hetcompute::mem_order_release, hetcompute::mem_order_relaxed));
+                    return buffer;
+                }
+
+                // Returns true if no thread has logged anything yet.
+                static bool is_empty()
+                {
+                    for (auto buffer = get_head().load(hetcompute::mem_order_acquire); buffer != nullptr; buffer = buffer->_next_buffer)
+                    {
+                        if (buffer->get_count() != 0)
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                // Snapshots all rings and merges them by timestamp.
+                static std::vector<trace_record> merge()
+                {
+                    std::vector<trace_record> records;
+                    for (auto buffer = get_head().load(hetcompute::mem_order_acquire); buffer != nullptr; buffer = buffer->_next_buffer)
+                    {
+                        buffer->snapshot(records);
+                    }
+                    sort_records(records);
+                    return records;
+                }
+
+                // Snapshots all rings and merges the records of logger lid by timestamp.
+                static std::vector<trace_record> merge(logger_base::logger_id lid)
+                {
+                    auto records = merge();
+                    records.erase(std::remove_if(records.begin(),
+                                                 records.end(),
+                                                 [lid](trace_record const& record) { return record._logger_id != static_cast<int8_t>(lid); }),
+                                  records.end());
+                    return records;
+                }
+
+                // Writes the merged records of all rings into a binary file. Returns false on I/O errors.
+                static bool write_binary_file(const char* path)
+                {
+                    auto records = merge();
+
+                    std::vector<thread_entry> threads;
+                    for (auto buffer = get_head().load(hetcompute::mem_order_acquire); buffer != nullptr; buffer = buffer->_next_buffer)
+                    {
+                        thread_entry entry;
+                        std::memset(&entry, 0, sizeof(entry));
+                        entry._thread_hash  = std::hash<std::thread::id>()(buffer->get_thread_id());
+                        entry._thread_index = buffer->get_thread_index();
+                        threads.push_back(entry);
+                    }
+
+                    file_header header;
+                    std::memset(&header, 0, sizeof(header));
+                    std::memcpy(header._magic, "HCTRACE", 8);
+                    header._version     = s_file_version;
+                    header._record_size = static_cast<uint32_t>(sizeof(trace_record));
+                    header._num_threads = static_cast<uint32_t>(threads.size());
+                    header._num_records = records.size();
+
+                    FILE* file = std::fopen(path, "wb");
+                    if (file == nullptr)
+                    {
+                        HETCOMPUTE_ELOG("Unable to open trace file %s", path);
+                        return false;
+                    }
+                    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+                    ok      = ok && std::fwrite(threads.data(), sizeof(thread_entry), threads.size(), file) == threads.size();
+                    ok      = ok && std::fwrite(records.data(), sizeof(trace_record), records.size(), file) == records.size();
+                    ok      = (std::fclose(file) == 0) && ok;
+                    if (!ok)
+                    {
+                        HETCOMPUTE_ELOG("Error while writing trace file %s", path);
+                    }
+                    return ok;
+                }
+
+                // Reads a file written by write_binary_file. Returns false if the file cannot be read
+                // or was written with a different record layout.
+                static bool read_binary_file(const char* path, std::vector<thread_entry>& threads, std::vector<trace_record>& records)
+                {
+                    FILE* file = std::fopen(path, "rb");
+                    if (file == nullptr)
+                    {
+                        return false;
+                    }
+
+                    file_header header;
+                    bool        ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header._magic, "HCTRACE", 8) == 0 &&
+                              header._version == s_file_version && header._record_size == sizeof(trace_record);
+                    if (ok)
+                    {
+                        threads.resize(header._num_threads);
+                        records.resize(header._num_records);
+                        ok = std::fread(threads.data(), sizeof(thread_entry), threads.size(), file) == threads.size() &&
+                             std::fread(records.data(), sizeof(trace_record), records.size(), file) == records.size();
+                    }
+                    std::fclose(file);
+                    return ok;
+                }
+
+                // Outputs the merged records. If the HETCOMPUTE_TRACE_FILE environment variable
+                // is set, they are written to that file in binary form instead. Nothing in the
+                // runtime calls it, see dump_trace_entries() in userlogapi.hh.
+                static void dump()
+                {
+                    if (is_empty())
+                    {
+                        return;
+                    }
+
+                    if (const char* path = std::getenv("HETCOMPUTE_TRACE_FILE"))
+                    {
+                        if (write_binary_file(path))
+                        {
+                            HETCOMPUTE_ILOG("Trace written to %s", path);
+                        }
+                        return;
+                    }
+
+                    auto records = merge();
+                    if (records.empty())
+                    {
+                        return;
+                    }
+                    auto first = records.front()._timestamp;
+                    for (auto const& record : records)
+                    {
+                        // chrome_trace_logger exports its own records.
+                        if (record._logger_id != static_cast<int8_t>(logger_base::logger_id::chrometracelogger))
+                        {
+                            HETCOMPUTE_ILOG("%s", to_string(record, first).c_str());
+                        }
+                    }
+                }
+
+                // Returns a one line description of the record. Timestamps are relative to base.
+                // Only uses the C library, so that offline decoders do not need the runtime.
+                static std::string to_string(trace_record const& record, uint64_t base)
+                {
+                    char line[128];
+                    std::snprintf(line,
+                                  sizeof(line),
+                                  "%12.3f us\tt%u\t%s\t",
+                                  static_cast<double>(record._timestamp - base) / 1000.0,
+                                  static_cast<unsigned>(record._thread_index),
+                                  get_event_name(record._event_id));
+                    std::string result(line);
+                    if (record._logger_id == static_cast<int8_t>(logger_base::logger_id::userlogger))
+                    {
+                        result.append(record._payload, record._payload_size);
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < record._payload_size; i++)
+                        {
+                            std::snprintf(line, sizeof(line), "%02x", static_cast<unsigned char>(record._payload[i]));
+                            result += line;
+                        }
+                    }
+                    return result;
+                }
+
+                // Returns the name of an event id.
+                static const char* get_event_name(event_id eid)
+                {
+                    typedef events::event_id_list ids;
+                    switch (static_cast<ids>(eid))
+                    {
+                    case ids::null_event:
+                        return "null_event";
+                    case ids::unknown_event:
+                        return "unknown_event";
+                    case ids::user_log_event_base:
+                        return "user_log_event";
+                    case ids::user_string_event:
+                        return "user_string_event";
+                    case ids::buffer_acquire_initiated:
+                        return "buffer_acquire_initiated";
+                    case ids::buffer_release_initiated:
+                        return "buffer_release_initiated";
+                    case ids::buffer_set_acquired:
+                        return "buffer_set_acquired";
+                    case ids::group_canceled:
+                        return "group_canceled";
+                    case ids::group_created:
+                        return "group_created";
+                    case ids::group_destroyed:
+                        return "group_destroyed";
+                    case ids::group_reffed:
+                        return "group_reffed";
+                    case ids::group_unreffed:
+                        return "group_unreffed";
+                    case ids::group_wait_for_ended:
+                        return "group_wait_for_ended";
+                    case ids::join_ut_cache:
+                        return "join_ut_cache";
+                    case ids::object_reffed:
+                        return "object_reffed";
+                    case ids::object_unreffed:
+                        return "object_unreffed";
+                    case ids::runtime_disabled:
+                        return "runtime_disabled";
+                    case ids::runtime_enabled:
+                        return "runtime_enabled";
+                    case ids::scheduler_bundled_task:
+                        return "scheduler_bundled_task";
+                    case ids::task_after:
+                        return "task_after";
+                    case ids::task_cleanup:
+                        return "task_cleanup";
+                    case ids::task_gpu_completion_callback_invoked:
+                        return "task_gpu_completion_callback_invoked";
+                    case ids::task_created:
+                        return "task_created";
+                    case ids::task_destroyed:
+                        return "task_destroyed";
+                    case ids::task_dynamic_dep:
+                        return "task_dynamic_dep";
+                    case ids::task_executes:
+                        return "task_executes";
+                    case ids::task_finished:
+                        return "task_finished";
+                    // task_launched_into_gpu and task_queue_list_created share the same id
+                    case ids::task_launched_into_gpu:
+                        return "task_launched_into_gpu";
+                    case ids::task_reffed:
+                        return "task_reffed";
+                    case ids::task_sent_to_runtime:
+                        return "task_sent_to_runtime";
+                    case ids::task_stolen:
+                        return "task_stolen";
+                    case ids::task_unreffed:
+                        return "task_unreffed";
+                    case ids::task_wait:
+                        return "task_wait";
+                    case ids::task_wait_inlined:
+                        return "task_wait_inlined";
+                    case ids::trigger_task_scheduled:
+                        return "trigger_task_scheduled";
+                    case ids::ws_tree_new_slab:
+                        return "ws_tree_new_slab";
+                    case ids::ws_tree_node_created:
+                        return "ws_tree_node_created";
+                    case ids::ws_tree_worker_try_own:
+                        return "ws_tree_worker_try_own";
+                    case ids::ws_tree_worker_try_own_success:
+                        return "ws_tree_worker_try_own_success";
+                    case ids::ws_tree_worker_try_steal:
+                        return "ws_tree_worker_try_steal";
+                    case ids::ws_tree_worker_try_steal_success:
+                        return "ws_tree_worker_try_steal_success";
+                    default:
+                        return "unknown_event";
+                    }
+                }
+
+                // Sorts records by timestamp. Ties keep per-thread order.
+                static void sort_records(std::vector<trace_record>& records)
+                {
+                    std::stable_sort(records.begin(), records.end(), [](trace_record const& a, trace_record const& b) {
+                        return a._timestamp < b._timestamp;
+                    });
+                }
+
+                HETCOMPUTE_DELETE_METHOD(sharded_buffer());
+
+            private:
+                static tlsptr<thread_buffer>& get_tls()
+                {
+                    static tlsptr<thread_buffer> s_tls;
+                    return s_tls;
+                }
+
+                static std::atomic<thread_buffer*>& get_head()
+                {
+                    static std::atomic<thread_buffer*> s_head(nullptr);
+                    return s_head;
+                }
+
+                static std::atomic<size_t>& get_thread_counter()
+                {
+                    static std::atomic<size_t> s_thread_counter(0);
+                    return s_thread_counter;
+                }
+            }; // class sharded_buffer
+
+        }; // namespace log
+    };     // namespace internal
+};         // namespace hetcompute
@@ -3,6 +3,7 @@
 
 #include <hetcompute/internal/log/events.hh>
 #include <hetcompute/internal/log/loggerbase.hh>
+#include <hetcompute/internal/log/sharded_buffer.hh>
 #include <hetcompute/internal/log/userhandlers.hh>
 
 namespace hetcompute
@@ -134,6 +135,42 @@ namespace hetcompute
                 std::strcpy(reinterpret_cast<char*>(entry.get_buffer()), s.c_str());
             }
 
+            /**
+               Add a string to the calling thread's trace buffer.
+
+               Unlike add_log_entry, which goes through the shared logging buffer
+               and the global event counter, this method only writes to a buffer
+               owned by the calling thread, so threads tracing concurrently do not
+               contend. The entries are output by dump_trace_entries() only.
+
+               @param s is the string to add. Strings longer than
+               trace_record::s_payload_size (48 bytes by default) are truncated.
+
+               This method has no return value.
+            */
+            inline void add_trace_entry(std::string const& s)
+            {
+                sharded_buffer::get_this_thread_buffer()->append(events::user_string_event::get_id(),
+                                                                 logger_base::logger_id::userlogger,
+                                                                 s.c_str(),
+                                                                 s.size());
+            }
+
+            /**
+               Output the entries added with add_trace_entry.
+
+               The entries of all threads are merged by timestamp. If the
+               HETCOMPUTE_TRACE_FILE environment variable is set, they are
+               written to that file in binary form (see the TraceDecoder sample),
+               otherwise they are logged.
+
+               The runtime does not output them on its own, so call this method
+               before hetcompute::runtime::shutdown().
+
+               This method has no return value.
+            */
+            inline void dump_trace_entries() { sharded_buffer::dump(); }
+
         }; // namespace log
     };     // namespace internal
 };         // namespace hetcompute
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <hetcompute/taskfactory.hh>
+#include <hetcompute/internal/util/memorder.hh>
+
+namespace hetcompute
+{
+    namespace pattern
+    {
+        /** @addtogroup pfor_each_doc
+            @{ */
+
+        /**
+         * Work done by one kind of device in a heterogeneous pfor_each
+         * executed with hetcompute::pattern::tuner::set_dynamic_hetero().
+         */
+        struct chunk_stats
+        {
+            /** Number of chunks the device executed. */
+            size_t chunks;
+            /** Number of iterations of the outermost dimension in those chunks. */
+            size_t iterations;
+            /** Time spent executing the chunks, in microseconds. */
+            uint64_t busy_time;
+        };
+
+        /** @} */ /* end_addtogroup pfor_each_doc */
+    }; // namespace pattern
+
+    namespace internal
+    {
+        namespace hetero
+        {
+            enum class device_kind
+            {
+                cpu = 0,
+                gpu = 1,
+                dsp = 2
+            };
+
+            static HETCOMPUTE_CONSTEXPR_CONST size_t num_device_kinds = 3;
+
+            // Shares an iteration space among devices of different speed.
+            //
+            // The range sits on a shared queue. Each device has a dispatcher that
+            // takes a chunk off the front of the queue, executes it through its
+            // launcher, and comes back for more until the queue is drained. A
+            // dispatcher that has not completed a chunk yet takes a small probe
+            // chunk. After that, a dispatcher takes half of its throughput share
+            // of the remaining iterations. Every device then spends about the same
+            // time on its next chunk, so all of them run out of work at about the
+            // same time, whatever their speed. A device that gets slower, e.g.
+            // because it is throttled or busy, takes smaller chunks from then on.
+            //
+            // Launchers execute [begin, end) synchronously. They are plain
+            // functions, so a device can be replaced by a CPU stand-in.
+            class dynamic_scheduler
+            {
+            public:
+                typedef std::function<void(size_t, size_t)> launcher;
+
+                // Chunks are multiples of stride iterations, starting at first, and
+                // hold at least min_chunk iterations unless the range ends.
+                dynamic_scheduler(size_t first, size_t last, size_t stride, size_t min_chunk)
+                    : _first(first),
+                      _last(last),
+                      _stride(std::max<size_t>(stride, 1)),
+                      _min_chunk(std::max<size_t>(min_chunk, 1)),
+                      _probe(_min_chunk),
+                      _next(first),
+                      _dispatchers(),
+                      _state()
+                {
+                }
+
+                // Adds a device. Must be called before run().
+                void add_dispatcher(device_kind kind, launcher l) { _dispatchers.push_back(std::make_pair(kind, std::move(l))); }
+
+                size_t num_dispatchers() const { return _dispatchers.size(); }
+
+                // Runs until the range is drained. The first dispatcher runs on the
+                // calling thread, the others in tasks.
+                void run()
+                {
+                    size_t n = _dispatchers.size();
+                    HETCOMPUTE_API_ASSERT(n > 0, "Dynamic scheduling requires at least one device!");
+
+                    _state.reset(new dispatcher_state[n]);
+                    _next.store(_first, hetcompute::mem_order_relaxed);
+                    _probe = std::max(_min_chunk, (_last - _first) / (n * initial_split));
+
+                    if (n == 1)
+                    {
+                        dispatch(0);
+                        return;
+                    }
+
+                    auto g = hetcompute::create_group();
+                    for (size_t i = 1; i < n; ++i)
+                    {
+                        g->launch([this, i] { dispatch(i); });
+                    }
+                    dispatch(0);
+                    g->wait_for();
+                }
+
+                // Chunks executed by the i-th dispatcher added, in the order taken
+                std::vector<std::pair<size_t, size_t>> const& get_chunks(size_t i) const
+                {
+                    HETCOMPUTE_INTERNAL_ASSERT(_state != nullptr && i < _dispatchers.size(), "Invalid dispatcher!");
+                    return _state[i]._chunks;
+                }
+
+                // Work done by all dispatchers of a kind of device
+                hetcompute::pattern::chunk_stats get_stats(device_kind kind) const
+                {
+                    hetcompute::pattern::chunk_stats stats = { 0, 0, 0 };
+                    for (size_t i = 0; _state != nullptr && i < _dispatchers.size(); ++i)
+                    {
+                        if (_dispatchers[i].first != kind)
+                            continue;
+                        for (auto const& chunk : _state[i]._chunks)
+                        {
+                            stats.iterations += chunk.second - chunk.first;
+                        }
+                        stats.chunks += _state[i]._chunks.size();
+                        stats.busy_time += _state[i]._busy_time / 1000;
+                    }
+                    return stats;
+                }
+
+            private:
+                // A dispatcher takes 1/initial_split of its share as probe chunk
+                static HETCOMPUTE_CONSTEXPR_CONST size_t initial_split = 8;
+
+                struct dispatcher_state
+                {
+                    // Iterations per nanosecond, 0 until the first chunk completes.
+                    // Written by the dispatcher, read by all of them.
+                    std::atomic<double> _rate;
+                    // Only accessed by the dispatcher until run() returns
+                    std::vector<std::pair<size_t, size_t>> _chunks;
+                    uint64_t                               _busy_time;
+
+                    dispatcher_state() : _rate(0), _chunks(), _busy_time(0) {}
+                };
+
+                size_t chunk_size(size_t i) const
+                {
+                    double rate = _state[i]._rate.load(hetcompute::mem_order_relaxed);
+                    if (rate == 0)
+                    {
+                        return _probe;
+                    }
+
+                    // Devices without a measurement yet are assumed to be as fast as this one
+                    double total = 0;
+                    for (size_t j = 0; j < _dispatchers.size(); ++j)
+                    {
+                        double r = _state[j]._rate.load(hetcompute::mem_order_relaxed);
+                        total += r == 0 ? rate : r;
+                    }
+
+                    size_t next      = _next.load(hetcompute::mem_order_relaxed);
+                    size_t remaining = next < _last ? _last - next : 0;
+                    return std::max(_min_chunk, static_cast<size_t>(remaining * (rate / total) / 2));
+                }
+
+                // Takes up to n iterations off the queue, returns false once it is drained
+                bool take(size_t n, size_t& begin, size_t& end)
+                {
+                    n     = (n + _stride - 1) / _stride * _stride;
+                    begin = _next.fetch_add(n, hetcompute::mem_order_relaxed);
+                    if (begin >= _last)
+                    {
+                        return false;
+                    }
+                    end = std::min(begin + n, _last);
+                    return true;
+                }
+
+                void dispatch(size_t i)
+                {
+                    auto&  state = _state[i];
+                    auto&  l     = _dispatchers[i].second;
+                    size_t begin = 0, end = 0;
+                    while (take(chunk_size(i), begin, end))
+                    {
+                        uint64_t start = hetcompute_get_time_now();
+                        l(begin, end);
+                        uint64_t elapsed = std::max<uint64_t>(hetcompute_get_time_now() - start, 1);
+
+                        double rate     = static_cast<double>(end - begin) / static_cast<double>(elapsed);
+                        double previous = state._rate.load(hetcompute::mem_order_relaxed);
+                        // Moving average, so one noisy chunk does not skew the shares
+                        state._rate.store(previous == 0 ? rate : (previous + rate) / 2, hetcompute::mem_order_relaxed);
+                        state._chunks.push_back(std::make_pair(begin, end));
+                        state._busy_time += elapsed;
+                    }
+                }
+
+                const size_t                                  _first;
+                const size_t                                  _last;
+                const size_t                                  _stride;
+                const size_t                                  _min_chunk;
+                size_t                                        _probe;
+                std::atomic<size_t>                           _next;
+                std::vector<std::pair<device_kind, launcher>> _dispatchers;
+                std::unique_ptr<dispatcher_state[]>           _state;
+
+                dynamic_scheduler(dynamic_scheduler const&) = delete;
+                dynamic_scheduler& operator=(dynamic_scheduler const&) = delete;
+            };
+
+        }; // namespace hetero
+    };     // namespace internal
+};         // namespace hetcompute
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#ifdef HETCOMPUTE_HAVE_RTTI
+#include <typeinfo>
+#endif // HETCOMPUTE_HAVE_RTTI
+
+#include <hetcompute/range.hh>
+#include <hetcompute/internal/util/debug.hh>
+
+namespace hetcompute
+{
+    template <typename Fn>
+    class cpu_kernel;
+
+    template <typename Fn>
+    class dsp_kernel;
+
+    namespace internal
+    {
+        namespace hetero
+        {
+            // Execution time per iteration of the outermost dimension on each
+            // device, in nanoseconds. 0 if never measured.
+            struct device_profile
+            {
+                double cpu;
+                double gpu;
+                double dsp;
+                size_t samples;
+
+                // Splits 100 load units among the devices used, in proportion to their
+                // throughput. Every device used gets at least one unit, so it keeps
+                // being measured. Devices not measured yet count as fast as the cpu.
+                void get_loads(bool use_gpu, bool use_dsp, size_t& cpu_load, size_t& gpu_load, size_t& dsp_load) const
+                {
+                    double cpu_tp   = 1.0;
+                    double gpu_tp   = !use_gpu ? 0 : (gpu > 0 && cpu > 0 ? cpu / gpu : 1.0);
+                    double dsp_tp   = !use_dsp ? 0 : (dsp > 0 && cpu > 0 ? cpu / dsp : 1.0);
+                    double total_tp = cpu_tp + gpu_tp + dsp_tp;
+
+                    gpu_load = !use_gpu ? 0 : std::min<size_t>(std::max<size_t>(std::lround(100 * gpu_tp / total_tp), 1), 98);
+                    dsp_load = !use_dsp ? 0 : std::min<size_t>(std::max<size_t>(std::lround(100 * dsp_tp / total_tp), 1), 99 - gpu_load);
+                    cpu_load = 100 - gpu_load - dsp_load;
+                }
+            };
+
+            // Device profiles of heterogeneous pfor_each calls, kept across calls
+            // and across runs.
+            //
+            // A profile is keyed by the kernels, the argument types, the shape of
+            // the range and the number of iterations rounded down to a power of 2.
+            // New measurements are blended into it with an exponential moving
+            // average.
+            //
+            // A kernel is identified by its type, and by the function it calls if
+            // that is a function pointer. With RTTI, types are identified by their
+            // mangled names, which tell every lambda apart and are stable across
+            // builds. Without RTTI, and for functions, the position in the program
+            // is used instead, which is stable across runs of the same build.
+            //
+            // The profiles are kept in memory only, unless the
+            // HETCOMPUTE_PROFILE_CACHE_FILE environment variable names a file. They
+            // are then loaded from it by runtime::init() and written back at exit:
+            // runtime::shutdown() is defined in the runtime library.
+            class profile_cache
+            {
+            public:
+                typedef uint64_t key_type;
+
+                static profile_cache& get()
+                {
+                    static profile_cache cache;
+                    return cache;
+                }
+
+                template <typename ArgTuple, size_t Dims, typename... Kernels>
+                static key_type make_key(std::tuple<Kernels...>& klist, const hetcompute::range<Dims>& r)
+                {
+                    key_type key = hash_kernels<sizeof...(Kernels)>::hash(klist, fnv_offset);
+                    key          = hash_type<ArgTuple>(key);
+                    key          = hash_value(Dims, key);
+                    key          = hash_value(r.stride(0), key);
+                    for (size_t i = 1; i < Dims; ++i)
+                    {
+                        key = hash_value(r.end(i) - r.begin(i), key);
+                        key = hash_value(r.stride(i), key);
+                    }
+
+                    size_t bucket = 0;
+                    for (size_t n = r.end(0) - r.begin(0); n > 1; n >>= 1)
+                    {
+                        bucket++;
+                    }
+                    return hash_value(bucket, key);
+                }
+
+                // Returns false if there is no profile for key
+                bool lookup(key_type key, device_profile& profile)
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto                        it = _profiles.find(key);
+                    if (it == _profiles.end())
+                    {
+                        return false;
+                    }
+                    profile = it->second;
+                    return true;
+                }
+
+                // Blends the devices measured (non-zero times) into the profile of key
+                void update(key_type key, device_profile const& measured)
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto                        it = _profiles.find(key);
+                    if (it == _profiles.end())
+                    {
+                        device_profile profile = measured;
+                        profile.samples        = 1;
+                        _profiles[key]         = profile;
+                    }
+                    else
+                    {
+                        blend(it->second.cpu, measured.cpu);
+                        blend(it->second.gpu, measured.gpu);
+                        blend(it->second.dsp, measured.dsp);
+                        it->second.samples++;
+                    }
+                    _dirty = true;
+                }
+
+                // Writes the profiles to the cache file. Returns false on I/O errors.
+                bool save()
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (!_dirty || _path.empty())
+                    {
+                        return true;
+                    }
+
+                    FILE* file = std::fopen(_path.c_str(), "w");
+                    if (file == nullptr)
+                    {
+                        HETCOMPUTE_ILOG("Could not write profile cache %s", _path.c_str());
+                        return false;
+                    }
+                    std::fprintf(file, "%s\n", file_header());
+                    for (auto const& entry : _profiles)
+                    {
+                        std::fprintf(file,
+                                     "%016llx %.17g %.17g %.17g %zu\n",
+                                     static_cast<unsigned long long>(entry.first),
+                                     entry.second.cpu,
+                                     entry.second.gpu,
+                                     entry.second.dsp,
+                                     entry.second.samples);
+                    }
+                    bool ok = std::fclose(file) == 0;
+                    _dirty  = !ok;
+                    return ok;
+                }
+
+                // Reads the profiles from the cache file, once
+                void load()
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (_loaded || _path.empty())
+                    {
+                        return;
+                    }
+                    _loaded = true;
+
+                    FILE* file = std::fopen(_path.c_str(), "r");
+                    if (file == nullptr)
+                    {
+                        return;
+                    }
+
+                    char line[128];
+                    if (std::fgets(line, sizeof(line), file) != nullptr && std::string(line).find(file_header()) == 0)
+                    {
+                        unsigned long long key;
+                        device_profile     profile;
+                        while (std::fscanf(file, "%llx %lg %lg %lg %zu", &key, &profile.cpu, &profile.gpu, &profile.dsp, &profile.samples) == 5)
+                        {
+                            // Profiles measured before loading are newer
+                            _profiles.insert(std::make_pair(key, profile));
+                        }
+                    }
+                    std::fclose(file);
+                }
+
+                ~profile_cache() { save(); }
+
+            private:
+                static HETCOMPUTE_CONSTEXPR_CONST key_type fnv_offset = 14695981039346656037ULL;
+                static HETCOMPUTE_CONSTEXPR_CONST key_type fnv_prime  = 1099511628211ULL;
+
+                // Format and version of the cache file
+                static const char* file_header() { return "# hetcompute profiles 2"; }
+
+                profile_cache() : _mutex(), _profiles(), _path(), _dirty(false), _loaded(false)
+                {
+                    const char* path = std::getenv("HETCOMPUTE_PROFILE_CACHE_FILE");
+                    _path            = path != nullptr ? path : "";
+                }
+
+                // An object with one instance per type, placed in the program like
+                // the kernels
+                template <typename T>
+                struct type_tag
+                {
+                    static const char value;
+                };
+
+                // Offset of p from a fixed point of the program, which does not
+                // change from run to run when the program is loaded at another address
+                static uint64_t program_offset(void const* p)
+                {
+                    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(&type_tag<void>::value));
+                }
+
+                template <typename T>
+                static key_type hash_type(key_type h)
+                {
+#ifdef HETCOMPUTE_HAVE_RTTI
+                    return hash(typeid(T).name(), h);
+#else
+                    return hash_value(program_offset(&type_tag<T>::value), h);
+#endif // HETCOMPUTE_HAVE_RTTI
+                }
+
+                template <typename R, typename... Args>
+                static key_type hash_function(R (*fn)(Args...), key_type h)
+                {
+                    return hash_value(program_offset(reinterpret_cast<void const*>(fn)), h);
+                }
+
+                // Lambdas and function objects are identified by their type alone
+                template <typename Fn>
+                static key_type hash_function(Fn const&, key_type h)
+                {
+                    return h;
+                }
+
+                template <typename Kernel>
+                static key_type hash_kernel(Kernel& k, key_type h)
+                {
+                    return hash_function(k, hash_type<Kernel>(h));
+                }
+
+                template <typename Fn>
+                static key_type hash_kernel(hetcompute::cpu_kernel<Fn>& k, key_type h)
+                {
+                    return hash_function(k.get_fn(), hash_type<hetcompute::cpu_kernel<Fn>>(h));
+                }
+
+                template <typename Fn>
+                static key_type hash_kernel(hetcompute::dsp_kernel<Fn>& k, key_type h)
+                {
+                    return hash_function(k.get_fn(), hash_type<hetcompute::dsp_kernel<Fn>>(h));
+                }
+
+                template <size_t N, typename Dummy = void>
+                struct hash_kernels
+                {
+                    template <typename KernelTuple>
+                    static key_type hash(KernelTuple& klist, key_type h)
+                    {
+                        return hash_kernel(std::get<N - 1>(klist), hash_kernels<N - 1>::hash(klist, h));
+                    }
+                };
+
+                template <typename Dummy>
+                struct hash_kernels<0, Dummy>
+                {
+                    template <typename KernelTuple>
+                    static key_type hash(KernelTuple&, key_type h)
+                    {
+                        return h;
+                    }
+                };
+
+                static key_type hash(const char* s, key_type h)
+                {
+                    for (; *s != '\0'; ++s)
+                    {
+                        h = (h ^ static_cast<unsigned char>(*s)) * fnv_prime;
+                    }
+                    return h;
+                }
+
+                static key_type hash_value(uint64_t v, key_type h)
+                {
+                    for (size_t i = 0; i < sizeof(v); ++i, v >>= 8)
+                    {
+                        h = (h ^ (v & 0xff)) * fnv_prime;
+                    }
+                    return h;
+                }
+
+                static void blend(double& average, double sample)
+                {
+                    if (sample <= 0)
+                    {
+                        return;
+                    }
+                    // Weight of a new measurement in the moving average
+                    const double weight = 0.25;
+                    average             = average <= 0 ? sample : (1 - weight) * average + weight * sample;
+                }
+
+                std::mutex                         _mutex;
+                std::map<key_type, device_profile> _profiles;
+                std::string                        _path;
+                bool                               _dirty;
+                bool                               _loaded;
+
+                profile_cache(profile_cache const&) = delete;
+                profile_cache& operator=(profile_cache const&) = delete;
+            };
+
+            template <typename T>
+            const char profile_cache::type_tag<T>::value = 0;
+
+        }; // namespace hetero
+    };     // namespace internal
+};         // namespace hetcompute
@@ -1,45 +1,210 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
 #include <hetcompute/internal/patterns/common.hh>
+#include <hetcompute/internal/util/memorder.hh>
 
 namespace hetcompute
 {
     namespace internal
     {
+        /// Bump allocator backing the work tree of one pdivide_and_conquer
+        /// invocation.
+        ///
+        /// Memory is carved out of blocks of geometrically growing size with an
+        /// atomic bump of the block offset, so tasks on different threads can
+        /// allocate concurrently without taking a lock; only chaining a new block
+        /// does. Nothing is freed individually: all blocks are released at once
+        /// when the arena is destroyed.
+        class dnc_arena
+        {
+        public:
+            dnc_arena() : _current(nullptr), _mutex(), _next_block_size(initial_block_size) {}
+
+            ~dnc_arena()
+            {
+                block* b = _current.load(hetcompute::mem_order_relaxed);
+                while (b != nullptr)
+                {
+                    block* prev = b->_prev;
+                    b->~block();
+                    ::operator delete(b);
+                    b = prev;
+                }
+            }
+
+            /// Returns bytes of storage aligned for any scalar type
+            void* allocate(size_t bytes)
+            {
+                bytes = round_up(bytes);
+                while (true)
+                {
+                    block* b = _current.load(hetcompute::mem_order_acquire);
+                    if (b != nullptr)
+                    {
+                        // A failed bump leaves the offset past the end, which only
+                        // wastes the tail of a block that is full anyway.
+                        size_t offset = b->_used.fetch_add(bytes, hetcompute::mem_order_relaxed);
+                        if (offset + bytes <= b->_size)
+                        {
+                            return b->data() + offset;
+                        }
+                    }
+                    grow(b, bytes);
+                }
+            }
+
+        private:
+            static HETCOMPUTE_CONSTEXPR_CONST size_t alignment         = alignof(std::max_align_t);
+            static HETCOMPUTE_CONSTEXPR_CONST size_t initial_block_size = 4096;
+            static HETCOMPUTE_CONSTEXPR_CONST size_t max_block_size     = 1 << 20;
+
+            struct block
+            {
+                block*              _prev;
+                size_t              _size;
+                std::atomic<size_t> _used;
+
+                block(block* prev, size_t size) : _prev(prev), _size(size), _used(0) {}
+
+                char* data() { return reinterpret_cast<char*>(this) + round_up(sizeof(block)); }
+            };
+
+            static size_t round_up(size_t bytes) { return (bytes + alignment - 1) & ~(alignment - 1); }
+
+            // Chains a block of at least bytes, unless another thread replaced full already
+            void grow(block* full, size_t bytes)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_current.load(hetcompute::mem_order_relaxed) != full)
+                {
+                    return;
+                }
+                size_t size      = std::max(_next_block_size, bytes);
+                _next_block_size = std::min(size * 2, static_cast<size_t>(max_block_size));
+                void* mem        = ::operator new(round_up(sizeof(block)) + size);
+                _current.store(new (mem) block(full, size), hetcompute::mem_order_release);
+            }
+
+            std::atomic<block*> _current;
+            std::mutex          _mutex;
+            size_t              _next_block_size;
+
+            dnc_arena(dnc_arena const&) = delete;
+            dnc_arena& operator=(dnc_arena const&) = delete;
+        };
+
         /// Node in the pdivide-and-conquer work tree
         /// Captures a Problem and stores computed Solution
         template <typename Problem, typename Solution>
         struct dnc_node
         {
-            explicit dnc_node(Problem p) : _problem(p), _solution(), _subproblems() {}
+            explicit dnc_node(Problem const& p) : _problem(p), _solution(), _subproblems(nullptr), _num_subproblems(0) {}
 
-            // The following two methods are recommended if Problem/Solution is a pointer
-            // type.
-            dnc_node(const dnc_node& other)
+            dnc_node* begin() const { return _subproblems; }
+            dnc_node* end() const { return _subproblems + _num_subproblems; }
+
+            Problem  _problem;
+            Solution _solution;
+
+            // Any subproblems into which _problem is split. They sit next to each
+            // other in the arena of the tree, so a split allocates once whatever
+            // its arity.
+            dnc_node* _subproblems;
+            size_t    _num_subproblems;
+
+        private:
+            dnc_node(dnc_node const&) = delete;
+            dnc_node& operator=(dnc_node const&) = delete;
+        };
+
+        /// Work tree of one pdivide_and_conquer invocation.
+        ///
+        /// Nodes are allocated from the arena of the tree and are not reference
+        /// counted: every task of the invocation runs before the continuation of
+        /// the root, which owns the tree, so they may hold raw node pointers. The
+        /// whole tree is released in one go when the root is merged.
+        template <typename Problem, typename Solution>
+        class dnc_tree
+        {
+        public:
+            typedef dnc_node<Problem, Solution> node_type;
+
+            explicit dnc_tree(Problem const& p) : _arena(), _root(p) {}
+
+            ~dnc_tree()
             {
-                _problem     = other._problem;
-                _solution    = other._solution;
-                _subproblems = other._subproblems;
+                if (!std::is_trivially_destructible<node_type>::value)
+                {
+                    destroy_subproblems(&_root);
+                }
             }
 
-            dnc_node& operator=(const dnc_node& other)
+            node_type* root() { return &_root; }
+
+            /// Adds the subproblems returned by split to n. Thread safe for
+            /// different nodes.
+            template <typename Subproblems>
+            void split(node_type* n, Subproblems const& subproblems)
             {
-                if (this != &other)
+                HETCOMPUTE_INTERNAL_ASSERT(n->_num_subproblems == 0, "work node should have no subproblems just yet");
+                size_t num = static_cast<size_t>(std::distance(std::begin(subproblems), std::end(subproblems)));
+                if (num == 0)
+                {
+                    return;
+                }
+                n->_subproblems = static_cast<node_type*>(_arena.allocate(num * sizeof(node_type)));
+                // Count each node once constructed, so that a throwing copy of a
+                // Problem leaves only constructed nodes for the destructor.
+                for (auto const& p : subproblems)
                 {
-                    _problem     = other._problem;
-                    _solution    = other._solution;
-                    _subproblems = other._subproblems;
+                    new (n->_subproblems + n->_num_subproblems) node_type(p);
+                    n->_num_subproblems++;
                 }
-                return *this;
             }
 
-            Problem  _problem;
-            Solution _solution;
+        private:
+            static_assert(alignof(node_type) <= alignof(std::max_align_t), "Over-aligned problems and solutions are not supported.");
+
+            static void destroy_subproblems(node_type* n)
+            {
+                for (auto& m : *n)
+                {
+                    destroy_subproblems(&m);
+                    m.~node_type();
+                }
+            }
 
-            // Any subproblems into which _problem is split
-            std::vector<std::shared_ptr<dnc_node>> _subproblems;
+            dnc_arena _arena;
+            node_type _root;
+
+            dnc_tree(dnc_tree const&) = delete;
+            dnc_tree& operator=(dnc_tree const&) = delete;
         };
 
+        /// Merges the solutions of the subproblems of n. They are moved out, as
+        /// nothing reads them after their parent is merged.
+        template <typename Problem, typename Solution, typename Fn>
+        Solution dnc_merge(dnc_node<Problem, Solution>* n, Fn&& merge)
+        {
+            std::vector<Solution> sols;
+            sols.reserve(n->_num_subproblems);
+            for (auto& m : *n)
+            {
+                sols.push_back(std::move(m._solution));
+            }
+            return merge(n->_problem, sols);
+        }
+
         /// Workhorse of the pdivide_and_conquer pattern.
         ///
         /// is_base_case, base, split, and merge are lambdas used in the
@@ -48,11 +213,13 @@ namespace hetcompute
         ///
         /// @param g         Launch any internal tasks into this group if not null
         /// @param c         Task representing continuation of work tree node 'n'
+        /// @param t         Work tree that 'n' belongs to
         /// @param n         Work tree node associated with problem
         /// @param is_base_n True if 'n' is a base case problem, false otherwise
         template <typename Problem, typename Solution, typename Fn1, typename Fn2, typename Fn3, typename Fn4>
         void pdivide_and_conquer_internal(group_ptr                    g,
                                           task_ptr<>                   c,
+                                          dnc_tree<Problem, Solution>* t,
                                           dnc_node<Problem, Solution>* n,
                                           Fn1&&                        is_base_case,
                                           Fn2&&                        base,
@@ -60,7 +227,7 @@ namespace hetcompute
                                           Fn4&&                        merge,
                                           bool                         is_base_n)
         {
-            HETCOMPUTE_INTERNAL_ASSERT(n->_subproblems.empty(), "work node should have no subproblems just yet");
+            HETCOMPUTE_INTERNAL_ASSERT(n->_num_subproblems == 0, "work node should have no subproblems just yet");
 
             if (is_base_n)
             {
@@ -69,37 +236,24 @@ namespace hetcompute
             }
             else
             {
-                for (auto i : split(n->_problem))
+                t->split(n, split(n->_problem));
+                for (auto node_i = n->begin(); node_i != n->end(); ++node_i)
                 {
-                    // Lifetime of node_i is the same as the lifetime of its parent, n.
-                    // Use smart pointer so that node is automatically deallocated in
-                    // exceptional circumstances / early returns.
-                    auto node_i = std::make_shared<dnc_node<Problem, Solution>>(i);
-                    n->_subproblems.push_back(node_i);
                     // Create child task's continuation here itself.
                     // This is so that the current task's continuation may have the right
                     // dependencies on either the children tasks or the children tasks'
                     // continuations.
-                    auto is_base_i  = is_base_case(i);
+                    auto is_base_i  = is_base_case(node_i->_problem);
                     auto cont_child = is_base_i ? nullptr : hetcompute::create_task([=]() {
                         // This continuation will not be invoked if there isn't atleast one
                         // subproblem.
-                        HETCOMPUTE_INTERNAL_ASSERT(!node_i->_subproblems.empty(), "need atleast one subproblem to merge");
-                        std::vector<Solution> sols(node_i->_subproblems.size());
-                        std::transform(node_i->_subproblems.begin(),
-                                       node_i->_subproblems.end(),
-                                       sols.begin(),
-                                       [](std::shared_ptr<dnc_node<Problem, Solution>> m) { return m->_solution; });
-                        node_i->_solution = merge(i, sols);
+                        HETCOMPUTE_INTERNAL_ASSERT(node_i->_num_subproblems != 0, "need atleast one subproblem to merge");
+                        node_i->_solution = dnc_merge(node_i, merge);
                     });
 
                     // Create child task
-                    auto task_child = hetcompute::create_task([=] {
-                        // Pass node_i's raw pointer to function because function argument's
-                        // lifetime is exceeded by lifetime of node_i itself. Therefore, we
-                        // don't need to track references in this function call.
-                        internal::pdivide_and_conquer_internal(g, cont_child, node_i.get(), is_base_case, base, split, merge, is_base_i);
-                    });
+                    auto task_child = hetcompute::create_task(
+                        [=] { internal::pdivide_and_conquer_internal(g, cont_child, t, node_i, is_base_case, base, split, merge, is_base_i); });
                     internal::c_ptr(task_child)->launch(internal::c_ptr(g), nullptr);
 
                     // If child task is a base case, current task's continuation depends on
@@ -200,33 +354,19 @@ namespace hetcompute
             }
             else
             {
-                // Lifetime of n is this lexical scope.
-                // Use smart pointer so that node is automatically deallocated in
-                // exceptional circumstances / early returns.
-                // Lifetime of nodes corresponding to subproblems in n->_subproblems
-                // corresponds to the lifetime of n. This means that the tree of nodes will
-                // be deallocated only at the end of this lexical scope! In reality, for
-                // any node ni, ni->_subproblems needs to be live only until the
-                // 'merge' task associated with ni executes. However, orchestrating this in
-                // the presence of tasks executing lambdas is hard -- there is a tension
-                // between the need for dynamic transfer of exclusive ownership and the
-                // existing facility for static transfer of exclusive ownership via
-                // std::move in lexical scopes.
-                auto n    = std::make_shared<internal::dnc_node<Problem, Solution>>(p);
-                auto cont = hetcompute::create_task([n, p, merge] {
-                    // n->_subproblems could be empty if split did not create any subproblems
-                    std::vector<Solution> sols(n->_subproblems.size());
-                    std::transform(n->_subproblems.begin(),
-                                   n->_subproblems.end(),
-                                   sols.begin(),
-                                   [](std::shared_ptr<internal::dnc_node<Problem, Solution>> m) { return m->_solution; });
-                    n->_solution = merge(p, sols);
-                    return n->_solution;
+                // The continuation of the root owns the work tree and releases it
+                // once the root is merged. All other tasks of the tree complete
+                // before it runs, so they refer to the tree and its nodes through
+                // raw pointers.
+                auto tree = std::make_shared<internal::dnc_tree<Problem, Solution>>(p);
+                auto t    = tree.get();
+                auto cont = hetcompute::create_task([tree, merge]() mutable {
+                    // The root could have no subproblems if split did not create any
+                    Solution sol = internal::dnc_merge(tree->root(), merge);
+                    tree.reset();
+                    return sol;
                 });
-                // Pass raw pointer to n to function because function argument's lifetime
-                // is exceeded by lifetime of n itself. Therefore, we don't need to track
-                // references in this function call.
-                internal::pdivide_and_conquer_internal(g, cont, n.get(), is_base, base, split, merge, false /* not base case */);
+                internal::pdivide_and_conquer_internal(g, cont, t, t->root(), is_base, base, split, merge, false /* not base case */);
                 return cont;
             }
         }
@@ -2,7 +2,9 @@
 
 #include <hetcompute/internal/patterns/cpu_pfor_each.hh>
 #include <hetcompute/internal/patterns/gpu_pfor_each.hh>
+#include <hetcompute/internal/patterns/hetero/dynamic_scheduler.hh>
 #include <hetcompute/internal/patterns/hetero/pfor_each_helper.hh>
+#include <hetcompute/internal/patterns/hetero/profile_cache.hh>
 #include <hetcompute/internal/pointkernel/pointkernel-internal.hh>
 
 namespace hetcompute
@@ -196,6 +198,162 @@ namespace hetcompute
             return t;
         }
 
+        // Executes a heterogeneous pfor_each with tuner::set_dynamic_hetero().
+        // The cpu executes its chunks in the output buffer directly. The gpu and
+        // each dsp thread write theirs to their local output buffer, from which
+        // the chunks are copied to the output once the range is drained.
+        template <size_t CKIdx,
+                  size_t GKIdx,
+                  size_t HKIdx,
+                  size_t OutIdx,
+                  bool   CalledWithPK,
+                  size_t Dims,
+                  typename KernelTuple,
+                  typename ArgTuple,
+                  typename T,
+                  typename Buf_Tuple>
+        void pfor_each_dynamic(hetero::dynamic_scheduler&        scheduler,
+                               const hetcompute::range<Dims>&    r,
+                               KernelTuple&                      klist,
+                               ArgTuple&                         arg_list,
+                               Buf_Tuple&                        buf_tup,
+                               T*                                optr,
+                               const hetcompute::pattern::tuner& tuner,
+                               const bool                        use_gpu,
+                               const bool                        use_dsp)
+        {
+            HETCOMPUTE_UNUSED(buf_tup);
+            HETCOMPUTE_UNUSED(optr);
+            HETCOMPUTE_UNUSED(use_gpu);
+            HETCOMPUTE_UNUSED(use_dsp);
+
+            // Elements of output per iteration of the outermost dimension
+            const size_t first     = r.begin(0);
+            const size_t nd_offset = r.linearized_distance() / std::max<size_t>(r.end(0) - first, 1);
+
+            // Offset in the output buffer of iteration begin, and bytes of output in [begin, end)
+            auto offset = [&](size_t begin) { return (begin - first) * nd_offset; };
+            auto bytes  = [&](size_t begin, size_t end) { return (end - begin) * nd_offset * sizeof(T); };
+            HETCOMPUTE_UNUSED(offset);
+            HETCOMPUTE_UNUSED(bytes);
+
+            // The first dispatcher runs on the calling thread, so add the cpu first
+            if (CKIdx != invalid_pos)
+            {
+                scheduler.add_dispatcher(hetero::device_kind::cpu, [&](size_t begin, size_t end) {
+                    execute_on_cpu<CKIdx, Dims, KernelTuple, ArgTuple, CalledWithPK>::kernel_launch(create_range<Dims>::create(r, begin, end),
+                                                                                                  klist,
+                                                                                                  arg_list,
+                                                                                                  tuner);
+                });
+            }
+
+#if defined(HETCOMPUTE_HAVE_OPENCL)
+            hetcompute::buffer_ptr<T> gpu_buffer     = std::get<0>(buf_tup);
+            size_t                    gpu_dispatcher = scheduler.num_dispatchers();
+            auto                      gpu_group      = hetcompute::create_group();
+            if (use_gpu)
+            {
+                // Elements skipped by the strides pass through unchanged. Copy them
+                // once for the whole range: acquire_wi() discards the local buffer,
+                // so copying per chunk would drop the chunks computed before.
+                if (!range_check<Dims>::all_single_stride(r))
+                {
+                    gpu_buffer.acquire_wi();
+                    HETCOMPUTE_API_ASSERT(gpu_buffer.host_data() != nullptr, "gpu privatized buffer is not host accessible!");
+                    memcpy(gpu_buffer.host_data(), optr, bytes(first, r.end(0)));
+                    gpu_buffer.release();
+                }
+
+                scheduler.add_dispatcher(hetero::device_kind::gpu, [&](size_t begin, size_t end) {
+                    hetcompute::task_ptr<void(void)> gpu_task;
+                    execute_on_gpu<GKIdx, OutIdx, Dims, KernelTuple, ArgTuple, T, CalledWithPK>::kernel_launch(gpu_task,
+                                                                                                           create_gpu_range<Dims>::create(r,
+                                                                                                                                          begin,
+                                                                                                                                          end),
+                                                                                                           gpu_group,
+                                                                                                           klist,
+                                                                                                           arg_list,
+                                                                                                           gpu_buffer,
+                                                                                                           tuner);
+                    gpu_group->wait_for();
+                });
+            }
+#endif // defined(HETCOMPUTE_HAVE_OPENCL)
+
+#if defined(HETCOMPUTE_HAVE_QTI_DSP)
+            // Each dsp thread has its own dispatcher, local buffer and copy of the arguments
+            std::vector<hetcompute::buffer_ptr<T>> dsp_buffer_vec = std::get<std::tuple_size<Buf_Tuple>::value - 1>(buf_tup);
+            std::vector<ArgTuple>                  dsp_arg_lists(get_num_dsp_threads(), arg_list);
+            std::vector<hetcompute::group_ptr>     dsp_groups(get_num_dsp_threads());
+            size_t                                 dsp_dispatcher = scheduler.num_dispatchers();
+            if (use_dsp)
+            {
+                for (size_t i = 0; i < get_num_dsp_threads(); ++i)
+                {
+                    // Pass the elements skipped by the strides through, as for the gpu
+                    if (!range_check<Dims>::all_single_stride(r))
+                    {
+                        dsp_buffer_vec[i].acquire_wi();
+                        HETCOMPUTE_API_ASSERT(dsp_buffer_vec[i].host_data() != nullptr, "dsp privatized buffer is not host accessible!");
+                        memcpy(dsp_buffer_vec[i].host_data(), optr, bytes(first, r.end(0)));
+                        dsp_buffer_vec[i].release();
+                    }
+
+                    dsp_groups[i] = hetcompute::create_group();
+                    scheduler.add_dispatcher(hetero::device_kind::dsp, [&, i](size_t begin, size_t end) {
+                        hetcompute::task_ptr<void(void)> dsp_task;
+                        execute_on_dsp<HKIdx, OutIdx, Dims, KernelTuple, ArgTuple, T>::kernel_launch(dsp_task,
+                                                                                                   create_range<Dims>::create(r, begin, end),
+                                                                                                   dsp_groups[i],
+                                                                                                   klist,
+                                                                                                   dsp_arg_lists[i],
+                                                                                                   dsp_buffer_vec[i],
+                                                                                                   tuner);
+                        dsp_groups[i]->wait_for();
+                    });
+                }
+            }
+#endif // defined(HETCOMPUTE_HAVE_QTI_DSP)
+
+            scheduler.run();
+
+            // merge results back to host
+#if defined(HETCOMPUTE_HAVE_OPENCL)
+            if (use_gpu && !scheduler.get_chunks(gpu_dispatcher).empty())
+            {
+                gpu_buffer.acquire_ro();
+                HETCOMPUTE_API_ASSERT(gpu_buffer.host_data() != nullptr, "gpu privatized buffer is not host accessible!");
+                auto* gpu_buffer_ptr = static_cast<T*>(gpu_buffer.host_data());
+                for (auto const& chunk : scheduler.get_chunks(gpu_dispatcher))
+                {
+                    memcpy(optr + offset(chunk.first), gpu_buffer_ptr + offset(chunk.first), bytes(chunk.first, chunk.second));
+                }
+                gpu_buffer.release();
+            }
+#endif // defined(HETCOMPUTE_HAVE_OPENCL)
+
+#if defined(HETCOMPUTE_HAVE_QTI_DSP)
+            for (size_t i = 0; use_dsp && i < get_num_dsp_threads(); ++i)
+            {
+                auto const& chunks = scheduler.get_chunks(dsp_dispatcher + i);
+                if (chunks.empty())
+                {
+                    continue;
+                }
+
+                dsp_buffer_vec[i].acquire_ro();
+                HETCOMPUTE_API_ASSERT(dsp_buffer_vec[i].host_data() != nullptr, "dsp privatized buffer is not host accessible!");
+                auto* dsp_buffer_ptr = static_cast<T*>(dsp_buffer_vec[i].host_data());
+                for (auto const& chunk : chunks)
+                {
+                    memcpy(optr + offset(chunk.first), dsp_buffer_ptr + offset(chunk.first), bytes(chunk.first, chunk.second));
+                }
+                dsp_buffer_vec[i].release();
+            }
+#endif // defined(HETCOMPUTE_HAVE_QTI_DSP)
+        }
+
         /**
         /// Internal implementation of heterogeneous pfor_each
         /// Partition range based on hints of hetcompute::pattern::tuner and execute
@@ -297,13 +455,28 @@ namespace hetcompute
             HETCOMPUTE_CONSTEXPR_CONST size_t gk_idx = pattern::utility::gpu_kernel_pos<kernel_type>::pos;
             HETCOMPUTE_CONSTEXPR_CONST size_t hk_idx = pattern::utility::dsp_kernel_pos<kernel_type>::pos;
 
-            if (tuner.has_profile())
+            // With dynamic sharing, every device that has a kernel takes part and the loads are ignored
+            const bool dynamic = tuner.is_dynamic_hetero();
+
+            // Key of the kernels and range shape in the profile cache
+            hetero::profile_cache::key_type profile_key = 0;
+
+            if (tuner.has_profile() && !dynamic)
             {
                 HETCOMPUTE_API_ASSERT(ck_idx != invalid_pos, "Auto tuning requires a valid CPU kernel to be profiled as baseline.");
 
                 HETCOMPUTE_API_ASSERT(last - first >= 3, "Auto tuning is impossible due to insufficient number of iterations.");
 
-                if (ck_idx != invalid_pos && gk_idx != invalid_pos && hk_idx != invalid_pos)
+                profile_key = hetero::profile_cache::make_key<arg_type>(klist, r);
+                hetero::device_profile profile;
+                if (hetero::profile_cache::get().lookup(profile_key, profile))
+                {
+                    // Split by the throughputs measured in earlier calls, or in earlier runs
+                    idx_type cpu_share, gpu_share, dsp_share;
+                    profile.get_loads(gk_idx != invalid_pos && have_gpu, hk_idx != invalid_pos && have_dsp, cpu_share, gpu_share, dsp_share);
+                    tuner.set_cpu_load(cpu_share).set_gpu_load(gpu_share).set_dsp_load(dsp_share);
+                }
+                else if (ck_idx != invalid_pos && gk_idx != invalid_pos && hk_idx != invalid_pos)
                 {
                     tuner.set_cpu_load(33).set_gpu_load(33).set_dsp_load(34);
                 }
@@ -325,13 +498,16 @@ namespace hetcompute
             const idx_type gpu_load = tuner.get_gpu_load();
             const idx_type dsp_load = tuner.get_dsp_load();
 
-            HETCOMPUTE_API_ASSERT(cpu_load + gpu_load + dsp_load == 100, "Incorrect load setting across devices!");
+            HETCOMPUTE_API_ASSERT(dynamic || cpu_load + gpu_load + dsp_load == 100, "Incorrect load setting across devices!");
             HETCOMPUTE_API_ASSERT(!(cpu_load > 0 && ck_idx == invalid_pos), "CPU: kernel and tuner load mismatch!");
             HETCOMPUTE_API_ASSERT(!(gpu_load > 0 && gk_idx == invalid_pos), "GPU: kernel and tuner load mismatch!");
             HETCOMPUTE_API_ASSERT(!(dsp_load > 0 && hk_idx == invalid_pos), "Hexagon: Kernel and tuner load mismatch!");
             HETCOMPUTE_API_ASSERT(!(gpu_load > 0 && !have_gpu), "Must use HETCOMPUTE_HAVE_OPENCL to dispatch to GPU!");
             HETCOMPUTE_API_ASSERT(!(dsp_load > 0 && !have_dsp), "Must use HETCOMPUTE_HAVE_QTI_DSP to dispatch to DSP!");
 
+            const bool use_gpu = dynamic ? (gk_idx != invalid_pos && have_gpu) : gpu_load > 0;
+            const bool use_dsp = dynamic ? (hk_idx != invalid_pos && have_dsp) : dsp_load > 0;
+
             // enable device only when used
             hetcompute::internal::executor_device_bitset eds;
 
@@ -341,10 +517,10 @@ namespace hetcompute
             // In the future, we should make this conditional on cpu load by
             // removing the restriction of override_device_sets.
             eds.add(executor_device::cpu);
-            if (gpu_load > 0)
+            if (use_gpu)
                 // FIXME: use get_executor_device from gpu kernel (for gl).
                 eds.add(executor_device::gpucl);
-            if (dsp_load > 0)
+            if (use_dsp)
                 eds.add(executor_device::dsp);
 
                 // Acquire all buffer arguments to avoid potential race conditions
@@ -403,6 +579,30 @@ namespace hetcompute
             auto* optr = static_cast<buf_type*>(arena_storage_accessor::get_ptr(output_arena));
             HETCOMPUTE_INTERNAL_ASSERT(optr != nullptr, "Unexpected null storage in acquired arena!");
 
+            if (dynamic)
+            {
+                hetero::dynamic_scheduler scheduler(first, last, stride, tuner.is_chunk_set() ? tuner.get_chunk_size() : 1);
+                pfor_each_dynamic<ck_idx, gk_idx, hk_idx, out_idx, is_called_with_pointkernel>(scheduler,
+                                                                                                r,
+                                                                                                klist,
+                                                                                                arg_list,
+                                                                                                buf_tup,
+                                                                                                optr,
+                                                                                                tuner,
+                                                                                                use_gpu,
+                                                                                                use_dsp);
+                bas.release_buffers(&uid);
+
+                auto cpu_stats = scheduler.get_stats(hetero::device_kind::cpu);
+                auto gpu_stats = scheduler.get_stats(hetero::device_kind::gpu);
+                auto dsp_stats = scheduler.get_stats(hetero::device_kind::dsp);
+                p->set_chunk_stats(cpu_stats, gpu_stats, dsp_stats);
+                p->set_cpu_task_time(cpu_stats.busy_time);
+                p->set_gpu_task_time(gpu_stats.busy_time);
+                p->set_dsp_task_time(dsp_stats.busy_time);
+                return;
+            }
+
 #if defined(HETCOMPUTE_HAVE_OPENCL)
             bufptr_type gpu_buffer = std::get<0>(buf_tup);
             ;
@@ -568,38 +768,38 @@ namespace hetcompute
             }
 #endif // defined(HETCOMPUTE_HAVE_QTI_DSP)
 
-            // CPU exec time serves as the normalized profile for all devices (1.0)
+            // Execution times per iteration are blended into the profile cache,
+            // which sets the loads of later calls. A device whose time is too short
+            // to be meaningful is left out of this run's measurement.
+            // CPU exec time also serves as the normalized profile for all devices (1.0)
             // gpu and dsp profiles are saved as fractions of cpu execution time.
             if (tuner.has_profile())
             {
                 // turn all time measurements to microseconds
                 uint64_t tscale            = 1e3;
                 double   profile_threshold = 10.0;
-                double   epsilon           = 1e-3;
-                HETCOMPUTE_UNUSED(epsilon);
 
-                HETCOMPUTE_API_ASSERT(cpu_num_iters > 0, "Profile: Unexpected number of CPU iterations!");
-                double cput = static_cast<double>(cpu_exec_time / tscale);
-                if (cput < profile_threshold)
+                hetero::device_profile measured = { 0, 0, 0, 0 };
+                if (cpu_num_iters <= 0 || static_cast<double>(cpu_exec_time / tscale) < profile_threshold)
                 {
-                    HETCOMPUTE_ILOG("Warning: CPU profile in tiny granularity, abort profiling...");
-                    return;
+                    HETCOMPUTE_ILOG("Warning: CPU profile in tiny granularity, skip profiling...");
+                }
+                else
+                {
+                    measured.cpu = static_cast<double>(cpu_exec_time) / static_cast<double>(cpu_num_iters);
                 }
 
 #if defined(HETCOMPUTE_HAVE_OPENCL)
                 if (gpu_load > 0 && gk_idx != invalid_pos)
                 {
-                    double gpu_relative_time          = static_cast<double>(gpu_exec_time) / static_cast<double>(cpu_exec_time);
-                    double throughput_coefficient_gpu = 0;
                     HETCOMPUTE_API_ASSERT(gpu_num_iters > 0, "Profile: Unexpected number of GPU iterations!");
-                    throughput_coefficient_gpu = static_cast<double>(cpu_num_iters) / static_cast<double>(gpu_num_iters);
-                    if (gpu_relative_time < epsilon)
+                    if (static_cast<double>(gpu_exec_time / tscale) < profile_threshold)
                     {
-                        HETCOMPUTE_ILOG("Warning: GPU profile in tiny granularity, abort profiling...");
+                        HETCOMPUTE_ILOG("Warning: GPU profile in tiny granularity, skip profiling...");
                     }
                     else
                     {
-                        p->set_gpu_profile(gpu_relative_time * throughput_coefficient_gpu);
+                        measured.gpu = static_cast<double>(gpu_exec_time) / static_cast<double>(gpu_num_iters);
                     }
                 }
 #endif // defined(HETCOMPUTE_HAVE_OPENCL)
@@ -607,22 +807,35 @@ namespace hetcompute
 #if defined(HETCOMPUTE_HAVE_QTI_DSP)
                 if (dsp_load > 0 && hk_idx != invalid_pos)
                 {
-                    double dsp_relative_time          = static_cast<double>(dsp_exec_time) / static_cast<double>(cpu_exec_time);
-                    double throughput_coefficient_dsp = 0;
                     HETCOMPUTE_API_ASSERT(dsp_num_iters > 0, "Profile: Unexpected number of DSP iterations!");
-                    throughput_coefficient_dsp = static_cast<double>(cpu_num_iters) / static_cast<double>(dsp_num_iters);
-                    if (dsp_relative_time < epsilon)
+                    if (static_cast<double>(dsp_exec_time / tscale) < profile_threshold)
                     {
-                        HETCOMPUTE_ILOG("Warning: Hexagon profile in tiny granularity, abort profiling...");
+                        HETCOMPUTE_ILOG("Warning: Hexagon profile in tiny granularity, skip profiling...");
                     }
                     else
                     {
-                        p->set_dsp_profile(dsp_relative_time * throughput_coefficient_dsp);
+                        measured.dsp = static_cast<double>(dsp_exec_time) / static_cast<double>(dsp_num_iters);
                     }
                 }
 #endif // defined(HETCOMPUTE_HAVE_QTI_DSP)
 
-                p->add_run();
+                if (measured.cpu > 0 || measured.gpu > 0 || measured.dsp > 0)
+                {
+                    hetero::profile_cache::get().update(profile_key, measured);
+                }
+
+                if (measured.cpu > 0)
+                {
+                    if (measured.gpu > 0)
+                    {
+                        p->set_gpu_profile(measured.gpu / measured.cpu);
+                    }
+                    if (measured.dsp > 0)
+                    {
+                        p->set_dsp_profile(measured.dsp / measured.cpu);
+                    }
+                    p->add_run();
+                }
             }
             /// end of profiling section
         }
@@ -718,7 +931,7 @@ namespace hetcompute
             size_t buffer_size = r.linearized_distance();
             HETCOMPUTE_UNUSED(buffer_size);
 #ifdef HETCOMPUTE_HAVE_OPENCL
-            if (t.get_gpu_load() > 0)
+            if (t.get_gpu_load() > 0 || t.is_dynamic_hetero())
             {
                 auto gpu_buffer            = pk._gpu_local_buffer;
                 using gpu_buffer_base_type = typename hetcompute::internal::buffer::utility::buffertraits<decltype(gpu_buffer)>::element_type;
@@ -733,7 +946,7 @@ namespace hetcompute
             }
 #endif
 #ifdef HETCOMPUTE_HAVE_QTI_DSP
-            if (t.get_dsp_load() > 0)
+            if (t.get_dsp_load() > 0 || t.is_dynamic_hetero())
             {
                 auto dsp_buffer_vec        = pk._dsp_local_buffer_vec;
                 using dsp_buffer_base_type = typename hetcompute::internal::buffer::utility::buffertraits<
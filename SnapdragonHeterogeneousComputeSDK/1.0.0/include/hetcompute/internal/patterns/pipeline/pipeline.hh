@@ -2,10 +2,13 @@
 #pragma once
 
 // Include std headers
+#include <chrono>
+#include <memory>
 #include <vector>
 
 // Include internal headers
 #include <hetcompute/internal/util/macros.hh>
+#include <hetcompute/internal/patterns/pipeline/pipelineadaptive.hh>
 #include <hetcompute/internal/patterns/pipeline/pipelineskeleton.hh>
 
 namespace hetcompute
@@ -521,7 +524,10 @@ namespace hetcompute
              * @param mem_order
              */
             template <const std::memory_order mem_order>
-            void perform_gpu_stage(size_t stage_id, size_t iter_id, pipeline_launch_type launch_type)
+            void perform_gpu_stage(size_t                                               stage_id,
+                                   size_t                                               iter_id,
+                                   pipeline_launch_type                                 launch_type,
+                                   std::shared_ptr<pipeline_adaptive_controller> const& adaptive)
             {
                 auto tp = prepare_gpu_stage(stage_id, iter_id, launch_type, mem_order);
 
@@ -530,7 +536,7 @@ namespace hetcompute
 
                 _group->launch(gpu_tptr);
 
-                auto cpu_tptr = hetcompute::create_task([stage_id, iter_id, launch_type, after_body_tp_ptr, this] {
+                auto cpu_tptr = hetcompute::create_task([stage_id, iter_id, launch_type, after_body_tp_ptr, adaptive, this] {
                     postprocess_gpu_stage(stage_id, iter_id, launch_type, mem_order, after_body_tp_ptr);
                     if (get_load_on_current_thread() == 0)
                     {
@@ -540,7 +546,7 @@ namespace hetcompute
 #endif
 
                         size_t first_search_stage = stage_id == _num_stages - 1 ? _num_stages : stage_id + 2;
-                        pipeline_task_aggressive_fetch<mem_order>(first_search_stage, launch_type);
+                        pipeline_task_aggressive_fetch<mem_order>(first_search_stage, launch_type, adaptive);
                     }
                 });
 
@@ -714,7 +720,9 @@ namespace hetcompute
              *    hetcompute::mem_order_seq_cst for launch with on-the-fly stop
              */
             template <hetcompute::mem_order const mem_order>
-            void pipeline_task_aggressive_fetch(size_t init_stage, pipeline_launch_type launch_type)
+            void pipeline_task_aggressive_fetch(size_t                                               init_stage,
+                                                pipeline_launch_type                                 launch_type,
+                                                std::shared_ptr<pipeline_adaptive_controller> const& adaptive)
             {
                 size_t       count                             = 0;
                 size_t       first_search_stage                = init_stage;
@@ -755,7 +763,7 @@ namespace hetcompute
                             size_t total_iters = _stages[i - 1]->_total_iters.load(mem_order);
                             for (size_t y = first_iter; (total_iters == 0 || y <= total_iters) && y < last_iter; ++y)
                             {
-                                perform_gpu_stage<mem_order>(i - 1, y, launch_type);
+                                perform_gpu_stage<mem_order>(i - 1, y, launch_type, adaptive);
                                 total_iters = _stages[i - 1]->_total_iters.load(mem_order);
                             }
                             continue;
@@ -768,6 +776,12 @@ namespace hetcompute
                         size_t const last_iter = first_iter + fetch_work;
                         size_t       y_done    = first_iter;
 
+                        std::chrono::steady_clock::time_point start;
+                        if (adaptive != nullptr)
+                        {
+                            start = std::chrono::steady_clock::now();
+                        }
+
                         size_t total_iters = _stages[i - 1]->_total_iters.load(mem_order);
                         for (; (total_iters == 0 || y_done <= total_iters) && y_done < last_iter; ++y_done)
                         {
@@ -775,6 +789,12 @@ namespace hetcompute
                             total_iters = _stages[i - 1]->_total_iters.load(mem_order);
                         }
 
+                        uint64_t elapsed_ns = 0;
+                        if (adaptive != nullptr)
+                        {
+                            elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        }
+
                         // update the stage state again after the work is done
                         HETCOMPUTE_INTERNAL_ASSERT(!curr_stage->is_parallel() || fetch_work <= curr_stage->_doc, "fetch too much work.");
 
@@ -793,23 +813,37 @@ namespace hetcompute
                                 inc_iters_done++;
                             }
                             curr_stage->_iters_done = inc_iters_done - 1;
+
+                            if (adaptive != nullptr)
+                            {
+                                curr_stage->_chunk_size = adaptive->record(i - 1, y_done - first_iter, elapsed_ns);
+                            }
                         }
                         else
                         {
                             std::lock_guard<std::mutex> l(curr_stage->_mutex);
                             curr_stage->_iters_done += y_done - first_iter;
+
+                            if (adaptive != nullptr)
+                            {
+                                adaptive->record(i - 1, y_done - first_iter, elapsed_ns);
+                            }
                         }
 
                         // launch more tasks if needed
+                        // the next stage is searched first, so a stage fused with the
+                        // next one is continued by this task without launching another
                         first_search_stage = i == _num_stages ? _num_stages : i + 1;
 
-                        if (get_load_on_current_thread() == 0)
+                        bool fused = adaptive != nullptr && adaptive->is_fused_with_next(i - 1);
+
+                        if (!fused && get_load_on_current_thread() == 0)
                         {
                             _active_tasks++;
 #ifdef HETCOMPUTE_USE_PIPELINE_LOGGER
                             _num_tasks.fetch_add(1, hetcompute::mem_order_relaxed);
 #endif
-                            _group->launch([this, i, launch_type] { pipeline_task_aggressive_fetch<mem_order>(i, launch_type); });
+                            _group->launch([this, i, launch_type, adaptive] { pipeline_task_aggressive_fetch<mem_order>(i, launch_type, adaptive); });
                         }
                         break;
                     }
@@ -863,9 +897,13 @@ namespace hetcompute
              * @param t pattern tuner for the pipeline.
              *        Current tunable parameter for a pipeline is <code>doc</code>,
              *        i.e. the initial number of tasks can be launched for running a pipeline.
+             * @param record where the adaptive state of the run is kept, can be nullptr
              */
             template <hetcompute::mem_order const mem_order>
-            void launch_stb(size_t num_iterations, pipeline_launch_type launch_type, hetcompute::pattern::tuner const& t)
+            void launch_stb(size_t                                        num_iterations,
+                            pipeline_launch_type                          launch_type,
+                            hetcompute::pattern::tuner const&             t,
+                            std::shared_ptr<pipeline_stats_record> const& record)
             {
                 // check the stage io types
                 check_stage_io_type();
@@ -875,6 +913,13 @@ namespace hetcompute
 
                 initialize_stb(launch_type);
 
+                std::shared_ptr<pipeline_adaptive_controller> adaptive;
+                if (t.is_adaptive_pipeline() && record != nullptr)
+                {
+                    adaptive = record->start(_num_stages, t.get_adaptive_pipeline_target() * 1000);
+                    initialize_adaptive(*adaptive);
+                }
+
                 // launch when the total number of pipeline iteration is already known
                 if (mem_order == hetcompute::mem_order_relaxed)
                     setup_stage_total_iterations(num_iterations);
@@ -897,7 +942,7 @@ namespace hetcompute
                 size_t num_init_tasks = is_first_stage_serial() ? 1 : t.get_doc();
 
                 for (size_t i = 0; i < num_init_tasks; i++)
-                    _group->launch([this, launch_type] { pipeline_task_aggressive_fetch<mem_order>(1, launch_type); });
+                    _group->launch([this, launch_type, adaptive] { pipeline_task_aggressive_fetch<mem_order>(1, launch_type, adaptive); });
 
 #ifdef HETCOMPUTE_USE_PIPELINE_LOGGER
                 HETCOMPUTE_ILOG("\033[31m *** creating %zu task, max %zu at one time *** \033[0m\n", _num_tasks.load(), _max_tasks.load());
@@ -910,6 +955,27 @@ namespace hetcompute
              */
             void setup_stage_total_iterations(size_t num_iterations);
 
+            /**
+             * Adapt the stages to the cost of their iterations
+             * Parallel cpu stages get their chunk sizes adapted, starting from 1,
+             * and serial cpu stages may be fused with each other. Gpu stages are
+             * left alone.
+             * @param adaptive controller of the run
+             */
+            void initialize_adaptive(pipeline_adaptive_controller& adaptive)
+            {
+                for (auto stage : _stages)
+                {
+                    if (stage->_stage_skeleton_ptr->_hetero_type == pipeline_stage_hetero_type::gpu)
+                        continue;
+
+                    if (stage->is_parallel())
+                        stage->_chunk_size = adaptive.set_chunked(stage->_id, stage->_doc);
+                    else
+                        adaptive.set_fusable(stage->_id);
+                }
+            }
+
             /**
              * Set whether to split the serial stage work or not
              */
@@ -961,8 +1027,12 @@ namespace hetcompute
              * @param t pattern tuner for the pipeline.
              *        Current tunable parameter for a pipeline is <code>doc</code>,
              *        i.e. the initial number of tasks can be launched for running a pipeline.
+             * @param record where the adaptive state of the run is kept, can be nullptr
              */
-            void launch(size_t num_iterations, pipeline_launch_type launch_type, const hetcompute::pattern::tuner& t)
+            void launch(size_t                                        num_iterations,
+                        pipeline_launch_type                          launch_type,
+                        const hetcompute::pattern::tuner&             t,
+                        std::shared_ptr<pipeline_stats_record> const& record = nullptr)
             {
                 if (launch_type == without_sliding_window)
                 {
@@ -973,12 +1043,12 @@ namespace hetcompute
                 if (num_iterations == 0)
                 {
                     _launch_with_iterations = false;
-                    launch_stb<hetcompute::mem_order_seq_cst>(0, launch_type, t);
+                    launch_stb<hetcompute::mem_order_seq_cst>(0, launch_type, t, record);
                 }
                 else
                 {
                     _launch_with_iterations = true;
-                    launch_stb<hetcompute::mem_order_relaxed>(num_iterations, launch_type, t);
+                    launch_stb<hetcompute::mem_order_relaxed>(num_iterations, launch_type, t, record);
                 }
             }
 
@@ -1036,8 +1106,13 @@ namespace hetcompute
              * @param t pattern tuner for the pipeline.
              *        Current tunable parameter for a pipeline is <code>doc</code>,
              *        i.e. the initial number of tasks can be launched for running a pipeline.
+             * @param record where the adaptive state of the run is kept, can be nullptr
              */
-            void launch(UserData* context_data, size_t num_iterations, pipeline_launch_type launch_type, const hetcompute::pattern::tuner& t)
+            void launch(UserData*                                     context_data,
+                        size_t                                        num_iterations,
+                        pipeline_launch_type                          launch_type,
+                        const hetcompute::pattern::tuner&             t,
+                        std::shared_ptr<pipeline_stats_record> const& record = nullptr)
             {
                 if (launch_type == without_sliding_window)
                 {
@@ -1050,12 +1125,12 @@ namespace hetcompute
                 if (num_iterations == 0)
                 {
                     _launch_with_iterations = false;
-                    launch_stb<hetcompute::mem_order_seq_cst>(0, launch_type, t);
+                    launch_stb<hetcompute::mem_order_seq_cst>(0, launch_type, t, record);
                 }
                 else
                 {
                     _launch_with_iterations = true;
-                    launch_stb<hetcompute::mem_order_relaxed>(num_iterations, launch_type, t);
+                    launch_stb<hetcompute::mem_order_relaxed>(num_iterations, launch_type, t, record);
                 }
             }
 
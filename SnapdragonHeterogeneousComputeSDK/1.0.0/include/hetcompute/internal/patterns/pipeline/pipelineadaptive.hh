@@ -0,0 +1,351 @@
+/** @file pipelineadaptive.hh */
+#pragma once
+
+// Include std headers
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Include internal headers
+#include <hetcompute/internal/util/debug.hh>
+#include <hetcompute/internal/util/macros.hh>
+#include <hetcompute/internal/util/memorder.hh>
+
+namespace hetcompute
+{
+    namespace pattern
+    {
+        /** @addtogroup pipeline_doc
+            @{ */
+
+        /**
+         * @brief Statistics of a pipeline stage.
+         *
+         * Statistics of a pipeline stage in a run with
+         * <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>,
+         * and the decisions taken for it.
+         */
+        struct pipeline_stage_stats
+        {
+            /** Number of iterations the stage executed. */
+            size_t iterations;
+            /** Number of chunks of iterations the stage executed, i.e. the number
+                of times a task fetched work from it. */
+            size_t chunks;
+            /** Time spent executing the iterations, in microseconds. */
+            uint64_t busy_time;
+            /** Smoothed execution time of one iteration, in nanoseconds. */
+            uint64_t iteration_time;
+            /** Chunk size chosen last for a parallel stage, 0 for other stages. */
+            size_t chunk_size;
+            /** Whether the stage was last fused with the next one, i.e. the task
+                that executed an iteration of the stage went on with the next
+                stage instead of launching another task for it. */
+            bool fused_with_next;
+        };
+
+        /** @} */ /* end_addtogroup pipeline_doc */
+    }; // namespace pattern
+
+    namespace internal
+    {
+        /**
+         * Adapts the stages of a pipeline instance to the measured cost of their
+         * iterations, so that each task runs for about a target duration.
+         *
+         * The chunk size of a parallel stage, i.e. the number of consecutive
+         * iterations a task fetches at once, is the number of iterations that
+         * fit in the target duration, between 1 and the degree of concurrency
+         * of the stage.
+         *
+         * Two adjacent serial stages are fused when an iteration of both fits in
+         * the target duration: the task that executes the first one goes on with
+         * the second one, instead of launching another task that would do it.
+         *
+         * Each stage is recorded with its lock held. The costs and the fusion
+         * decisions are atomic, as they are read for neighbouring stages.
+         */
+        class pipeline_adaptive_controller
+        {
+            struct stage_state
+            {
+                // set before the launch
+                size_t max_chunk;
+                bool   fusable;
+
+                // guarded by the stage lock
+                size_t   iterations;
+                size_t   chunks;
+                uint64_t busy_ns;
+                size_t   chunk;
+
+                std::atomic<uint64_t> iteration_ns;
+                std::atomic<bool>     fused_with_next;
+
+                stage_state()
+                    : max_chunk(0),
+                      fusable(false),
+                      iterations(0),
+                      chunks(0),
+                      busy_ns(0),
+                      chunk(0),
+                      iteration_ns(0),
+                      fused_with_next(false)
+                {
+                }
+            };
+
+            uint64_t const           _target_ns;
+            std::vector<stage_state> _stages;
+
+            // Weight of a new measurement in the moving average of the iteration cost
+            static HETCOMPUTE_CONSTEXPR_CONST uint64_t s_weight_inverse = 4;
+
+        public:
+            /**
+             * constructor
+             * @param num_stages number of stages of the pipeline
+             * @param target_ns  target duration of the work of a task on a stage
+             */
+            pipeline_adaptive_controller(size_t num_stages, uint64_t target_ns) : _target_ns(target_ns), _stages(num_stages)
+            {
+                HETCOMPUTE_INTERNAL_ASSERT(_target_ns > 0, "Target task duration must be > 0.");
+            }
+
+            /**
+             * Statistics of the stages, once the tasks of the run are done
+             * @return std::vector<pipeline_stage_stats> the statistics of each stage
+             */
+            std::vector<hetcompute::pattern::pipeline_stage_stats> get_stats() const
+            {
+                std::vector<hetcompute::pattern::pipeline_stage_stats> stats(_stages.size());
+                for (size_t i = 0; i < _stages.size(); i++)
+                {
+                    auto& s                  = _stages[i];
+                    stats[i].iterations      = s.iterations;
+                    stats[i].chunks          = s.chunks;
+                    stats[i].busy_time       = s.busy_ns / 1000;
+                    stats[i].iteration_time  = s.iteration_ns.load(hetcompute::mem_order_relaxed);
+                    stats[i].chunk_size      = s.chunk;
+                    stats[i].fused_with_next = s.fused_with_next.load(hetcompute::mem_order_relaxed);
+                }
+                return stats;
+            }
+
+            /**
+             * Adapt the chunk size of a parallel stage
+             * @param id        stage id
+             * @param max_chunk maximum chunk size, i.e. the degree of concurrency of the stage
+             * @return size_t the initial chunk size
+             */
+            size_t set_chunked(size_t id, size_t max_chunk)
+            {
+                HETCOMPUTE_INTERNAL_ASSERT(max_chunk > 0, "Maximum chunk size must be > 0.");
+                _stages[id].max_chunk = max_chunk;
+                _stages[id].chunk     = 1;
+                return 1;
+            }
+
+            /**
+             * Allow a serial stage to be fused with adjacent serial stages
+             * @param id stage id
+             */
+            void set_fusable(size_t id) { _stages[id].fusable = true; }
+
+            /**
+             * Record a chunk of iterations of a stage, with the stage lock held
+             * @param id    stage id
+             * @param iters number of iterations executed
+             * @param ns    time spent executing them
+             * @return size_t the chunk size for the next fetches of the stage,
+             *         0 if the stage is not chunked
+             */
+            size_t record(size_t id, size_t iters, uint64_t ns)
+            {
+                if (iters == 0)
+                {
+                    return _stages[id].chunk;
+                }
+
+                auto& s = _stages[id];
+                s.iterations += iters;
+                s.chunks++;
+                s.busy_ns += ns;
+
+                uint64_t sample  = std::max<uint64_t>(ns / iters, 1);
+                uint64_t average = s.iteration_ns.load(hetcompute::mem_order_relaxed);
+                average = average == 0 ? sample : (average * (s_weight_inverse - 1) + sample) / s_weight_inverse;
+                s.iteration_ns.store(average, hetcompute::mem_order_relaxed);
+
+                if (s.max_chunk > 0)
+                {
+                    s.chunk = static_cast<size_t>(std::min<uint64_t>(std::max<uint64_t>(_target_ns / average, 1), s.max_chunk));
+                }
+
+                if (id > 0)
+                {
+                    update_fusion(id - 1);
+                }
+                update_fusion(id);
+                return s.chunk;
+            }
+
+            /**
+             * Check whether the task that executed stage id should go on with the next stage
+             * @param id stage id
+             */
+            bool is_fused_with_next(size_t id) const { return _stages[id].fused_with_next.load(hetcompute::mem_order_relaxed); }
+
+            // Forbid copying and assignment
+            HETCOMPUTE_DELETE_METHOD(pipeline_adaptive_controller(pipeline_adaptive_controller const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_adaptive_controller(pipeline_adaptive_controller&& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_adaptive_controller& operator=(pipeline_adaptive_controller const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_adaptive_controller& operator=(pipeline_adaptive_controller&& other));
+
+        private:
+            // Fuses stage id with the next one while an iteration of both,
+            // measured, fits in the target duration
+            void update_fusion(size_t id)
+            {
+                if (id + 1 >= _stages.size() || !_stages[id].fusable || !_stages[id + 1].fusable)
+                {
+                    return;
+                }
+
+                uint64_t first  = _stages[id].iteration_ns.load(hetcompute::mem_order_relaxed);
+                uint64_t second = _stages[id + 1].iteration_ns.load(hetcompute::mem_order_relaxed);
+                bool     fused  = first > 0 && second > 0 && first + second <= _target_ns;
+                _stages[id].fused_with_next.store(fused, hetcompute::mem_order_relaxed);
+            }
+        };
+        // end of class pipeline_adaptive_controller
+
+        /**
+         * Adaptive state of the last run of a pipeline, held in the
+         * pipeline_stats_table rather than by the pipeline or its instances,
+         * so that their layout stays as the runtime library expects. Each adaptive launch
+         * creates a controller, which the tasks of the run share with the
+         * record until the next adaptive launch.
+         */
+        class pipeline_stats_record
+        {
+            std::mutex                                    _mutex;
+            std::shared_ptr<pipeline_adaptive_controller> _last;
+
+        public:
+            pipeline_stats_record() : _mutex(), _last(nullptr) {}
+
+            /**
+             * Start an adaptive run
+             * @param num_stages number of stages of the pipeline
+             * @param target_ns  target duration of the work of a task on a stage
+             * @return std::shared_ptr<pipeline_adaptive_controller> the controller of the run
+             */
+            std::shared_ptr<pipeline_adaptive_controller> start(size_t num_stages, uint64_t target_ns)
+            {
+                auto adaptive = std::make_shared<pipeline_adaptive_controller>(num_stages, target_ns);
+
+                std::lock_guard<std::mutex> l(_mutex);
+                _last = adaptive;
+                return adaptive;
+            }
+
+            std::vector<hetcompute::pattern::pipeline_stage_stats> get()
+            {
+                std::shared_ptr<pipeline_adaptive_controller> last;
+                {
+                    std::lock_guard<std::mutex> l(_mutex);
+                    last = _last;
+                }
+                return last == nullptr ? std::vector<hetcompute::pattern::pipeline_stage_stats>() : last->get_stats();
+            }
+
+            // Forbid copying and assignment
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_record(pipeline_stats_record const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_record(pipeline_stats_record&& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_record& operator=(pipeline_stats_record const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_record& operator=(pipeline_stats_record&& other));
+        };
+        // end of class pipeline_stats_record
+
+        /**
+         * Stats records of the pipelines that ran adaptively, keyed by the
+         * skeleton of the pipeline. The pipeline erases its entry when its
+         * skeleton is released.
+         */
+        class pipeline_stats_table
+        {
+            using record_ptr = std::shared_ptr<pipeline_stats_record>;
+
+            std::mutex                                 _mutex;
+            std::unordered_map<void const*, record_ptr> _records;
+
+            pipeline_stats_table() : _mutex(), _records() {}
+
+            // Never destroyed, as pipelines may be destroyed during static destruction
+            static pipeline_stats_table& instance()
+            {
+                static pipeline_stats_table* table = new pipeline_stats_table();
+                return *table;
+            }
+
+        public:
+            /**
+             * Get the record of a pipeline, creating it if needed
+             * @param key skeleton of the pipeline
+             * @return record_ptr the record of the pipeline
+             */
+            static record_ptr get(void const* key)
+            {
+                auto&                       table = instance();
+                std::lock_guard<std::mutex> l(table._mutex);
+                auto&                       record = table._records[key];
+                if (record == nullptr)
+                {
+                    record = std::make_shared<pipeline_stats_record>();
+                }
+                return record;
+            }
+
+            /**
+             * Find the record of a pipeline
+             * @param key skeleton of the pipeline
+             * @return record_ptr the record of the pipeline, nullptr if it never ran adaptively
+             */
+            static record_ptr find(void const* key)
+            {
+                auto&                       table = instance();
+                std::lock_guard<std::mutex> l(table._mutex);
+                auto                        it = table._records.find(key);
+                return it == table._records.end() ? nullptr : it->second;
+            }
+
+            /**
+             * Erase the record of a pipeline; tasks of a run in flight keep its controller
+             * @param key skeleton of the pipeline
+             */
+            static void erase(void const* key)
+            {
+                if (key == nullptr)
+                {
+                    return;
+                }
+                auto&                       table = instance();
+                std::lock_guard<std::mutex> l(table._mutex);
+                table._records.erase(key);
+            }
+
+            // Forbid copying and assignment
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_table(pipeline_stats_table const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_table(pipeline_stats_table&& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_table& operator=(pipeline_stats_table const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_stats_table& operator=(pipeline_stats_table&& other));
+        };
+        // end of class pipeline_stats_table
+
+    }; // namespace internal
+};     // namespace hetcompute
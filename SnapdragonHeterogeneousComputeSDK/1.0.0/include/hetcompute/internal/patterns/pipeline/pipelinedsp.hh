@@ -0,0 +1,308 @@
+/** @file pipelinedsp.hh */
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+
+#include <hetcompute/dspkernel.hh>
+#include <hetcompute/exceptions.hh>
+#include <hetcompute/range.hh>
+#include <hetcompute/taskfactory.hh>
+#include <hetcompute/internal/buffer/arenaaccess.hh>
+#include <hetcompute/internal/buffer/bufferpolicy.hh>
+#include <hetcompute/internal/util/templatemagic.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        // dsp stage functions
+
+        /**
+         * Index arguments of a dsp kernel for a range, i.e. the first and
+         * the last index of each dimension
+         */
+        template <typename Range>
+        struct dsp_stage_range_args;
+
+        template <>
+        struct dsp_stage_range_args<hetcompute::range<1>>
+        {
+            static std::tuple<size_t, size_t> get(hetcompute::range<1> const& r) { return std::make_tuple(r.begin(0), r.end(0)); }
+        };
+
+        template <>
+        struct dsp_stage_range_args<hetcompute::range<2>>
+        {
+            static std::tuple<size_t, size_t, size_t, size_t> get(hetcompute::range<2> const& r)
+            {
+                return std::make_tuple(r.begin(0), r.end(0), r.begin(1), r.end(1));
+            }
+        };
+
+        template <>
+        struct dsp_stage_range_args<hetcompute::range<3>>
+        {
+            static std::tuple<size_t, size_t, size_t, size_t, size_t, size_t> get(hetcompute::range<3> const& r)
+            {
+                return std::make_tuple(r.begin(0), r.end(0), r.begin(1), r.end(1), r.begin(2), r.end(2));
+            }
+        };
+
+        /**
+         * Arguments of the dsp kernel of a stage, made of the tuple returned
+         * by the before lambda: the indices of its range, followed by the
+         * other elements of the tuple
+         */
+        template <typename BeforeTuple>
+        struct dsp_stage_kernel_args
+        {
+            using range_type = typename std::decay<typename std::tuple_element<0, BeforeTuple>::type>::type;
+
+            template <size_t... Indices>
+            static auto make(BeforeTuple& bt, integer_list_gen<Indices...>)
+                -> decltype(std::tuple_cat(dsp_stage_range_args<range_type>::get(std::get<0>(bt)), std::forward_as_tuple(std::get<Indices>(bt)...)))
+            {
+                return std::tuple_cat(dsp_stage_range_args<range_type>::get(std::get<0>(bt)), std::forward_as_tuple(std::get<Indices>(bt)...));
+            }
+
+            static auto make(BeforeTuple& bt)
+                -> decltype(make(bt, typename integer_list<std::tuple_size<BeforeTuple>::value - 1>::type()))
+            {
+                return make(bt, typename integer_list<std::tuple_size<BeforeTuple>::value - 1>::type());
+            }
+        };
+
+        /**
+         * One argument of a dsp stage, passed to the kernel parameter Param.
+         * Arguments other than buffers are passed as they are.
+         */
+        template <typename Arg, typename Param, bool = is_api20_buffer_ptr<Arg>::value>
+        struct dsp_stage_arg
+        {
+            using host_tuple = std::tuple<Arg&>;
+
+            template <typename BAS>
+            static void add(BAS&, Arg&)
+            {
+            }
+
+            template <typename BAS>
+            static host_tuple get_host(BAS&, Arg& arg)
+            {
+                return host_tuple(arg);
+            }
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+            template <typename BAS>
+            static void preacquire(BAS&, Arg&, task*)
+            {
+            }
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+        };
+
+        /**
+         * A buffer argument is passed to the kernel as a pointer to its data,
+         * followed by the number of elements. The IDL makes the pointer const
+         * if the kernel only reads the buffer.
+         */
+        template <typename T, typename Param>
+        struct dsp_stage_arg<hetcompute::buffer_ptr<T>, Param, true>
+        {
+            using host_tuple = std::tuple<T*, size_t>;
+
+            static HETCOMPUTE_CONSTEXPR_CONST bool read_only = std::is_const<typename std::remove_pointer<Param>::type>::value;
+
+            template <typename BAS>
+            static void add(BAS& bas, hetcompute::buffer_ptr<T>& b)
+            {
+                bas.add(b, read_only ? bufferpolicy::acquire_r : bufferpolicy::acquire_rw);
+            }
+
+            template <typename BAS>
+            static host_tuple get_host(BAS& bas, hetcompute::buffer_ptr<T>& b)
+            {
+                auto acquired_arena = bas.find_acquired_arena(b, executor_device::cpu);
+                HETCOMPUTE_INTERNAL_ASSERT(acquired_arena != nullptr, "Invalid arena pointer!");
+                return host_tuple(static_cast<T*>(arena_storage_accessor::get_ptr(acquired_arena)), b.size());
+            }
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+            // Hands the ion arena acquired by the stage to the dsp task, which
+            // then uses it without acquiring the buffer again.
+            template <typename BAS>
+            static void preacquire(BAS& bas, hetcompute::buffer_ptr<T>& b, task* dsp_task)
+            {
+                auto ion_arena = bas.find_acquired_arena(b, executor_device::dsp);
+                HETCOMPUTE_INTERNAL_ASSERT(ion_arena != nullptr, "Unexpected nullptr for ion arena!");
+                arena_storage_accessor::access_ion_arena_for_dsptask(ion_arena);
+
+                auto bufstate = c_ptr(buffer_accessor::get_bufstate(reinterpret_cast<buffer_ptr_base&>(b)));
+                dsp_task->unsafe_register_preacquired_arena(bufstate, ion_arena);
+            }
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+        };
+
+        /**
+         * Walks the arguments of a dsp stage and the parameters of its kernel
+         * side by side. A buffer argument takes up two parameters.
+         */
+        template <typename Params, size_t param_index, typename Args, size_t arg_index, bool = arg_index == std::tuple_size<Args>::value>
+        struct dsp_stage_args
+        {
+            static_assert(param_index < std::tuple_size<Params>::value, "Too many arguments for the dsp kernel of the stage.");
+
+            using arg_type   = typename std::decay<typename std::tuple_element<arg_index, Args>::type>::type;
+            using param_type = typename std::tuple_element<param_index, Params>::type;
+            using current    = dsp_stage_arg<arg_type, param_type>;
+            using next = dsp_stage_args<Params, param_index + (is_api20_buffer_ptr<arg_type>::value ? 2 : 1), Args, arg_index + 1>;
+
+            using host_tuple =
+                decltype(std::tuple_cat(std::declval<typename current::host_tuple>(), std::declval<typename next::host_tuple>()));
+
+            template <typename BAS>
+            static void add_buffers(BAS& bas, Args& args)
+            {
+                current::add(bas, std::get<arg_index>(args));
+                next::add_buffers(bas, args);
+            }
+
+            template <typename BAS>
+            static host_tuple get_host_args(BAS& bas, Args& args)
+            {
+                return std::tuple_cat(current::get_host(bas, std::get<arg_index>(args)), next::get_host_args(bas, args));
+            }
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+            template <typename BAS>
+            static void preacquire_arenas(BAS& bas, Args& args, task* dsp_task)
+            {
+                current::preacquire(bas, std::get<arg_index>(args), dsp_task);
+                next::preacquire_arenas(bas, args, dsp_task);
+            }
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+        };
+
+        template <typename Params, size_t param_index, typename Args, size_t arg_index>
+        struct dsp_stage_args<Params, param_index, Args, arg_index, true>
+        {
+            static_assert(param_index == std::tuple_size<Params>::value, "Too few arguments for the dsp kernel of the stage.");
+
+            using host_tuple = std::tuple<>;
+
+            template <typename BAS>
+            static void add_buffers(BAS&, Args&)
+            {
+            }
+
+            template <typename BAS>
+            static host_tuple get_host_args(BAS&, Args&)
+            {
+                return host_tuple();
+            }
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+            template <typename BAS>
+            static void preacquire_arenas(BAS&, Args&, task*)
+            {
+            }
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+        };
+
+        /**
+         * Executes the dsp kernel of a stage iteration, on the range and the
+         * arguments returned by the before lambda, and waits for it.
+         */
+        template <typename Kernel>
+        struct dsp_stage_executor;
+
+        /**
+         * A host stand-in is called on the CPU, with the buffers acquired for
+         * the CPU for the duration of the call
+         */
+        template <typename... Params>
+        struct dsp_stage_executor<hetcompute::dsp_stand_in<int (*)(Params...)>>
+        {
+            template <typename BeforeTuple>
+            static void execute(hetcompute::dsp_stand_in<int (*)(Params...)>& kernel, BeforeTuple& bt)
+            {
+                auto args      = dsp_stage_kernel_args<BeforeTuple>::make(bt);
+                using args_type = decltype(args);
+                using walker    = dsp_stage_args<std::tuple<Params...>, 0, args_type, 0>;
+
+                buffer_acquire_set<num_buffer_ptrs_in_tuple<args_type>::value> bas;
+                walker::add_buffers(bas, args);
+
+                int  dummy_requestor = 0;
+                auto requestor       = static_cast<void*>(&dummy_requestor);
+                bas.blocking_acquire_buffers(requestor, { executor_device::cpu });
+
+                auto host_args = walker::get_host_args(bas, args);
+                int  status    = call(kernel.get_fn(), host_args, typename integer_list<std::tuple_size<decltype(host_args)>::value>::type());
+
+                bas.release_buffers(requestor);
+                HETCOMPUTE_API_THROW(status == 0, "The dsp kernel stand-in of a pipeline stage returned %d.", status);
+            }
+
+        private:
+            template <typename HostArgs, size_t... Indices>
+            static int call(int (*fn)(Params...), HostArgs& host_args, integer_list_gen<Indices...>)
+            {
+                return fn(std::get<Indices - 1>(host_args)...);
+            }
+        };
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+        /**
+         * The buffers of a dsp kernel are acquired for the dsp by the stage
+         * iteration and handed to the dsp task as preacquired arenas, so the
+         * task neither locks nor maps them again. The ion arenas stay with the
+         * buffers after they are released, so later iterations that pass the
+         * same buffers do not map them again either.
+         */
+        template <typename... Params>
+        struct dsp_stage_executor<hetcompute::dsp_kernel<int (*)(Params...)>>
+        {
+            template <typename BeforeTuple>
+            static void execute(hetcompute::dsp_kernel<int (*)(Params...)>& kernel, BeforeTuple& bt)
+            {
+                auto args      = dsp_stage_kernel_args<BeforeTuple>::make(bt);
+                using args_type = decltype(args);
+                using walker    = dsp_stage_args<std::tuple<Params...>, 0, args_type, 0>;
+
+                buffer_acquire_set<num_buffer_ptrs_in_tuple<args_type>::value> bas;
+                walker::add_buffers(bas, args);
+
+                int  dummy_requestor = 0;
+                auto requestor       = static_cast<void*>(&dummy_requestor);
+                bas.blocking_acquire_buffers(requestor, { executor_device::dsp });
+
+                try
+                {
+                    auto dsp_task = create(kernel, args, typename integer_list<std::tuple_size<args_type>::value>::type());
+                    walker::preacquire_arenas(bas, args, c_ptr(dsp_task));
+                    c_ptr(dsp_task)->unsafe_enable_non_locking_buffer_acquire();
+
+                    dsp_task->launch();
+                    dsp_task->wait_for();
+                }
+                catch (...)
+                {
+                    bas.release_buffers(requestor);
+                    throw;
+                }
+                bas.release_buffers(requestor);
+            }
+
+        private:
+            template <typename Args, size_t... Indices>
+            static auto create(hetcompute::dsp_kernel<int (*)(Params...)>& kernel, Args& args, integer_list_gen<Indices...>)
+                -> decltype(hetcompute::create_task(kernel, std::get<Indices - 1>(args)...))
+            {
+                return hetcompute::create_task(kernel, std::get<Indices - 1>(args)...);
+            }
+        };
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+
+    }; // namespace internal
+};     // namespace hetcompute
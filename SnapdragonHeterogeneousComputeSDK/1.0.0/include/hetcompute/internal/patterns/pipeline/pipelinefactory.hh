@@ -392,9 +392,7 @@ namespace hetcompute
         };
         // end of class cpu_stage_function
 
-#ifdef HETCOMPUTE_HAVE_GPU
-
-        // gpu stage functions
+        // gpu stage functions, also used for the before and after lambdas of dsp stages
         /**
          * Dispatches to the correct implementation
          * of the stage function for a given arity
@@ -695,7 +693,6 @@ namespace hetcompute
             HETCOMPUTE_DELETE_METHOD(gpu_stage_sync_function<void>& operator=(gpu_stage_sync_function<void*>&& other));
         };
 // end of class gpu_stage_function
-#endif // HETCOMPUTE_HAVE_GPU
 
     }; // namespace internal
 };     // namespace hetcompute
@@ -9,6 +9,7 @@
 // Include internal headers
 #include <hetcompute/internal/util/macros.hh>
 #include <hetcompute/internal/patterns/pipeline/pipelinebuffers.hh>
+#include <hetcompute/internal/patterns/pipeline/pipelinedsp.hh>
 #include <hetcompute/internal/patterns/pipeline/pipelinefactory.hh>
 #include <hetcompute/internal/patterns/pipeline/pipelineutility.hh>
 
@@ -940,6 +941,254 @@ namespace hetcompute
 // end of class pipeline_gpu_stage_skeleton<BeforeBody, GK, AfterBody, UserData...>: public pipeline_stage_skeleton_base
 #endif // HETCOMPUTE_HAVE_GPU
 
+        /**
+         * Pipeline dsp stage skeleton
+         *
+         * The scheduler runs a dsp stage like a cpu stage. Each stage iteration
+         * performs the before lambda, executes the dsp kernel on the range and
+         * the arguments returned by it and waits for the kernel, then performs
+         * the after lambda.
+         */
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UserData>
+        class pipeline_dsp_stage_skeleton : public pipeline_stage_skeleton_base
+        {
+        private:
+            using dsp_kernel_type = typename std::decay<DK>::type;
+
+            gpu_stage_sync_function<BeforeBody> _before_fct; // before sync function for the stage
+            gpu_stage_sync_function<AfterBody>  _after_fct;  // after sync function for the stage
+            dsp_kernel_type                     _dsp_kernel; // dsp kernel for the stage
+
+        public:
+            // typdefs
+            typedef typename gpu_stage_sync_function<AfterBody>::return_type   return_type;
+            typedef typename gpu_stage_sync_function<BeforeBody>::return_type  before_return_type;
+            typedef typename gpu_stage_sync_function<BeforeBody>::context_type context_type;
+            typedef typename gpu_stage_sync_function<BeforeBody>::context_type before_context_type;
+            typedef typename gpu_stage_sync_function<AfterBody>::context_type  after_context_type;
+
+            static_assert(!std::is_same<before_context_type, void>::value && (std::is_same<after_context_type, void>::value ||
+                                                                              std::is_same<before_context_type, after_context_type>::value),
+                          "the context types of the before and after dsp sync functions should match.");
+
+            typedef
+                typename pipeline_utility::strip_stage_input_type<typename gpu_stage_sync_function<BeforeBody>::arg1_type>::type input_type;
+
+            typedef typename pipeline_utility::type_helper<BeforeBody>::org_type before_body_org_type;
+            typedef typename pipeline_utility::type_helper<AfterBody>::org_type  after_body_org_type;
+
+            /**
+             * constructor
+             */
+            template <typename StageType>
+            pipeline_dsp_stage_skeleton(BeforeBody&&                      before_fct,
+                                        DK&&                              dsp_kernel,
+                                        AfterBody&&                       after_fct,
+                                        bool                              has_lag,
+                                        const size_t                      id,
+                                        iteration_lag const&              lag,
+                                        iteration_rate const&             rate,
+                                        sliding_window_size const&        sw,
+                                        StageType const&                  ss,
+                                        hetcompute::pattern::tuner const& t)
+                : pipeline_stage_skeleton_base(has_lag,
+                                               pipeline_stage_hetero_type::cpu,
+                                               id,
+                                               lag._iter_lag,
+                                               rate._iter_rate_pred,
+                                               rate._iter_rate_curr,
+                                               sw._size,
+                                               ss,
+                                               t),
+                  _before_fct(std::forward<before_body_org_type>(before_fct)),
+                  _after_fct(std::forward<after_body_org_type>(after_fct)),
+                  _dsp_kernel(std::forward<DK>(dsp_kernel))
+            {
+            }
+
+            /**
+             * copy constructor
+             */
+            pipeline_dsp_stage_skeleton(pipeline_dsp_stage_skeleton const& other)
+                : pipeline_stage_skeleton_base(other),
+                  _before_fct(other._before_fct),
+                  _after_fct(other._after_fct),
+                  _dsp_kernel(other._dsp_kernel)
+            {
+            }
+
+            /**
+             * destructor
+             */
+            virtual ~pipeline_dsp_stage_skeleton() {}
+
+            /**
+             * Allocate buffers between stages
+             *
+             * @param buf reference to the pointer of the buffer to allocate
+             * @param size size of the buffer to allocate
+             * @param pipeline_launch_type
+             */
+            virtual void alloc_stage_buf(stagebuffer*& buf, size_t size, pipeline_launch_type launch_type)
+            {
+                allocate_stage_buffer<return_type>(buf, size, launch_type);
+            }
+
+            /**
+             * Perform the before lambda, the dsp kernel and the after lambda on the token
+             *
+             * @param in_first_idx the index to the first token in the the inbuf for
+             *                     this stage iteration.
+             * @param in_size      the number of input tokens for this iteration
+             * @param inbuf        pointer to the input token buffer
+             * @param out_idx      buffer index for the output token
+             * @param outbuf       pointer to the output token buffer
+             * @param iter_id      current iteration id
+             * @param max_iter     maximum stage iterations
+             * @param pstage       pointer to current pipeline_stage_instance
+             * @param pinst        pointer to current pipeline_instance
+             * @param launch_type
+             *   hetcompute::with_sliding_window
+             *   hetcompute::without_sliding_window
+             */
+            virtual void apply(size_t                   in_first_idx,
+                               size_t                   in_size,
+                               stagebuffer*             inbuf,
+                               size_t                   out_idx,
+                               stagebuffer*             outbuf,
+                               size_t                   iter_id,
+                               size_t                   max_iter,
+                               pipeline_stage_instance* pstage,
+                               pipeline_instance_base*  pinst,
+                               pipeline_launch_type     launch_type)
+            {
+                typedef typename pipeline_utility::get_ringbuffer_type<input_type>::type     ringbuffer_input_type;
+                typedef typename pipeline_utility::get_ringbuffer_type<return_type>::type    ringbuffer_return_type;
+                typedef typename pipeline_utility::get_dynamicbuffer_type<input_type>::type  dynamicbuffer_input_type;
+                typedef typename pipeline_utility::get_dynamicbuffer_type<return_type>::type dynamicbuffer_return_type;
+
+                pipeline_context<UserData...> input_context(iter_id, max_iter, pstage, pinst);
+
+                if (launch_type == with_sliding_window)
+                {
+                    apply_stage<ringbuffer_input_type, ringbuffer_return_type>(in_first_idx,
+                                                                               in_size,
+                                                                               static_cast<ringbuffer_input_type*>(inbuf),
+                                                                               out_idx,
+                                                                               static_cast<ringbuffer_return_type*>(outbuf),
+                                                                               static_cast<void*>(&input_context),
+                                                                               launch_type);
+                }
+                else
+                {
+                    apply_stage<dynamicbuffer_input_type, dynamicbuffer_return_type>(in_first_idx,
+                                                                                     in_size,
+                                                                                     static_cast<dynamicbuffer_input_type*>(inbuf),
+                                                                                     out_idx,
+                                                                                     static_cast<dynamicbuffer_return_type*>(outbuf),
+                                                                                     static_cast<void*>(&input_context),
+                                                                                     launch_type);
+                }
+            }
+
+#ifdef HETCOMPUTE_HAVE_GPU
+            /**
+             * Perform the after function of a stage
+             * should never be called for a dsp stage
+             */
+            virtual void
+            apply_after(size_t, stagebuffer*, size_t, size_t, pipeline_stage_instance*, pipeline_instance_base*, pipeline_launch_type, void*)
+            {
+                HETCOMPUTE_INTERNAL_ASSERT(false, "shoud never be called for a dsp stage");
+            };
+
+            /**
+             * Perform the before function of a stage
+             * should never be called for a dsp stage
+             */
+            virtual std::pair<task_ptr<>, void*>
+            apply_before(size_t, size_t, stagebuffer*, size_t, size_t, pipeline_stage_instance*, pipeline_instance_base*, pipeline_launch_type)
+            {
+                HETCOMPUTE_INTERNAL_ASSERT(false, "shoud never be called for a dsp stage");
+                return std::make_pair(nullptr, nullptr);
+            }
+#endif // HETCOMPUTE_HAVE_GPU
+
+            /**
+             * clone the stage
+             */
+            virtual pipeline_stage_skeleton_base* clone()
+            {
+                return new pipeline_dsp_stage_skeleton<BeforeBody, DK, AfterBody, UserData...>(*this);
+            }
+
+            /**
+             * Release the output buffer for this stage
+             * @param reference of the pointer to the buffer, the value will be reset
+             */
+            virtual void free_stage_buf(stagebuffer*& buf)
+            {
+                delete buf;
+                buf = nullptr;
+            }
+
+            /**
+             * Get the info of the return type of the stage output buffer for type checking
+             * @return size_t
+             */
+            virtual size_t get_return_type() const
+            {
+#ifdef HETCOMPUTE_HAVE_RTTI
+                return typeid(return_type).hash_code();
+#else
+                return pipeline_utility::sizeof_type<return_type>::size;
+#endif // HETCOMPUTE_HAVE_RTTI
+            }
+
+            /**
+             * Get the info of the argument type of the stage input buffer for type checking
+             * @return size_t
+             */
+            virtual size_t get_arg_type() const
+            {
+#ifdef HETCOMPUTE_HAVE_RTTI
+                return typeid(input_type).hash_code();
+#else
+                return pipeline_utility::sizeof_type<input_type>::size;
+#endif // HETCOMPUTE_HAVE_RTTI
+            }
+
+            // Forbid moving and assignment
+            HETCOMPUTE_DELETE_METHOD(pipeline_dsp_stage_skeleton(pipeline_dsp_stage_skeleton&& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_dsp_stage_skeleton& operator=(pipeline_dsp_stage_skeleton const& other));
+            HETCOMPUTE_DELETE_METHOD(pipeline_dsp_stage_skeleton& operator=(pipeline_dsp_stage_skeleton&& other));
+
+            // Make friend classes
+            friend class pipeline_stage_instance;
+            friend class pipeline_skeleton_base;
+
+        private:
+            template <typename IBT, typename OBT>
+            void apply_stage(size_t               in_first_idx,
+                             size_t               in_size,
+                             IBT*                 inbuf,
+                             size_t               out_idx,
+                             OBT*                 outbuf,
+                             void*                context,
+                             pipeline_launch_type launch_type)
+            {
+                typedef typename pipeline_utility::get_return_tuple_type<before_return_type>::type before_body_return_type;
+
+                before_body_return_type rt_bbody =
+                    _before_fct.template apply_before_sync<input_type, IBT>(in_first_idx, in_size, inbuf, context, launch_type);
+
+                dsp_stage_executor<dsp_kernel_type>::execute(_dsp_kernel, rt_bbody);
+
+                _after_fct.template apply_after_sync<before_body_return_type, OBT>(out_idx, outbuf, context, rt_bbody);
+            }
+        };
+        // end of class pipeline_dsp_stage_skeleton<BeforeBody, DK, AfterBody, UserData...>: public pipeline_stage_skeleton_base
+
         /**
          * pipeline skeleton base
          */
@@ -1162,6 +1411,50 @@ namespace hetcompute
             }
 #endif // HETCOMPUTE_HAVE_GPU
 
+            /**
+             * Add a dsp stage to the pipeline skeleton
+             * @param StageType hetcompute::serial_stage or hetcompute::parallel_stage
+             * @param BeforeBody&& before lambda for a dsp stage
+             * @param DKBody the dsp kernel of type hetcompute::dsp_kernel or the host
+             *        stand-in for one of type hetcompute::dsp_stand_in
+             * @param AfterBody&& after lambda for a dsp stage,
+             *        AfterBody = void* if no after lambda is provided
+             * @param bool has_lag define lag or not
+             * @param lag hetcompute::iteration_lag
+             * @param rate hetcompute::iteration_rate
+             * @param sw hetcompute::sliding_window_size specify the size of the sliding window
+             * @param t pattern tuner
+             */
+            template <typename StageType, typename BeforeBody, typename DKBody, typename AfterBody>
+            void add_dsp_stage(StageType const&                  stage,
+                               BeforeBody&&                      bbody,
+                               DKBody&&                          dk,
+                               AfterBody&&                       abody,
+                               bool                              has_lag,
+                               iteration_lag const&              lag,
+                               iteration_rate const&             rate,
+                               sliding_window_size const&        sw,
+                               hetcompute::pattern::tuner const& t)
+            {
+                HETCOMPUTE_API_THROW(_frozen == false, "Cannot add stage after the pipeline is launched.");
+
+                _stages.push_back(new pipeline_dsp_stage_skeleton<BeforeBody, DKBody, AfterBody, UserData...>(std::forward<BeforeBody>(bbody),
+                                                                                                              std::forward<DKBody>(dk),
+                                                                                                              std::forward<AfterBody>(abody),
+                                                                                                              has_lag,
+                                                                                                              _num_stages++,
+                                                                                                              lag,
+                                                                                                              rate,
+                                                                                                              sw,
+                                                                                                              stage,
+                                                                                                              t));
+
+                if (sw._size > 0)
+                {
+                    _has_sliding_window = true;
+                }
+            }
+
             // Make class pipeline friend
             friend class pipeline_instance_base;
 
@@ -10,6 +10,14 @@ namespace hetcompute
         class tuner;
     } // namespace pattern
 
+    template <typename Fn>
+    class dsp_stand_in;
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+    template <typename Fn>
+    class dsp_kernel;
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+
     namespace internal
     {
         namespace pipeline_utility
@@ -615,20 +623,20 @@ namespace hetcompute
             template <size_t N>
             struct apply_launch
             {
-                template <typename CPINST, typename LAUNCHTYPE, typename TUNER, typename TUPLE, typename... T>
-                static void apply(CPINST* cpinst, LAUNCHTYPE& launch_type, TUNER const& tuner, TUPLE& tp, T&... t)
+                template <typename CPINST, typename LAUNCHTYPE, typename TUNER, typename RECORD, typename TUPLE, typename... T>
+                static void apply(CPINST* cpinst, LAUNCHTYPE& launch_type, TUNER const& tuner, RECORD const& record, TUPLE& tp, T&... t)
                 {
-                    apply_launch<N - 1>::apply(cpinst, launch_type, tuner, tp, std::get<N - 1>(tp), t...);
+                    apply_launch<N - 1>::apply(cpinst, launch_type, tuner, record, tp, std::get<N - 1>(tp), t...);
                 }
             };
 
             template <>
             struct apply_launch<0>
             {
-                template <typename CPINST, typename LAUNCHTYPE, typename TUNER, typename TUPLE, typename... T>
-                static void apply(CPINST* cpinst, LAUNCHTYPE& launch_type, TUNER const& tuner, TUPLE&, T&... t)
+                template <typename CPINST, typename LAUNCHTYPE, typename TUNER, typename RECORD, typename TUPLE, typename... T>
+                static void apply(CPINST* cpinst, LAUNCHTYPE& launch_type, TUNER const& tuner, RECORD const& record, TUPLE&, T&... t)
                 {
-                    cpinst->launch(t..., launch_type, tuner);
+                    cpinst->launch(t..., launch_type, tuner, record);
                 }
             };
 
@@ -700,7 +708,6 @@ namespace hetcompute
             };
 #endif
 
-#ifdef HETCOMPUTE_HAVE_GPU
             /**
              * helper to get the return tuple type of a before body
              * return std::tuple<> if the body returns void
@@ -711,18 +718,6 @@ namespace hetcompute
                 using type = typename std::conditional<std::is_same<T, void>::value, std::tuple<>, T>::type;
             };
 
-            template <typename... Args>
-            struct is_hetcompute_pipeline_callable<hetcompute::gpu_kernel<Args...>&>
-            {
-                static constexpr bool value = false;
-            };
-
-            template <typename... Args>
-            struct is_hetcompute_pipeline_callable<hetcompute::gpu_kernel<Args...>>
-            {
-                static constexpr bool value = false;
-            };
-
             /**
              * helper to check if a type is a hetcompute::range or not
              */
@@ -758,6 +753,36 @@ namespace hetcompute
                 using type = std::tuple<Args...>&;
             };
 
+            /**
+             * helper to extract the type of the CPU body
+             * have some drama with getting (&) instead of (*) for function bodies
+             * while using && for the parameters of add_stage
+             */
+            template <typename T, int id>
+            struct get_body_type
+            {
+                using type = typename ::std::tuple_element<id, T>::type;
+            };
+
+            template <typename T>
+            struct get_body_type<T, -1>
+            {
+                using type = void;
+            };
+
+#ifdef HETCOMPUTE_HAVE_GPU
+            template <typename... Args>
+            struct is_hetcompute_pipeline_callable<hetcompute::gpu_kernel<Args...>&>
+            {
+                static constexpr bool value = false;
+            };
+
+            template <typename... Args>
+            struct is_hetcompute_pipeline_callable<hetcompute::gpu_kernel<Args...>>
+            {
+                static constexpr bool value = false;
+            };
+
             // utilities for gpu stages
             /**
              * template helper for stripping buffer directions for variadic template params
@@ -792,23 +817,6 @@ namespace hetcompute
                 using type = void;
             };
 
-            /**
-             * helper to extract the type of the CPU body
-             * have some drama with getting (&) instead of (*) for function bodies
-             * while using && for the parameters of add_stage
-             */
-            template <typename T, int id>
-            struct get_body_type
-            {
-                using type = typename ::std::tuple_element<id, T>::type;
-            };
-
-            template <typename T>
-            struct get_body_type<T, -1>
-            {
-                using type = void;
-            };
-
             /**
              * Helper for parsing the before functor (provided before the gpu kernel)
              */
@@ -926,6 +934,157 @@ namespace hetcompute
             };
 #endif // HETCOMPUTE_HAVE_GPU
 
+            // utilities for dsp stages
+            /**
+             * helper struct to check whether a type is a dsp kernel or a host stand-in for one
+             */
+            template <typename T>
+            struct is_dsp_kernel_helper
+            {
+                static constexpr bool value = false;
+            };
+
+            template <typename Fn>
+            struct is_dsp_kernel_helper<hetcompute::dsp_stand_in<Fn>>
+            {
+                static constexpr bool value = true;
+            };
+
+#ifdef HETCOMPUTE_HAVE_QTI_DSP
+            template <typename Fn>
+            struct is_dsp_kernel_helper<hetcompute::dsp_kernel<Fn>>
+            {
+                static constexpr bool value = true;
+            };
+#endif // HETCOMPUTE_HAVE_QTI_DSP
+
+            template <typename T>
+            struct is_dsp_kernel : is_dsp_kernel_helper<typename std::remove_cv<typename std::remove_reference<T>::type>::type>
+            {
+            };
+
+            /**
+             * helper for parsing the existence of dsp kernel
+             * index is the index of the dsp kernel in the tuple
+             */
+            template <int index, typename TP>
+            struct dsp_kernel_parser
+            {
+                using prior = dsp_kernel_parser<index - 1, TP>;
+                using type  = typename std::tuple_element<index, TP>::type;
+
+                static_assert(prior::dk_index == -1 || !is_dsp_kernel<type>::value, "Multiple dsp kernel found for the pipeline dsp stage");
+
+                static constexpr int dk_index = (prior::dk_index != -1 ? prior::dk_index : is_dsp_kernel<type>::value ? index : -1);
+            };
+
+            template <typename TP>
+            struct dsp_kernel_parser<-1, TP>
+            {
+                static constexpr int dk_index = -1;
+            };
+
+            template <typename... Args>
+            struct check_dsp_kernel
+            {
+                using TP     = std::tuple<Args...>;
+                using result = dsp_kernel_parser<std::tuple_size<TP>::value - 1, TP>;
+
+                static constexpr bool has_dsp_kernel = result::dk_index == -1 ? false : true;
+                static constexpr int  index          = result::dk_index;
+
+                using type = typename tuple_element_type_helper<index, TP>::type;
+            };
+
+            /**
+             * Helper for parsing the before functor (provided before the dsp kernel)
+             */
+            template <typename... Args>
+            struct extract_dsp_before_lambda
+            {
+                using TP = std::tuple<Args...>;
+
+                static_assert(check_dsp_kernel<Args...>::has_dsp_kernel, "extracting before lambda from a non-dsp stage");
+
+                using result = callable_parser<check_dsp_kernel<Args...>::index - 1, TP, check_dsp_kernel<Args...>::index - 1>;
+
+                // The index of the before lambda in the tuple
+                static constexpr int index = result::callable_index;
+
+                // The type of the before lambda
+                using type = typename tuple_element_type_helper<index, TP>::type;
+            };
+
+            /**
+             * helper for parsing the after functor (provided after the dsp kernel)
+             */
+            template <typename... Args>
+            struct extract_dsp_after_lambda
+            {
+                using TP = std::tuple<Args...>;
+
+                static_assert(check_dsp_kernel<Args...>::has_dsp_kernel, "extracting after lambda from a non-dsp stage");
+
+                using result =
+                    callable_parser<std::tuple_size<TP>::value - 1, TP, std::tuple_size<TP>::value - check_dsp_kernel<Args...>::index - 1>;
+
+                // The index of the after lambda in the tuple
+                static constexpr int index = result::callable_index;
+
+                // The type of the after lambda
+                using type = typename tuple_element_type_helper<index, TP>::type;
+            };
+
+            template <typename ContextRefType, typename InputTupleType, typename... Args>
+            struct check_add_dsp_stage_params
+            {
+                static constexpr bool value = true;
+                using TP                    = std::tuple<Args...>;
+                using result                = parse_add_stage_params_appearance<std::tuple_size<TP>::value - 1, TP>;
+
+                static constexpr int dkbody_index = check_dsp_kernel<Args...>::index;
+                using DKBody                      = typename get_body_type<InputTupleType, dkbody_index>::type;
+                static_assert(dkbody_index != -1, "dsp stage should have a dsp kernel or a host stand-in for one");
+
+                static constexpr int bbody_index = extract_dsp_before_lambda<Args...>::index;
+                using BeforeBody                 = typename get_body_type<InputTupleType, bbody_index>::type;
+
+                static constexpr int abody_index = extract_dsp_after_lambda<Args...>::index;
+                using AfterBodyVoid              = typename get_body_type<InputTupleType, abody_index>::type;
+
+                using AfterBody = typename std::conditional<std::is_same<AfterBodyVoid, void>::value, void*, AfterBodyVoid>::type;
+
+                static_assert(!std::is_same<BeforeBody, void>::value, "a dsp stage should have a before lambda");
+
+                using before_arg0_type = typename internal::function_traits<BeforeBody>::template arg_type<0>;
+                static_assert(std::is_same<before_arg0_type, ContextRefType>::value,
+                              "The 1st param for the before functor of a dsp stage should be the pipeline context ref.");
+
+                // Provide a fake type if AfterBody is not provide.
+                using UniAfterBody = typename std::conditional<std::is_same<AfterBodyVoid, void>::value, void (&)(void*), AfterBody>::type;
+
+                using after_arg0_type = typename internal::function_traits<UniAfterBody>::template arg_type<0>;
+
+                static_assert(std::is_same<after_arg0_type, ContextRefType>::value || std::is_same<after_arg0_type, void*>::value,
+                              "The 1st param for the after functor of a dsp stage should be the pipeline context ref.");
+
+                using before_return_type = typename internal::function_traits<BeforeBody>::return_type;
+                static_assert(is_std_tuple<before_return_type>::value, "before lamdba should return a std::tuple");
+                static_assert(std::tuple_size<before_return_type>::value >= 1,
+                              "before lambda's return tuple should have at least one element, i.e. a hetcompute::range");
+
+                using before_return_type_first_element = typename std::tuple_element<0, before_return_type>::type;
+                static_assert(is_hetcompute_range<before_return_type_first_element>::value,
+                              "before lambda's return tuple should be a std::tuple whose first element is a hetcompute::range");
+
+                using StageType                  = typename check_stage_type<Args...>::type;
+                static constexpr int stage_index = check_stage_type<Args...>::index;
+                static_assert(stage_index != -1, "a dsp stage should specify its type, i.e. serial or parallel");
+
+                static_assert(result::parallel_stage_num == 1 || result::serial_stage_num == 1,
+                              "a dsp stage should specify its type, i.e. serial or parallel");
+            };
+
         }; // namespace pipeline_utility
     };     // namespace internal
 };         // namespace hetcompute
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include <hetcompute/internal/patterns/pfor-each-internal.hh>
 
 namespace hetcompute
@@ -106,5 +109,198 @@ namespace hetcompute
             return t;
         }
 
+        // Work-efficient blocked scan
+        //
+        // The range is split into contiguous blocks and scanned in three phases:
+        //   1. every block is reduced in parallel,
+        //   2. the block totals are scanned serially, which gives the value
+        //      carried into each block,
+        //   3. every block is rescanned in parallel starting from its carry.
+        // Every element is read twice and written once, so unlike the Sklansky
+        // scan above, the total work stays O(n).
+        //
+        // Segment heads restart the scan at the initial value, which gives
+        // segmented scans on top of the same three phases.
+        namespace scan
+        {
+            // Below this size, the serial loop is faster than the blocked scan
+            const size_t parallel_threshold = 1 << 16;
+
+            // Minimum number of elements per block
+            const size_t min_block_size = 1 << 12;
+
+            // Heads of an unsegmented scan
+            struct no_heads
+            {
+                bool operator[](size_t) const { return false; }
+            };
+
+            // Heads given by a head-flag array. A nonzero flag starts a new segment.
+            template <typename FlagIterator>
+            struct head_flags
+            {
+                explicit head_flags(FlagIterator flags) : _flags(flags) {}
+
+                bool operator[](size_t i) const { return static_cast<bool>(_flags[i]); }
+
+                FlagIterator _flags;
+            };
+
+            // Running value of a scan, which is unset before the first element of
+            // an inclusive scan without an initial value.
+            template <typename T>
+            struct carry
+            {
+                carry() : _valid(false), _value() {}
+
+                explicit carry(T const& value) : _valid(true), _value(value) {}
+
+                template <typename BinaryFn>
+                void add(T const& x, BinaryFn const& fn)
+                {
+                    _value = _valid ? fn(_value, x) : x;
+                    _valid = true;
+                }
+
+                bool _valid;
+                T    _value;
+            };
+
+            // Serially scans [begin, end), starting from c. Returns the carry after end.
+            template <bool Exclusive, typename RandomAccessIterator, typename Heads, typename T, typename BinaryFn>
+            carry<T> scan_range(RandomAccessIterator first,
+                                size_t               begin,
+                                size_t               end,
+                                Heads const&         heads,
+                                carry<T>             c,
+                                carry<T> const&      init,
+                                BinaryFn const&      fn)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (heads[i])
+                    {
+                        c = init;
+                    }
+                    if (Exclusive)
+                    {
+                        T x      = first[i];
+                        first[i] = c._value;
+                        c.add(x, fn);
+                    }
+                    else
+                    {
+                        c.add(first[i], fn);
+                        first[i] = c._value;
+                    }
+                }
+                return c;
+            }
+
+            // Reduces [begin, end) from its last head, or from begin if it has none
+            template <typename RandomAccessIterator, typename Heads, typename T, typename BinaryFn>
+            void reduce_range(RandomAccessIterator first,
+                              size_t               begin,
+                              size_t               end,
+                              Heads const&         heads,
+                              carry<T>&            c,
+                              char&                has_head,
+                              BinaryFn const&      fn)
+            {
+                c        = carry<T>();
+                has_head = 0;
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (heads[i])
+                    {
+                        has_head = 1;
+                        c        = carry<T>();
+                    }
+                    c.add(first[i], fn);
+                }
+            }
+
+        }; // namespace scan
+
+        // Scans [first, last) in place. Exclusive scans require a valid init.
+        template <bool Exclusive, typename RandomAccessIterator, typename Heads, typename T, typename BinaryFn>
+        void pscan_blocked_internal(group*                            group,
+                                    RandomAccessIterator              first,
+                                    RandomAccessIterator              last,
+                                    Heads const&                      heads,
+                                    scan::carry<T> const&             init,
+                                    BinaryFn const&                   fn,
+                                    const hetcompute::pattern::tuner& tuner)
+        {
+            const size_t n = std::distance(first, last);
+            if (n == 0)
+            {
+                return;
+            }
+
+            if (tuner.is_serial() || n < scan::parallel_threshold || tuner.get_doc() == 1)
+            {
+                scan::scan_range<Exclusive>(first, 0, n, heads, init, init, fn);
+                return;
+            }
+
+            // A few blocks per worker so that pfor_each_static can balance them
+            const size_t num_blocks  = std::max(size_t(1), std::min(4 * tuner.get_doc(), n / scan::min_block_size));
+            auto         block_begin = [n, num_blocks](size_t block) { return block * n / num_blocks; };
+
+            std::vector<scan::carry<T>> carries(num_blocks);
+            std::vector<char>           has_head(num_blocks, 0);
+
+            // Phase 1: block totals
+            pfor_each_static(group,
+                             size_t(0),
+                             num_blocks,
+                             [first, &heads, &fn, &carries, &has_head, block_begin](size_t block) {
+                                 scan::reduce_range(first, block_begin(block), block_begin(block + 1), heads, carries[block], has_head[block], fn);
+                             },
+                             1,
+                             tuner);
+
+            // Phase 2: carry into each block
+            scan::carry<T> c = init;
+            for (size_t block = 0; block < num_blocks; block++)
+            {
+                scan::carry<T> total = carries[block];
+                carries[block]       = c;
+                if (has_head[block])
+                {
+                    c = init;
+                }
+                c.add(total._value, fn);
+            }
+
+            // Phase 3: rescan each block from its carry
+            pfor_each_static(group,
+                             size_t(0),
+                             num_blocks,
+                             [first, &heads, &init, &fn, &carries, block_begin](size_t block) {
+                                 scan::scan_range<Exclusive>(first, block_begin(block), block_begin(block + 1), heads, carries[block], init, fn);
+                             },
+                             1,
+                             tuner);
+        }
+
+        template <bool Exclusive, typename RandomAccessIterator, typename Heads, typename T, typename BinaryFn>
+        hetcompute::task_ptr<void()> pscan_blocked_async(RandomAccessIterator              first,
+                                                         RandomAccessIterator              last,
+                                                         Heads const&                      heads,
+                                                         scan::carry<T> const&             init,
+                                                         BinaryFn const&                   fn,
+                                                         const hetcompute::pattern::tuner& tuner)
+        {
+            auto g    = create_group();
+            auto t    = hetcompute::create_task([g, first, last, heads, init, fn, tuner] {
+                hetcompute::internal::pscan_blocked_internal<Exclusive>(c_ptr(g), first, last, heads, init, fn, tuner);
+            });
+            auto gptr = internal::c_ptr(g);
+            gptr->set_representative_task(internal::c_ptr(t));
+            return t;
+        }
+
     }; // namespace internal
 };     // namespace hetcompute
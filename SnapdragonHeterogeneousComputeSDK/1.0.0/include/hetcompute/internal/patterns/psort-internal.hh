@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hetcompute/internal/patterns/pdivide-and-conquer-internal.hh>
+#include <hetcompute/internal/patterns/psort-radix-internal.hh>
 
 namespace hetcompute
 {
@@ -32,7 +33,7 @@ namespace hetcompute
         }
 
         template <class RandomAccessIterator, class Compare>
-        void psort_internal(RandomAccessIterator first, RandomAccessIterator last, Compare cmp, const hetcompute::pattern::tuner& tuner)
+        void psort_comparison_internal(RandomAccessIterator first, RandomAccessIterator last, Compare cmp, const hetcompute::pattern::tuner& tuner)
         {
             if (tuner.is_serial())
             {
@@ -77,6 +78,98 @@ namespace hetcompute
                 });
         }
 
+        // Keys that cannot be radix sorted
+        template <class RandomAccessIterator, class Compare>
+        void psort_dispatch(RandomAccessIterator first, RandomAccessIterator last, Compare& cmp, const hetcompute::pattern::tuner& tuner, std::false_type)
+        {
+            psort_comparison_internal(first, last, cmp, tuner);
+        }
+
+        // Integral and floating point keys
+        template <class RandomAccessIterator, class Compare>
+        void psort_dispatch(RandomAccessIterator first, RandomAccessIterator last, Compare& cmp, const hetcompute::pattern::tuner& tuner, std::true_type)
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+
+            if (radix::is_selected<value_type, Compare>(std::distance(first, last), tuner))
+            {
+                radix::sort_by(first, last, first, cmp, tuner, std::false_type());
+            }
+            else
+            {
+                psort_comparison_internal(first, last, cmp, tuner);
+            }
+        }
+
+        template <class RandomAccessIterator, class Compare>
+        void psort_internal(RandomAccessIterator first, RandomAccessIterator last, Compare cmp, const hetcompute::pattern::tuner& tuner)
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type value_type;
+
+            psort_dispatch(first, last, cmp, tuner, std::integral_constant<bool, radix::key_traits<value_type>::sortable>());
+        }
+
+        // Sorts keys that cannot be radix sorted as (key, value) pairs
+        template <class KeyIterator, class ValueIterator, class Compare>
+        void psort_by_key_dispatch(KeyIterator                       kfirst,
+                                   KeyIterator                       klast,
+                                   ValueIterator                     vfirst,
+                                   Compare&                          cmp,
+                                   const hetcompute::pattern::tuner& tuner,
+                                   std::false_type)
+        {
+            typedef typename std::iterator_traits<KeyIterator>::value_type   key_type;
+            typedef typename std::iterator_traits<ValueIterator>::value_type value_type;
+            typedef std::pair<key_type, value_type>                          pair_type;
+
+            const size_t           n = std::distance(kfirst, klast);
+            std::vector<pair_type> pairs;
+            pairs.reserve(n);
+            for (size_t i = 0; i < n; i++)
+            {
+                pairs.emplace_back(std::move(kfirst[i]), std::move(vfirst[i]));
+            }
+
+            psort_comparison_internal(pairs.begin(),
+                                      pairs.end(),
+                                      [&cmp](pair_type const& a, pair_type const& b) { return cmp(a.first, b.first); },
+                                      tuner);
+
+            for (size_t i = 0; i < n; i++)
+            {
+                kfirst[i] = std::move(pairs[i].first);
+                vfirst[i] = std::move(pairs[i].second);
+            }
+        }
+
+        template <class KeyIterator, class ValueIterator, class Compare>
+        void psort_by_key_dispatch(KeyIterator                       kfirst,
+                                   KeyIterator                       klast,
+                                   ValueIterator                     vfirst,
+                                   Compare&                          cmp,
+                                   const hetcompute::pattern::tuner& tuner,
+                                   std::true_type)
+        {
+            typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+
+            if (radix::is_selected<key_type, Compare>(std::distance(kfirst, klast), tuner))
+            {
+                radix::sort_by(kfirst, klast, vfirst, cmp, tuner, std::true_type());
+            }
+            else
+            {
+                psort_by_key_dispatch(kfirst, klast, vfirst, cmp, tuner, std::false_type());
+            }
+        }
+
+        template <class KeyIterator, class ValueIterator, class Compare>
+        void psort_by_key_internal(KeyIterator kfirst, KeyIterator klast, ValueIterator vfirst, Compare cmp, const hetcompute::pattern::tuner& tuner)
+        {
+            typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+
+            psort_by_key_dispatch(kfirst, klast, vfirst, cmp, tuner, std::integral_constant<bool, radix::key_traits<key_type>::sortable>());
+        }
+
         template <class RandomAccessIterator, class Compare>
         hetcompute::task_ptr<void()> psort_async(Compare&&                       cmp,
                                                RandomAccessIterator            first,
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <hetcompute/tuner.hh>
+#include <hetcompute/internal/patterns/cpu_pfor_each.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        // Parallel LSD radix sort for integral and floating point keys.
+        //
+        // Keys are mapped to unsigned integers that order the same way and
+        // sorted 8 bits at a time, least significant digit first. The array is
+        // split into one contiguous block per worker. Every pass
+        //   1. counts the digits of each block into a per-block histogram,
+        //   2. turns the histograms into per-block bucket offsets: a block's
+        //      bucket d starts after all smaller digits and after bucket d of
+        //      the blocks before it,
+        //   3. scatters each block into its buckets.
+        // Blocks scatter in order into disjoint slots, so every pass is stable.
+        // Passes whose digit is the same for all keys are skipped, which makes
+        // small keys stored in wide types cheap to sort.
+
+        namespace radix
+        {
+            // Below this size, a comparison sort is faster than the radix sort
+            const size_t threshold = 1 << 14;
+
+            // Minimum number of elements per parallel block
+            const size_t min_block_size = 1 << 12;
+
+            const size_t digit_bits = 8;
+            const size_t num_buckets = 1 << digit_bits;
+
+            template <size_t Size>
+            struct unsigned_bits;
+
+            template <>
+            struct unsigned_bits<1>
+            {
+                typedef uint8_t type;
+            };
+
+            template <>
+            struct unsigned_bits<2>
+            {
+                typedef uint16_t type;
+            };
+
+            template <>
+            struct unsigned_bits<4>
+            {
+                typedef uint32_t type;
+            };
+
+            template <>
+            struct unsigned_bits<8>
+            {
+                typedef uint64_t type;
+            };
+
+            // Maps a key to an unsigned integer of the same size that orders like
+            // the key under std::less.
+            template <typename T, typename Enable = void>
+            struct key_traits
+            {
+                static const bool sortable = false;
+            };
+
+            template <typename T>
+            struct key_traits<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+            {
+                static const bool sortable = true;
+                typedef typename unsigned_bits<sizeof(T)>::type bits_type;
+
+                static bits_type encode(T key)
+                {
+                    // Flipping the sign bit moves negative numbers below positive ones
+                    const bits_type sign = std::is_signed<T>::value ? bits_type(bits_type(1) << (sizeof(T) * 8 - 1)) : bits_type(0);
+                    return static_cast<bits_type>(static_cast<bits_type>(key) ^ sign);
+                }
+            };
+
+            // IEEE 754 keys. Negative numbers have all their bits flipped, so that
+            // larger magnitudes order lower, positive numbers only the sign bit.
+            // -0.0 orders before 0.0, and NaNs order before or after all numbers
+            // depending on their sign bit.
+            template <typename T>
+            struct key_traits<T,
+                              typename std::enable_if<std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+                                                      (sizeof(T) == 4 || sizeof(T) == 8)>::type>
+            {
+                static const bool sortable = true;
+                typedef typename unsigned_bits<sizeof(T)>::type bits_type;
+
+                static bits_type encode(T key)
+                {
+                    const bits_type sign = bits_type(1) << (sizeof(T) * 8 - 1);
+                    bits_type       bits;
+                    std::memcpy(&bits, &key, sizeof(T));
+                    return (bits & sign) != 0 ? bits_type(~bits) : bits_type(bits | sign);
+                }
+            };
+
+            // Order imposed by a comparator, if it is a known one
+            enum class order
+            {
+                unknown,
+                ascending,
+                descending
+            };
+
+            template <typename Compare, typename T>
+            struct compare_order
+            {
+                static const order value = order::unknown;
+            };
+
+            template <typename T>
+            struct compare_order<std::less<T>, T>
+            {
+                static const order value = order::ascending;
+            };
+
+            template <typename T>
+            struct compare_order<std::greater<T>, T>
+            {
+                static const order value = order::descending;
+            };
+
+            // Digit of a key in a given pass
+            template <typename T>
+            struct digit_fn
+            {
+                explicit digit_fn(bool descending) : _mask(descending ? ~bits_type(0) : bits_type(0)) {}
+
+                size_t operator()(T const& key, size_t pass) const
+                {
+                    return static_cast<size_t>(((key_traits<T>::encode(key) ^ _mask) >> (pass * digit_bits)) & (num_buckets - 1));
+                }
+
+            private:
+                typedef typename key_traits<T>::bits_type bits_type;
+                bits_type _mask;
+            };
+
+            // Moves the value that goes with a key, if the sort has values
+            template <typename SrcValues, typename DstValues>
+            inline void move_value(SrcValues src, size_t from, DstValues dst, size_t to, std::true_type)
+            {
+                dst[to] = std::move(src[from]);
+            }
+
+            template <typename SrcValues, typename DstValues>
+            inline void move_value(SrcValues, size_t, DstValues, size_t, std::false_type)
+            {
+            }
+
+            // Runs fn(b) for every block b in [0, num_blocks)
+            template <typename Fn>
+            void for_each_block(size_t num_blocks, const hetcompute::pattern::tuner& tuner, Fn const& fn)
+            {
+                if (num_blocks == 1)
+                {
+                    fn(size_t(0));
+                    return;
+                }
+
+                auto block_tuner = tuner;
+                block_tuner.set_max_doc(num_blocks);
+                pfor_each_static(nullptr, size_t(0), num_blocks, fn, 1, block_tuner);
+            }
+
+            // State of one sort, shared by the blocks
+            template <typename T>
+            struct sort_state
+            {
+                sort_state(size_t n, size_t num_blocks, bool descending)
+                    : _n(n),
+                      _num_blocks(num_blocks),
+                      _digit(descending),
+                      _histograms(num_blocks * sizeof(T) * num_buckets, 0),
+                      _bucket_begin(num_buckets, 0)
+                {
+                }
+
+                size_t block_begin(size_t block) const { return block * _n / _num_blocks; }
+
+                size_t* histogram(size_t block, size_t pass) { return &_histograms[(block * sizeof(T) + pass) * num_buckets]; }
+
+                // Counts the digits of all passes for the keys in a block
+                template <typename KeyIterator>
+                void count_all_passes(KeyIterator keys, size_t block)
+                {
+                    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+                    {
+                        for (size_t pass = 0; pass < sizeof(T); pass++)
+                        {
+                            histogram(block, pass)[_digit(keys[i], pass)]++;
+                        }
+                    }
+                }
+
+                // Counts the digits of one pass for the keys in a block
+                template <typename KeyIterator>
+                void count(KeyIterator keys, size_t block, size_t pass)
+                {
+                    size_t* h = histogram(block, pass);
+                    std::fill(h, h + num_buckets, 0);
+                    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+                    {
+                        h[_digit(keys[i], pass)]++;
+                    }
+                }
+
+                // Computes where every bucket starts for a pass. Returns false if all
+                // keys share the same digit, in which case the pass can be skipped.
+                bool prepare_pass(size_t pass)
+                {
+                    size_t offset = 0;
+                    for (size_t d = 0; d < num_buckets; d++)
+                    {
+                        size_t total = 0;
+                        for (size_t block = 0; block < _num_blocks; block++)
+                        {
+                            total += histogram(block, pass)[d];
+                        }
+                        if (total == _n)
+                        {
+                            return false;
+                        }
+                        _bucket_begin[d] = offset;
+                        offset += total;
+                    }
+                    return true;
+                }
+
+                // Moves the keys (and values) of a block to their slots for a pass
+                template <typename SrcKeys, typename SrcValues, typename DstKeys, typename DstValues, typename HasValues>
+                void scatter(SrcKeys src_keys, SrcValues src_values, DstKeys dst_keys, DstValues dst_values, size_t block, size_t pass, HasValues has_values)
+                {
+                    size_t offsets[num_buckets];
+                    for (size_t d = 0; d < num_buckets; d++)
+                    {
+                        offsets[d] = _bucket_begin[d];
+                        for (size_t previous = 0; previous < block; previous++)
+                        {
+                            offsets[d] += histogram(previous, pass)[d];
+                        }
+                    }
+
+                    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+                    {
+                        size_t to    = offsets[_digit(src_keys[i], pass)]++;
+                        dst_keys[to] = std::move(src_keys[i]);
+                        move_value(src_values, i, dst_values, to, has_values);
+                    }
+                }
+
+                size_t              _n;
+                size_t              _num_blocks;
+                digit_fn<T>         _digit;
+                std::vector<size_t> _histograms;
+                std::vector<size_t> _bucket_begin;
+            };
+
+            // Sorts [kfirst, klast) and permutes the values at vfirst alongside if
+            // HasValues is true. Keys are sorted in ascending order, or in descending
+            // order if descending is set.
+            template <typename KeyIterator, typename ValueIterator, typename HasValues>
+            void sort(KeyIterator kfirst, KeyIterator klast, ValueIterator vfirst, bool descending, const hetcompute::pattern::tuner& tuner, HasValues has_values)
+            {
+                typedef typename std::iterator_traits<KeyIterator>::value_type   key_type;
+                typedef typename std::iterator_traits<ValueIterator>::value_type value_type;
+
+                const size_t n = std::distance(kfirst, klast);
+                if (n < 2)
+                {
+                    return;
+                }
+
+                size_t num_blocks = 1;
+                if (!tuner.is_serial())
+                {
+                    num_blocks = std::max(size_t(1), std::min(tuner.get_doc(), n / min_block_size));
+                }
+
+                sort_state<key_type>    state(n, num_blocks, descending);
+                std::vector<key_type>   key_buffer(n);
+                std::vector<value_type> value_buffer(HasValues::value ? n : 0);
+                key_type*               kbuffer = key_buffer.data();
+                value_type*             vbuffer = value_buffer.data();
+
+                // One read of the input counts the digits of every pass. Later passes
+                // recount their own digit, since the previous scatter moved the keys
+                // to different blocks.
+                for_each_block(num_blocks, tuner, [&state, kfirst](size_t block) { state.count_all_passes(kfirst, block); });
+
+                bool in_place     = true;
+                bool first_active = true;
+                for (size_t pass = 0; pass < sizeof(key_type); pass++)
+                {
+                    if (!state.prepare_pass(pass))
+                    {
+                        continue;
+                    }
+
+                    if (in_place)
+                    {
+                        if (!first_active)
+                        {
+                            for_each_block(num_blocks, tuner, [&state, kfirst, pass](size_t block) { state.count(kfirst, block, pass); });
+                            state.prepare_pass(pass);
+                        }
+                        for_each_block(num_blocks, tuner, [&state, kfirst, vfirst, kbuffer, vbuffer, pass, has_values](size_t block) {
+                            state.scatter(kfirst, vfirst, kbuffer, vbuffer, block, pass, has_values);
+                        });
+                    }
+                    else
+                    {
+                        for_each_block(num_blocks, tuner, [&state, kbuffer, pass](size_t block) { state.count(kbuffer, block, pass); });
+                        state.prepare_pass(pass);
+                        for_each_block(num_blocks, tuner, [&state, kfirst, vfirst, kbuffer, vbuffer, pass, has_values](size_t block) {
+                            state.scatter(kbuffer, vbuffer, kfirst, vfirst, block, pass, has_values);
+                        });
+                    }
+                    in_place     = !in_place;
+                    first_active = false;
+                }
+
+                if (!in_place)
+                {
+                    for_each_block(num_blocks, tuner, [&state, kfirst, vfirst, kbuffer, vbuffer, has_values](size_t block) {
+                        for (size_t i = state.block_begin(block); i < state.block_begin(block + 1); i++)
+                        {
+                            kfirst[i] = std::move(kbuffer[i]);
+                            move_value(vbuffer, i, vfirst, i, has_values);
+                        }
+                    });
+                }
+            }
+
+            // Radix sorts keys (and values) in the order given by cmp. If cmp is
+            // neither std::less nor std::greater, it is assumed to order keys the
+            // way one of them does, and the direction is taken from the sorted keys.
+            template <typename KeyIterator, typename ValueIterator, typename Compare, typename HasValues>
+            void sort_by(KeyIterator kfirst, KeyIterator klast, ValueIterator vfirst, Compare& cmp, const hetcompute::pattern::tuner& tuner, HasValues has_values)
+            {
+                typedef typename std::iterator_traits<KeyIterator>::value_type key_type;
+
+                const order o = compare_order<typename std::decay<Compare>::type, key_type>::value;
+                sort(kfirst, klast, vfirst, o == order::descending, tuner, has_values);
+
+                const size_t n = std::distance(kfirst, klast);
+                if (o == order::unknown && n > 1 && cmp(kfirst[n - 1], kfirst[0]))
+                {
+                    std::reverse(kfirst, klast);
+                    if (HasValues::value)
+                    {
+                        std::reverse(vfirst, vfirst + n);
+                    }
+                }
+            }
+
+            // Whether psort should radix sort n keys with cmp
+            template <typename T, typename Compare>
+            bool is_selected(size_t n, const hetcompute::pattern::tuner& tuner)
+            {
+                switch (tuner.get_sort_algorithm())
+                {
+                case hetcompute::pattern::sort_algorithm::radix:
+                    return true;
+                case hetcompute::pattern::sort_algorithm::comparison:
+                    return false;
+                default:
+                    return !tuner.is_serial() && n >= threshold &&
+                           compare_order<typename std::decay<Compare>::type, T>::value != order::unknown;
+                }
+            }
+
+        }; // namespace radix
+
+    }; // namespace internal
+};     // namespace hetcompute
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <new>
+#include <type_traits>
 
 #include <hetcompute/internal/atomic/atomicops.hh>
 #include <hetcompute/internal/compat/compiler_compat.h>
+#include <hetcompute/internal/memalloc/alignedmalloc.hh>
 #include <hetcompute/internal/util/debug.hh>
 #include <hetcompute/internal/util/macros.hh>
 #include <hetcompute/internal/util/memorder.hh>
@@ -318,6 +321,12 @@ namespace hetcompute
                     return _max_array_size;
                 }
 
+                // This method returns the number of bytes of the element array, which is allocated on the heap.
+                size_t get_heap_footprint() const
+                {
+                    return _max_array_size * sizeof(std::atomic<element>);
+                }
+
             private:
                 // Head index of the array.
                 std::atomic<size_t> _head;
@@ -341,14 +350,55 @@ namespace hetcompute
             };
 
             // Specialize the queue for the case when the sizeof(T) > sizeof(size_t)
+            //
+            // Values that do not fit in the val field of an element are boxed, and the address of the box
+            // is stored in the queue instead. Boxes come from a slot array that is preallocated along with
+            // the queue and sized to its capacity. Free slots are recycled through a second bounded_lfqueue
+            // that holds their addresses, so push and pop do not touch the heap in the steady state.
+            // The free slot queue is twice as large as the number of slots, so returning a slot never
+            // finds it full. If all slots are in use (e.g. many pushers racing on a full queue), the
+            // value is boxed on the heap instead. release_slot() tells both cases apart by address.
+            // Slots and boxes are allocated with the alignment of T, which new does not honor for
+            // over-aligned types.
+            //
+            // A slot whose address cannot be put back, because the free slot queue was closed by a starving
+            // pusher, is retired: it stays unused until the queue is destroyed, and values take heap boxes
+            // once the remaining free slots run out.
+            //
+            // Memory: each entry costs 48 + sizeof(T) bytes up front (its element, two elements of the free
+            // slot queue and a slot) instead of the 16 bytes of the element alone, i.e. a queue is about
+            // 4x larger for a 16-byte T and 6x larger for a 48-byte T, see get_heap_footprint().
             template <typename T>
             class blfq_size_t<T, false>
             {
                 static_assert(sizeof(T*) <= sizeof(size_t), "Error. Address has size greater than sizeof(size_t)");
 
+                typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type slot_type;
+
+                // hetcompute_aligned_malloc takes at least the alignment of a pointer
+                static HETCOMPUTE_CONSTEXPR_CONST size_t s_slot_alignment =
+                    alignof(slot_type) > sizeof(void*) ? alignof(slot_type) : sizeof(void*);
+
             public:
-                explicit blfq_size_t(size_t log_size = 12) : _blfq(log_size)
+                explicit blfq_size_t(size_t log_size = 12)
+                    : _blfq(log_size), _free_slots(log_size + 1), _num_slots(size_t(1) << log_size), _slots(nullptr), _retired_slots(0)
                 {
+                    _slots = static_cast<slot_type*>(allocate(_num_slots * sizeof(slot_type)));
+                    for (size_t i = 0; i < _num_slots; i++)
+                    {
+                        recycle_slot(&_slots[i]);
+                    }
+                }
+
+                // Destroy the values still in the queue and free the slot array.
+                ~blfq_size_t()
+                {
+                    T* ptr;
+                    while (_blfq.take(reinterpret_cast<size_t*>(&ptr), false) != 0)
+                    {
+                        release_slot(ptr);
+                    }
+                    hetcompute_aligned_free(_slots);
                 }
 
                 // Disallow copy construction, move construction and the overloaded assignment operators.
@@ -359,20 +409,25 @@ namespace hetcompute
 
                 size_t push(T const& value, bool is_unbounded_queue)
                 {
-                    // Allocated space to store value
-                    // TODO: Allow recycling of ptr so that we do not allocate T objects each time.
-                    T* ptr = new T(value);
+                    T*     ptr = acquire_slot(value);
+                    size_t res;
                     if (is_unbounded_queue)
-                        return (_blfq.unbounded_put(reinterpret_cast<size_t>(ptr)));
+                        res = _blfq.unbounded_put(reinterpret_cast<size_t>(ptr));
                     else
-                        return (_blfq.bounded_put(reinterpret_cast<size_t>(ptr)));
+                        res = _blfq.bounded_put(reinterpret_cast<size_t>(ptr));
+                    if (res == 0)
+                    {
+                        // The queue was full, the value never made it in.
+                        release_slot(ptr);
+                    }
+                    return res;
                 }
 
                 // gcc is very aggressive in trying to detect alias violations.
                 HETCOMPUTE_GCC_IGNORE_BEGIN("-Wstrict-aliasing")
                 size_t produce(T const& value, T& result)
                 {
-                    T*     ptr = new T(value);
+                    T*     ptr = acquire_slot(value);
                     T*     ret_ptr;
                     size_t res = _blfq.overwrite_put(reinterpret_cast<size_t>(ptr), reinterpret_cast<size_t*>(&ret_ptr));
                     if (res != 0)
@@ -380,9 +435,14 @@ namespace hetcompute
                         if (ret_ptr != nullptr)
                         { // overwrote an existing value
                             result = *ret_ptr;
-                            delete ret_ptr;
+                            release_slot(ret_ptr);
                         }
                     }
+                    else
+                    {
+                        // The node was closed, the value never made it in.
+                        release_slot(ptr);
+                    }
                     return res;
                 }
 
@@ -393,8 +453,8 @@ namespace hetcompute
                     if (res != 0)
                     {
                         result = *ptr;
-                        // delete the associated backing memory
-                        delete ptr;
+                        // recycle the associated backing memory
+                        release_slot(ptr);
                     }
                     return res;
                 }
@@ -406,8 +466,8 @@ namespace hetcompute
                     if (res != 0)
                     {
                         result = *ptr;
-                        // delete the associated backing memory
-                        delete ptr;
+                        // recycle the associated backing memory
+                        release_slot(ptr);
                     }
                     return res;
                 }
@@ -433,8 +493,86 @@ namespace hetcompute
                     return _blfq.get_max_array_size();
                 }
 
+                // Number of slots retired because the free slot queue refused them.
+                size_t get_num_retired_slots() const
+                {
+                    return _retired_slots.load(hetcompute::mem_order_relaxed);
+                }
+
+                // Number of heap bytes owned by the queue: element arrays and value slots.
+                size_t get_heap_footprint() const
+                {
+                    return _blfq.get_heap_footprint() + _free_slots.get_heap_footprint() + _num_slots * sizeof(slot_type);
+                }
+
             private:
+                // Copies value into a free slot, or into a heap box if there are no free slots left.
+                T* acquire_slot(T const& value)
+                {
+                    size_t slot;
+                    if (_free_slots.take(&slot, false) != 0)
+                    {
+                        return new (reinterpret_cast<void*>(slot)) T(value);
+                    }
+                    return new (allocate(sizeof(slot_type))) T(value);
+                }
+
+                // Destroys the value in ptr and returns its slot to the free slot queue.
+                void release_slot(T* ptr)
+                {
+                    ptr->~T();
+                    if (is_slot(ptr))
+                    {
+                        recycle_slot(ptr);
+                    }
+                    else
+                    {
+                        hetcompute_aligned_free(ptr);
+                    }
+                }
+
+                // Puts a slot back in the free slot queue. The queue has room for twice the slots, so it is never
+                // full, but it refuses puts while it is closed. The slot is then retired, and acquire_slot() falls
+                // back to heap boxes when no free slot is left.
+                void recycle_slot(void* slot)
+                {
+                    if (_free_slots.bounded_put(reinterpret_cast<size_t>(slot)) == 0)
+                    {
+                        _retired_slots.fetch_add(1, hetcompute::mem_order_relaxed);
+                    }
+                }
+
+                // Allocates memory aligned for T
+                static void* allocate(size_t size)
+                {
+                    void* p = hetcompute_aligned_malloc(s_slot_alignment, size);
+                    if (p == nullptr)
+                    {
+#ifndef HETCOMPUTE_DISABLE_EXCEPTIONS
+                        throw std::bad_alloc();
+#else
+                        HETCOMPUTE_FATAL("HetCompute Memory allocation failed in bounded_lfqueue");
+#endif
+                    }
+                    return p;
+                }
+
+                bool is_slot(T* ptr) const
+                {
+                    auto p = reinterpret_cast<slot_type*>(ptr);
+                    return p >= _slots && p < _slots + _num_slots;
+                }
+
                 bounded_lfqueue _blfq;
+
+                // Addresses of the slots that do not currently hold a value.
+                bounded_lfqueue _free_slots;
+
+                size_t const _num_slots;
+
+                slot_type* _slots;
+
+                std::atomic<size_t> _retired_slots;
             };
 
             template <typename T>
@@ -543,6 +681,12 @@ namespace hetcompute
                     return _blfq.get_max_array_size();
                 }
 
+                // Number of heap bytes owned by the queue.
+                size_t get_heap_footprint() const
+                {
+                    return _blfq.get_heap_footprint();
+                }
+
             private:
                 bounded_lfqueue _blfq;
             };
@@ -34,7 +34,7 @@ namespace hetcompute
             public:
                 typedef typename internal::blfq::blfq_size_t<T, sizeof(T) <= sizeof(size_t) > container_type;
 
-                explicit lfq_node(size_t log_size) : _c(log_size), _next(nullptr)
+                explicit lfq_node(size_t log_size) : _c(log_size), _next(nullptr), _retired_next(nullptr), _retire_epoch(0)
                 {
                 }
 
@@ -74,6 +74,12 @@ namespace hetcompute
                     return _c.get_max_array_size();
                 }
 
+                // Number of bytes taken by the node, including the heap memory of its bounded lfqueue.
+                size_t get_memory_footprint() const
+                {
+                    return sizeof(lfq_node<T>) + _c.get_heap_footprint();
+                }
+
             private:
                 // The bounded lfqueue
                 container_type _c;
@@ -81,33 +87,99 @@ namespace hetcompute
                 // A pointer to the next node in the linked list.
                 std::atomic <lfq_node<T>*> _next;
 
+                // Next node in the list of retired nodes waiting to be freed.
+                lfq_node<T>* _retired_next;
+
+                // Reclamation epoch in which the node was retired.
+                size_t _retire_epoch;
+
                 friend class lfq<T>;
             };
 
             // The internal lfqueue class.
+            //
+            // Nodes that have been drained are unlinked by the pop that moves _head past them, and are freed
+            // while the queue is live using epoch-based reclamation:
+            // 1. Every push and pop registers itself in the current epoch for its whole duration (epoch_guard).
+            //    Registration increments the counter of the epoch and then checks that the epoch did not change
+            //    in between, otherwise it retries in the new epoch.
+            // 2. The global epoch may only advance from e to e+1 when no operation is registered in epoch e-1.
+            // 3. Once _head and _tail have both moved past a node, no new operation can reach it. The node is
+            //    retired, i.e. pushed onto the _retired list together with the epoch r observed after unlinking it.
+            //    Operations that may still hold a pointer to the node are registered in epoch r or earlier.
+            //    The epoch can only reach r+2 after all of them have finished, so the node is freed at that point.
+            // Only three epoch counters are needed, as by the time epoch e+3 reuses the counter of epoch e, that
+            // counter has been drained (that was the condition to advance to e+2).
             template<typename T>
             class lfq
             {
+                // Number of epoch counters kept at any time.
+                static constexpr size_t s_num_epochs = 3;
+
+                // Counters live in different cache lines so that operations in consecutive epochs do not contend.
+                static constexpr size_t s_epoch_counter_bytes = 64;
+
+                struct epoch_counter
+                {
+                    std::atomic<size_t> _count;
+                    char                _padding[s_epoch_counter_bytes - sizeof(std::atomic<size_t>)];
+
+                    epoch_counter() : _count(0)
+                    {
+                        HETCOMPUTE_UNUSED(_padding);
+                    }
+                };
+
+                // Registers the calling operation in the current epoch for the lifetime of the guard.
+                class epoch_guard
+                {
+                public:
+                    explicit epoch_guard(lfq& q) : _q(q), _epoch(q.enter_epoch())
+                    {
+                    }
+
+                    ~epoch_guard()
+                    {
+                        _q.exit_epoch(_epoch);
+                    }
+
+                    HETCOMPUTE_DELETE_METHOD(epoch_guard(epoch_guard const&));
+                    HETCOMPUTE_DELETE_METHOD(epoch_guard& operator=(epoch_guard const&));
+
+                private:
+                    lfq&         _q;
+                    size_t const _epoch;
+                };
+
             public:
                 typedef lfq_node<T> blfq_node;
                 typedef T value_type;
 
-                explicit lfq(size_t log_size = 12) : _head(nullptr), _tail(nullptr), _original_head(nullptr)
+                explicit lfq(size_t log_size = 12)
+                    : _head(nullptr), _tail(nullptr), _epoch(0), _active(), _retired(nullptr), _last_retire_epoch(0), _num_nodes(1), _node_footprint(0)
                 {
                     _head = new blfq_node(log_size);
                     _tail.store(_head);
-                    _original_head = _head;
+                    _node_footprint = _head.load()->get_memory_footprint();
                 }
 
                 virtual ~lfq()
                 {
-                    // Free All allocated nodes in the queue, since its construction.
-                    HETCOMPUTE_INTERNAL_ASSERT(_original_head != nullptr, "Error. Head is nullptr");
-                    while (_original_head != nullptr)
+                    // Free the nodes still linked in the queue, and the nodes waiting to be reclaimed.
+                    auto cur = _head.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                    HETCOMPUTE_INTERNAL_ASSERT(cur != nullptr, "Error. Head is nullptr");
+                    while (cur != nullptr)
+                    {
+                        auto next = cur->get_next();
+                        delete cur;
+                        cur = next;
+                    }
+                    cur = _retired.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                    while (cur != nullptr)
                     {
-                        auto cur       = _original_head;
-                        _original_head = cur->_next;
+                        auto next = cur->_retired_next;
                         delete cur;
+                        cur = next;
                     }
                 }
 
@@ -117,11 +189,62 @@ namespace hetcompute
                 HETCOMPUTE_DELETE_METHOD(lfq& operator=(lfq const&));
                 HETCOMPUTE_DELETE_METHOD(lfq& operator=(lfq &&));
 
-                // Push method. Value is pushed into the BLFQ of the node pointed to by _tail.
+                // Push method. Value is pushed into the BLFQ of the node pointed to by _tail, and a new node
+                // is appended when that one is full. Push is always successful, so returns a value >= 1
+                size_t push(value_type const & v)
+                {
+                    size_t sz;
+                    {
+                        epoch_guard guard(*this);
+                        sz = push_impl(v);
+                    }
+                    maybe_reclaim_nodes();
+                    return sz;
+                }
+
+                // Pop method. Element is removed from the BLFQ at the node pointed to by _head.
+                // Returns 0 if the LFQ is empty; unsafe size of the head node otherwise.
+                size_t pop(value_type & r)
+                {
+                    size_t sz;
+                    {
+                        epoch_guard guard(*this);
+                        sz = pop_impl(r);
+                    }
+                    maybe_reclaim_nodes();
+                    return sz;
+                }
+
+                // Size of the queue. Since the queue is a linked list of nodes, and the size is used only to determine if
+                // waiting threads need to be signaled, it is sufficient to return the size of the head node.
+                // Return number of elements in the (head node of the) queue.
+                // This is the unsafe size, and is used only for debugging purposes, i.e dumping the log.
+                // This method is not exposed to the user.
+                size_t head_node_size() const
+                {
+                    auto current_blfq_node = _head.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                    return current_blfq_node->_c.size();
+                }
+
+                // Number of bytes currently taken by the queue: the queue object itself, the nodes linked in
+                // the queue and the drained nodes that have not been reclaimed yet.
+                size_t memory_footprint() const
+                {
+                    return sizeof(lfq<T>) + _num_nodes.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed)) * _node_footprint;
+                }
+
+                // Number of nodes currently allocated by the queue, including the ones waiting to be reclaimed.
+                size_t node_count() const
+                {
+                    return _num_nodes.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                }
+
+            private:
+                // Push implementation, called with the epoch guard held. Value is pushed into the BLFQ of the node pointed to by _tail.
                 // If the BLFQ is full, then a new node is created and the value is pushed into the BLFQ of
                 // that node. Finally, the node is appended to the list. If the CAS to append the node fails,
                 // then the push operation is retried. Push is always successful, so returns a value >= 1
-                size_t push(value_type const & v)
+                size_t push_impl(value_type const & v)
                 {
                     // Keep track of the number of times a full node is encountered
                     // This value is then multiplied with the size of a node to return an estimate of the size of
@@ -157,6 +280,7 @@ namespace hetcompute
 
                         // Push failed. Allocate a new node, and push value into the BLFQ of that node.
                         auto new_blfq_node = new blfq_node(current_blfq_node->get_log_node_size());
+                        _num_nodes.fetch_add(1, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
                         // Push into the newly allocated node. Note that this is 'local' push in the sense that
                         // only the current thread is aware of this node. In other words, there is no contention here.
                         sz = new_blfq_node->_c.push(v, true);
@@ -175,13 +299,14 @@ namespace hetcompute
                         {
                             // Failed to append new_blfq_node. Delete it.
                             delete new_blfq_node;
+                            _num_nodes.fetch_sub(1, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
                         }
                     }
                 }
 
-                // Pop method. Element is removed from the BLFQ at the node pointed to by _head.
+                // Pop implementation, called with the epoch guard held. Element is removed from the BLFQ at the node pointed to by _head.
                 // Returns 0 if the LFQ is empty; unsafe size of the head node otherwise.
-                size_t pop(value_type & r)
+                size_t pop_impl(value_type & r)
                 {
                     while (true)
                     {
@@ -222,30 +347,145 @@ namespace hetcompute
                         }
 
                         // Pop failed, so the node is empty. Switch head to point to next_blfq
-                        _head.compare_exchange_strong(current_blfq_node, next_blfq_node, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                        if (_head.compare_exchange_strong(current_blfq_node, next_blfq_node, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_seq_cst)))
+                        {
+                            // Only the pop that unlinked the node retires it. _tail cannot be behind the
+                            // unlinked node, but it may still point to it, so help pushers move it forward.
+                            auto tail_node = current_blfq_node;
+                            _tail.compare_exchange_strong(tail_node, next_blfq_node, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_seq_cst));
+                            retire_node(current_blfq_node);
+                        }
                     }
                 }
 
-                // Size of the queue. Since the queue is a linked list of nodes, and the size is used only to determine if
-                // waiting threads need to be signaled, it is sufficient to return the size of the head node.
-                // Return number of elements in the (head node of the) queue.
-                // This is the unsafe size, and is used only for debugging purposes, i.e dumping the log.
-                // This method is not exposed to the user.
-                size_t head_node_size() const
+                // Registers an operation in the current epoch and returns that epoch.
+                size_t enter_epoch()
                 {
-                    auto current_blfq_node = _head.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
-                    return current_blfq_node->_c.size();
+                    while (true)
+                    {
+                        auto e = _epoch.load(hetcompute::mem_order_seq_cst);
+                        _active[e % s_num_epochs]._count.fetch_add(1, hetcompute::mem_order_seq_cst);
+                        if (_epoch.load(hetcompute::mem_order_seq_cst) == e)
+                        {
+                            return e;
+                        }
+                        // The epoch advanced in between, register in the new one.
+                        _active[e % s_num_epochs]._count.fetch_sub(1, hetcompute::mem_order_release);
+                    }
+                }
+
+                // Deregisters an operation from the epoch it entered.
+                void exit_epoch(size_t e)
+                {
+                    _active[e % s_num_epochs]._count.fetch_sub(1, hetcompute::mem_order_release);
+                }
+
+                // Advances the epoch if no operation is registered in the previous one.
+                void try_advance_epoch()
+                {
+                    auto e = _epoch.load(hetcompute::mem_order_seq_cst);
+                    if (_active[(e + s_num_epochs - 1) % s_num_epochs]._count.load(hetcompute::mem_order_seq_cst) == 0)
+                    {
+                        _epoch.compare_exchange_strong(e, e + 1, hetcompute::mem_order_seq_cst);
+                    }
+                }
+
+                // Pushes a list of retired nodes, linked through _retired_next, onto _retired.
+                void push_retired(blfq_node* first, blfq_node* last)
+                {
+                    auto old_first = _retired.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                    do
+                    {
+                        last->_retired_next = old_first;
+                    } while (!_retired.compare_exchange_weak(old_first,
+                                                             first,
+                                                             HETCOMPUTE_LFQ_MO(hetcompute::mem_order_release),
+                                                             HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed)));
+                }
+
+                // Hands over a node that is no longer reachable from _head or _tail, and frees the retired
+                // nodes that no operation can reference anymore.
+                void retire_node(blfq_node* node)
+                {
+                    node->_retire_epoch = _epoch.load(hetcompute::mem_order_seq_cst);
+                    _last_retire_epoch.store(node->_retire_epoch, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                    push_retired(node, node);
+                    try_advance_epoch();
+                    reclaim_nodes();
+                }
+
+                // Called by every operation after leaving its epoch. While there are retired nodes, keep
+                // pushing the epoch forward, and free them once the youngest one is old enough.
+                void maybe_reclaim_nodes()
+                {
+                    if (_retired.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed)) == nullptr)
+                    {
+                        return;
+                    }
+                    try_advance_epoch();
+                    if (_epoch.load(hetcompute::mem_order_seq_cst) >= _last_retire_epoch.load(HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed)) + 2)
+                    {
+                        reclaim_nodes();
+                    }
+                }
+
+                // Frees the retired nodes that are at least two epochs old. The list is detached as a whole, so
+                // concurrent reclaimers work on disjoint nodes. Nodes that are too young are pushed back.
+                void reclaim_nodes()
+                {
+                    auto node = _retired.exchange(nullptr, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_acquire));
+                    auto e    = _epoch.load(hetcompute::mem_order_seq_cst);
+
+                    blfq_node* keep_first = nullptr;
+                    blfq_node* keep_last  = nullptr;
+                    while (node != nullptr)
+                    {
+                        auto next = node->_retired_next;
+                        if (node->_retire_epoch + 2 <= e)
+                        {
+                            delete node;
+                            _num_nodes.fetch_sub(1, HETCOMPUTE_LFQ_MO(hetcompute::mem_order_relaxed));
+                        }
+                        else
+                        {
+                            node->_retired_next = keep_first;
+                            keep_first          = node;
+                            if (keep_last == nullptr)
+                            {
+                                keep_last = node;
+                            }
+                        }
+                        node = next;
+                    }
+                    if (keep_first != nullptr)
+                    {
+                        push_retired(keep_first, keep_last);
+                    }
                 }
 
-            private:
                 // Head of the queue. This is the node from which values are popped.
                 std::atomic<blfq_node*> _head;
 
                 // Tail of the queue. This is the node into which values are pushed.
                 std::atomic<blfq_node*> _tail;
 
-                // Original head of the list of allocated nodes. Used at the time of destruction to free all allocated nodes.
-                blfq_node* _original_head;
+                // Current reclamation epoch.
+                std::atomic<size_t> _epoch;
+
+                // Number of operations registered in each of the last s_num_epochs epochs.
+                epoch_counter _active[s_num_epochs];
+
+                // Drained nodes waiting for the epoch to advance before they are freed.
+                std::atomic<blfq_node*> _retired;
+
+                // Epoch in which the most recent node was retired.
+                std::atomic<size_t> _last_retire_epoch;
+
+                // Number of allocated nodes, both linked in the queue and retired.
+                std::atomic<size_t> _num_nodes;
+
+                // Number of bytes taken by each node. All nodes have the same size.
+                size_t _node_footprint;
             };
 
         }; // namespace lfq
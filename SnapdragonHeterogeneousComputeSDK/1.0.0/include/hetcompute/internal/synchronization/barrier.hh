@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
 #include <hetcompute/internal/legacy/task.hh>
+#include <hetcompute/internal/runtime-internal.hh>
 #include <hetcompute/internal/synchronization/mutex.hh>
+#include <hetcompute/internal/util/memorder.hh>
 
 // Contains barrier interface for HetCompute applications
 //
@@ -19,11 +24,28 @@
 //
 // For responsiveness, some amount of spinning is done before
 // yielding to the HetCompute scheduler
+//
+// combining_tree_barrier spreads the arrivals over a tree of counters
+// instead, with one leaf per group of participants running on the same
+// cluster, so that only the last arriver of each group reaches the
+// upper levels and the shared lines stay within clusters
 
 namespace hetcompute
 {
     namespace internal
     {
+        // Hints the core that the calling thread is busy-waiting
+        inline void spin_pause()
+        {
+#if defined(__aarch64__) || defined(__arm__)
+            __asm__ __volatile__("yield" ::: "memory");
+#elif defined(__i386__) || defined(__x86_64__)
+            __asm__ __volatile__("pause" ::: "memory");
+#else
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+
         class sense_barrier
         {
         private:
@@ -62,8 +84,172 @@ namespace hetcompute
             void create_wait_task(bool local_sense);
         };
 
+        // Combining-tree barrier for participants identified by an index in
+        // [0, count).
+        //
+        // The leaves group consecutive participants by cluster of a big.LITTLE
+        // SoC: the first num_big_execution_contexts() participants, then the next
+        // num_little_execution_contexts(), and so on cyclically. The upper levels
+        // combine up to FAN_IN nodes. The last participant to arrive at a node
+        // arrives at its parent, and the last one at the root releases the tree
+        // back down, node by node, so that waiters only spin on the node of their
+        // own group.
+        //
+        // Like sense_barrier, waiters spin for SPIN_THRESHOLD iterations and then
+        // yield() to the HetCompute scheduler.
+        class combining_tree_barrier
+        {
+        private:
+            // Nodes keep their counter and their phase in different cache lines, so
+            // that arrivals do not steal the line the waiters spin on.
+            static constexpr size_t s_line_bytes = 64;
+
+            struct node
+            {
+                // number of participants or children arrived in the current phase
+                std::atomic<size_t> _count;
+                char                _count_padding[s_line_bytes - sizeof(std::atomic<size_t>)];
+                // bumped by the last arriver once the phase completes above the node
+                std::atomic<size_t> _phase;
+                size_t              _total;
+                node*               _parent;
+                char                _phase_padding[s_line_bytes - sizeof(std::atomic<size_t>) - sizeof(size_t) - sizeof(node*)];
+
+                node() : _count(0), _phase(0), _total(0), _parent(nullptr)
+                {
+                    HETCOMPUTE_UNUSED(_count_padding);
+                    HETCOMPUTE_UNUSED(_phase_padding);
+                }
+
+                node(node const& other) : _count(0), _phase(0), _total(other._total), _parent(other._parent)
+                {
+                }
+            };
+
+            size_t              _total;
+            std::vector<node>   _nodes;
+            // index in _nodes of the leaf of each participant
+            std::vector<size_t> _leaf_of;
+
+        public:
+            static const int    SPIN_THRESHOLD = 10000;
+            static const size_t FAN_IN         = 4;
+
+            // cluster_size == 0 groups the participants by the big and LITTLE clusters,
+            // or by FAN_IN on homogeneous SoCs. Must be constructed after runtime::init().
+            explicit combining_tree_barrier(size_t count, size_t cluster_size = 0) : _total(count), _nodes(), _leaf_of(count)
+            {
+                HETCOMPUTE_API_ASSERT(count > 0, "A barrier needs at least one participant");
+
+                size_t big    = num_big_execution_contexts();
+                size_t little = num_little_execution_contexts();
+                if (cluster_size != 0 || big == 0 || little == 0)
+                {
+                    big    = (cluster_size != 0 ? cluster_size : FAN_IN);
+                    little = big;
+                }
+
+                // leaves, alternating between a big and a LITTLE group
+                std::vector<size_t> level;
+                bool                big_group = true;
+                for (size_t first = 0; first < count; big_group = !big_group)
+                {
+                    size_t group = std::min(big_group ? big : little, count - first);
+                    std::fill(_leaf_of.begin() + first, _leaf_of.begin() + first + group, _nodes.size());
+                    level.push_back(_nodes.size());
+                    _nodes.push_back(node());
+                    _nodes.back()._total = group;
+                    first += group;
+                }
+
+                // upper levels, up to the root. _parent is set once _nodes stops growing.
+                std::vector<size_t> parent_of(_nodes.size(), 0);
+                while (level.size() > 1)
+                {
+                    std::vector<size_t> upper;
+                    for (size_t i = 0; i < level.size(); i += FAN_IN)
+                    {
+                        size_t children = std::min(FAN_IN, level.size() - i);
+                        for (size_t c = 0; c < children; c++)
+                        {
+                            parent_of[level[i + c]] = _nodes.size();
+                        }
+                        upper.push_back(_nodes.size());
+                        _nodes.push_back(node());
+                        _nodes.back()._total = children;
+                        parent_of.push_back(0);
+                    }
+                    level.swap(upper);
+                }
+
+                for (size_t i = 0; i + 1 < _nodes.size(); i++)
+                {
+                    _nodes[i]._parent = &_nodes[parent_of[i]];
+                }
+            }
+
+            HETCOMPUTE_DELETE_METHOD(combining_tree_barrier(combining_tree_barrier&));
+            HETCOMPUTE_DELETE_METHOD(combining_tree_barrier(combining_tree_barrier&&));
+            HETCOMPUTE_DELETE_METHOD(combining_tree_barrier& operator=(combining_tree_barrier const&));
+            HETCOMPUTE_DELETE_METHOD(combining_tree_barrier& operator=(combining_tree_barrier&&));
+
+            // Waits until all the participants called wait() in this phase. Each
+            // participant calls it with its own index, once per phase.
+            void wait(size_t participant)
+            {
+                HETCOMPUTE_API_ASSERT(participant < _total,
+                                      "Participant %zu out of the %zu participants of the barrier",
+                                      participant,
+                                      _total);
+                arrive(&_nodes[_leaf_of[participant]]);
+            }
+
+            size_t get_num_participants() const
+            {
+                return _total;
+            }
+
+        private:
+            void arrive(node* n)
+            {
+                // the phase can only change once this arrival completes it
+                size_t phase = n->_phase.load(hetcompute::mem_order_acquire);
+                if (n->_count.fetch_add(1, hetcompute::mem_order_acq_rel) + 1 == n->_total)
+                {
+                    // last arriver: reset the node for the next phase, complete the
+                    // phase above and release the waiters of the node
+                    n->_count.store(0, hetcompute::mem_order_relaxed);
+                    if (n->_parent != nullptr)
+                    {
+                        arrive(n->_parent);
+                    }
+                    n->_phase.store(phase + 1, hetcompute::mem_order_release);
+                    return;
+                }
+
+                int spins = 0;
+                while (n->_phase.load(hetcompute::mem_order_acquire) == phase)
+                {
+                    if (spins < SPIN_THRESHOLD)
+                    {
+                        spin_pause();
+                        spins++;
+                    }
+                    else if (current_task() != nullptr)
+                    {
+                        yield();
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        };
+
     }; // namespace internal
 
     typedef internal::sense_barrier barrier;
+    typedef internal::combining_tree_barrier combining_barrier;
 
 }; // namespace hetcompute
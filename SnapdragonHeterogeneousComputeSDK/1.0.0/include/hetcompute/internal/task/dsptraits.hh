@@ -292,8 +292,9 @@ namespace hetcompute
                 // get the arena
                 auto acquired_arena = bas.find_acquired_arena(b);
 
-                auto ion_ptr = arena_storage_accessor::access_ion_arena_for_dsptask(acquired_arena);
-                return static_cast<element_type*>(ion_ptr);
+                // a slice starts at its offset into the buffer's ion arena
+                auto ion_ptr = static_cast<char*>(arena_storage_accessor::access_ion_arena_for_dsptask(acquired_arena));
+                return reinterpret_cast<element_type*>(ion_ptr + buffer_accessor::get_byte_range(b).first);
             }
 
             template <typename T>
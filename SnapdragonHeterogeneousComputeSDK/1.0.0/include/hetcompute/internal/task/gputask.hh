@@ -174,6 +174,23 @@ namespace hetcompute
             struct cl_arg_api_buffer_setter
             {
 #ifdef HETCOMPUTE_HAVE_OPENCL
+                // sets the cl arena of b, or of the slice b, as argument i of the kernel
+                template <typename BufferPtr>
+                static void set_cl_buffer_arg(internal::clkernel* kernel, size_t i, BufferPtr& b, arena* acquired_arena)
+                {
+                    auto& ocl_buffer = arena_storage_accessor::access_cl_arena_for_gputask(acquired_arena);
+                    auto  range      = buffer_accessor::get_byte_range(b);
+                    if (range.first == 0)
+                    {
+                        // a prefix of the buffer: the kernel only indexes the elements of the slice
+                        kernel->set_arg(i, ocl_buffer);
+                    }
+                    else
+                    {
+                        kernel->set_arg_sub_buffer(i, ocl_buffer, range.first, range.second - range.first);
+                    }
+                }
+
                 template <typename BufferPtr, typename BufferAcquireSet>
                 static void set(::hetcompute::internal::legacy::device_ptr const& device,
                                 internal::clkernel*                               kernel,
@@ -196,8 +213,7 @@ namespace hetcompute
                     auto svm_ptr = arena_storage_accessor::access_cl2_arena_for_gputask(acquired_arena);
                     kernel->set_arg_svm(i, svm_ptr);
 #else
-                    auto ocl_buffer = arena_storage_accessor::access_cl_arena_for_gputask(acquired_arena);
-                    kernel->set_arg(i, ocl_buffer);
+                    set_cl_buffer_arg(kernel, i, b, acquired_arena);
 #endif /// HETCOMPUTE_CL_TO_CL2
                 }
 #endif // HETCOMPUTE_HAVE_OPENCL
@@ -247,8 +263,7 @@ namespace hetcompute
                     auto svm_ptr = arena_storage_accessor::access_cl2_arena_for_gputask(acquired_arena);
                     kernel->set_arg_svm(i, svm_ptr);
 #else
-                    auto ocl_buffer = arena_storage_accessor::access_cl_arena_for_gputask(acquired_arena);
-                    kernel->set_arg(i, ocl_buffer);
+                    set_cl_buffer_arg(kernel, i, b, acquired_arena);
 #endif // HETCOMPUTE_CL_TO_CL2
                 }
 #endif // HETCOMPUTE_HAVE_OPENCL
@@ -296,8 +311,7 @@ namespace hetcompute
                     auto svm_ptr = arena_storage_accessor::access_cl2_arena_for_gputask(acquired_arena);
                     kernel->set_arg_svm(i, svm_ptr);
 #else
-                    auto ocl_buffer = arena_storage_accessor::access_cl_arena_for_gputask(acquired_arena);
-                    kernel->set_arg(i, ocl_buffer);
+                    set_cl_buffer_arg(kernel, i, b, acquired_arena);
 #endif // HETCOMPUTE_CL_TO_CL2
                 }
 #endif // HETCOMPUTE_HAVE_OPENCL
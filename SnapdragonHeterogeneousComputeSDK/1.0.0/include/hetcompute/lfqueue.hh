@@ -55,6 +55,19 @@ namespace hetcompute
             return (_c.pop(r) != 0 ? true : false);
         }
 
+        /** Returns the number of bytes currently taken by the queue.
+         *
+         *  The queue grows by linking new nodes when the existing ones are full. Nodes are
+         *  freed once they have been drained and no concurrent operation can access them anymore,
+         *  so the footprint follows the number of elements in the queue rather than its history.
+         *
+         *  @return Number of bytes taken by the queue and its nodes.
+         */
+        size_t memory_footprint() const
+        {
+            return _c.memory_footprint();
+        }
+
     private:
         container_type _c;
     };
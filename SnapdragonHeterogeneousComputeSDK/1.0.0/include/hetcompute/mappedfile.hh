@@ -0,0 +1,765 @@
+/** @file mappedfile.hh */
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <hetcompute/buffer.hh>
+#include <hetcompute/devicetypes.hh>
+#include <hetcompute/exceptions.hh>
+#include <hetcompute/internal/util/macros.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        namespace io
+        {
+            /// Owns a file descriptor, closes it on destruction.
+            class file_descriptor
+            {
+                int _fd;
+
+            public:
+                explicit file_descriptor(int fd) : _fd(fd)
+                {
+                }
+
+                file_descriptor(file_descriptor&& other) : _fd(other._fd)
+                {
+                    other._fd = -1;
+                }
+
+                ~file_descriptor()
+                {
+                    if (_fd >= 0)
+                    {
+                        ::close(_fd);
+                    }
+                }
+
+                int get() const
+                {
+                    return _fd;
+                }
+
+                HETCOMPUTE_DELETE_METHOD(file_descriptor(file_descriptor const&));
+                HETCOMPUTE_DELETE_METHOD(file_descriptor& operator=(file_descriptor const&));
+                HETCOMPUTE_DELETE_METHOD(file_descriptor& operator=(file_descriptor&&));
+            }; // end of class file_descriptor
+
+            inline file_descriptor open_file(std::string const& path, int flags)
+            {
+                file_descriptor fd(::open(path.c_str(), flags | O_CLOEXEC, 0644));
+                HETCOMPUTE_API_THROW(fd.get() >= 0, "Could not open %s: %s", path.c_str(), strerror(errno));
+                return fd;
+            }
+
+            inline size_t file_size(int fd)
+            {
+                struct stat st;
+                HETCOMPUTE_API_THROW(::fstat(fd, &st) == 0, "Could not stat file: %s", strerror(errno));
+                return static_cast<size_t>(st.st_size);
+            }
+
+            inline size_t page_size()
+            {
+                static size_t const s_page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+                return s_page_size;
+            }
+        }; // namespace io
+    };     // namespace internal
+
+    namespace io
+    {
+        /** @addtogroup mappedfile_doc
+            @{ */
+
+        /**
+         * Access requested to a mapped file.
+         */
+        enum class map_mode
+        {
+            /** Pages are mapped read-only. */
+            read_only,
+            /** Pages are mapped shared and writable: stores reach the file. */
+            read_write,
+            /** Pages are mapped private and writable: stores are copied on
+                write and never reach the file. */
+            copy_on_write
+        };
+
+        /**
+         * @brief A memory mapping of a file, or of a window of a file.
+         *
+         * The mapping is unmapped when the object is destroyed. Mapped
+         * files are movable but not copyable.
+         *
+         * The pointer returned by <code>data()</code> may be handed to
+         * <code>hetcompute::create_buffer(T* preallocated_ptr, ...)</code>,
+         * which then uses the mapping as the host storage of the buffer
+         * instead of copying into its own. The mapped_file must outlive
+         * every <code>buffer_ptr</code> created that way.
+         */
+        class mapped_file
+        {
+        public:
+            /** Creates an empty mapping. */
+            mapped_file() : _base(nullptr), _base_size(0), _skew(0), _size(0), _writable(false)
+            {
+            }
+
+            /**
+             * Maps bytes <code>[offset, offset + length)</code> of an existing file.
+             *
+             * @param path   file to map.
+             * @param mode   read-only, shared writable or copy-on-write mapping.
+             * @param offset first byte to map, need not be page-aligned.
+             * @param length number of bytes to map, 0 to map to the end of the file.
+             *
+             * @throws api_exception if the file cannot be opened or mapped, or
+             *         the window is empty or past the end of the file.
+             */
+            explicit mapped_file(std::string const& path, map_mode mode = map_mode::read_only, size_t offset = 0, size_t length = 0)
+                : mapped_file()
+            {
+                auto fd = internal::io::open_file(path, mode == map_mode::read_write ? O_RDWR : O_RDONLY);
+                map(fd.get(), mode, offset, length);
+            }
+
+            /**
+             * Creates a file of <code>size</code> bytes, replacing any existing
+             * one, and maps all of it writable. The contents start zeroed, and
+             * the blocks are only allocated as they are written.
+             *
+             * @throws api_exception if the file cannot be created or mapped.
+             */
+            static mapped_file create(std::string const& path, size_t size)
+            {
+                auto fd = internal::io::open_file(path, O_RDWR | O_CREAT | O_TRUNC);
+                HETCOMPUTE_API_THROW(::ftruncate(fd.get(), static_cast<off_t>(size)) == 0,
+                                     "Could not resize %s to %zu bytes: %s",
+                                     path.c_str(),
+                                     size,
+                                     strerror(errno));
+                mapped_file mf;
+                mf.map(fd.get(), map_mode::read_write, 0, size);
+                return mf;
+            }
+
+            mapped_file(mapped_file&& other)
+                : _base(other._base), _base_size(other._base_size), _skew(other._skew), _size(other._size), _writable(other._writable)
+            {
+                other.reset();
+            }
+
+            mapped_file& operator=(mapped_file&& other)
+            {
+                if (this != &other)
+                {
+                    unmap();
+                    _base      = other._base;
+                    _base_size = other._base_size;
+                    _skew      = other._skew;
+                    _size      = other._size;
+                    _writable  = other._writable;
+                    other.reset();
+                }
+                return *this;
+            }
+
+            ~mapped_file()
+            {
+                unmap();
+            }
+
+            /** Returns the first mapped byte, the one at the requested offset. */
+            void* data() const
+            {
+                return _base == nullptr ? nullptr : static_cast<char*>(_base) + _skew;
+            }
+
+            /** Returns the number of mapped bytes from <code>data()</code>. */
+            size_t size() const
+            {
+                return _size;
+            }
+
+            bool writable() const
+            {
+                return _writable;
+            }
+
+            bool is_null() const
+            {
+                return _base == nullptr;
+            }
+
+            /**
+             * Writes the dirty pages back to the file.
+             *
+             * @param wait if false, only schedules the write-back.
+             */
+            void flush(bool wait = true) const
+            {
+                if (_base != nullptr && _writable)
+                {
+                    HETCOMPUTE_API_THROW(::msync(_base, _base_size, wait ? MS_SYNC : MS_ASYNC) == 0,
+                                         "Could not write back mapping: %s",
+                                         strerror(errno));
+                }
+            }
+
+            /**
+             * Tells the kernel the mapping will be read in order, so that it
+             * reads ahead aggressively and frees pages behind the reader.
+             */
+            void advise_sequential() const
+            {
+                if (_base != nullptr)
+                {
+                    ::madvise(_base, _base_size, MADV_SEQUENTIAL);
+                }
+            }
+
+            HETCOMPUTE_DELETE_METHOD(mapped_file(mapped_file const&));
+            HETCOMPUTE_DELETE_METHOD(mapped_file& operator=(mapped_file const&));
+
+        private:
+            friend class image_tile_stream;
+
+            // Maps a window of an open file. mmap offsets must be page-aligned,
+            // so the mapping starts _skew bytes before the requested offset.
+            void map(int fd, map_mode mode, size_t offset, size_t length)
+            {
+                auto file_size = internal::io::file_size(fd);
+                HETCOMPUTE_API_THROW(offset < file_size, "Cannot map offset %zu of a file of %zu bytes", offset, file_size);
+                if (length == 0)
+                {
+                    length = file_size - offset;
+                }
+                HETCOMPUTE_API_THROW(length <= file_size - offset,
+                                     "Cannot map %zu bytes at offset %zu of a file of %zu bytes",
+                                     length,
+                                     offset,
+                                     file_size);
+
+                auto aligned_offset = offset - offset % internal::io::page_size();
+                auto skew           = offset - aligned_offset;
+                int  prot           = mode == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+                int  flags          = mode == map_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+                auto base           = ::mmap(nullptr, length + skew, prot, flags, fd, static_cast<off_t>(aligned_offset));
+                HETCOMPUTE_API_THROW(base != MAP_FAILED, "Could not map %zu bytes: %s", length, strerror(errno));
+
+                _base      = base;
+                _base_size = length + skew;
+                _skew      = skew;
+                _size      = length;
+                _writable  = mode == map_mode::read_write;
+            }
+
+            void unmap()
+            {
+                if (_base != nullptr)
+                {
+                    ::munmap(_base, _base_size);
+                    reset();
+                }
+            }
+
+            void reset()
+            {
+                _base      = nullptr;
+                _base_size = 0;
+                _skew      = 0;
+                _size      = 0;
+                _writable  = false;
+            }
+
+            void*  _base;
+            size_t _base_size;
+            size_t _skew;
+            size_t _size;
+            bool   _writable;
+        }; // end of class mapped_file
+
+        /**
+         * Maps a file of raw elements of type <code>T</code>, such as a
+         * tensor dumped from memory, and wraps it in a buffer.
+         *
+         * @param path      file to map.
+         * @param mf        receives the mapping, which must outlive the buffer.
+         * @param num_elems number of elements, 0 for as many as the file holds.
+         * @param offset    byte offset of the first element, e.g. the size of a
+         *                  header. Must be a multiple of <code>alignof(T)</code>.
+         * @param mode      <code>map_mode::read_write</code> for data written to
+         *                  the buffer on the host to reach the file. Buffers are
+         *                  writable, so <code>map_mode::read_only</code> maps
+         *                  the file copy-on-write, like
+         *                  <code>map_mode::copy_on_write</code>: the file is
+         *                  only read, and written pages stay in memory.
+         * @param likely_devices <em>Optional</em>, see <code>hetcompute::create_buffer</code>.
+         *
+         * @return a buffer whose host storage is the mapping.
+         *
+         * @throws api_exception if the file cannot be mapped, or is too small
+         *         or misaligned for the elements.
+         */
+        template <typename T>
+        buffer_ptr<T> map_buffer(std::string const& path,
+                                 mapped_file&       mf,
+                                 size_t             num_elems      = 0,
+                                 size_t             offset         = 0,
+                                 map_mode           mode           = map_mode::read_only,
+                                 device_set const&  likely_devices = device_set())
+        {
+            HETCOMPUTE_API_THROW(offset % alignof(T) == 0, "Offset %zu is not aligned for the element type", offset);
+            mf = mapped_file(path, mode == map_mode::read_only ? map_mode::copy_on_write : mode, offset, num_elems * sizeof(T));
+            if (num_elems == 0)
+            {
+                num_elems = mf.size() / sizeof(T);
+            }
+            HETCOMPUTE_API_THROW(num_elems > 0, "%s holds no complete element", path.c_str());
+            return create_buffer<T>(static_cast<T*>(mf.data()), num_elems, likely_devices);
+        }
+
+        /**
+         * Image file formats understood by <code>mapped_image</code>.
+         */
+        enum class image_format
+        {
+            /** Uncompressed TGA, gray (type 3) or true-color (type 2). */
+            tga,
+            /** Binary PGM (P5). 16-bit samples are big-endian. */
+            pgm
+        };
+
+        /**
+         * Geometry of an image file.
+         */
+        struct image_info
+        {
+            image_format format;
+            /** Width in pixels. */
+            size_t width;
+            /** Height in pixels. */
+            size_t height;
+            /** Bytes per pixel: 1 for 8-bit gray. */
+            size_t bytes_per_pixel;
+            /** Offset of the first pixel in the file, i.e. the header size. */
+            size_t data_offset;
+
+            size_t row_bytes() const
+            {
+                return width * bytes_per_pixel;
+            }
+
+            size_t data_bytes() const
+            {
+                return row_bytes() * height;
+            }
+        };
+
+        /**
+         * Reads the header of a TGA or PGM file. Rows are left in file order:
+         * a TGA with the default origin stores the bottom row first.
+         *
+         * @throws api_exception if the file cannot be read, or is not an
+         *         uncompressed TGA or a binary PGM, or is truncated.
+         */
+        inline image_info read_image_info(std::string const& path);
+
+        /**
+         * @brief A TGA or PGM image file mapped into memory.
+         *
+         * <code>pixels()</code> points into the mapping, so loading an image
+         * costs the page faults of the pixels the program touches, rather than
+         * a read into a heap copy. <code>create_buffer()</code> hands the
+         * pixels to the runtime the same way.
+         */
+        class mapped_image
+        {
+        public:
+            mapped_image() : _info(), _file()
+            {
+            }
+
+            /**
+             * Maps an existing image.
+             *
+             * @param mode <code>map_mode::read_write</code> to modify the image in place.
+             *             The pixels are writable either way: with
+             *             <code>map_mode::read_only</code> they are mapped
+             *             copy-on-write, so stores never reach the file.
+             */
+            explicit mapped_image(std::string const& path, map_mode mode = map_mode::read_only)
+                : _info(read_image_info(path)),
+                  _file(path, mode == map_mode::read_only ? map_mode::copy_on_write : mode, _info.data_offset, _info.data_bytes())
+            {
+            }
+
+            /**
+             * Creates an image file with the geometry of <code>info</code>,
+             * replacing any existing one, and maps its pixels writable. Pixels
+             * stored through <code>pixels()</code> or a buffer created by
+             * <code>create_buffer()</code> on the host are written back to
+             * the file.
+             *
+             * @param info format, width, height and bytes_per_pixel of the
+             *             image. data_offset is ignored.
+             */
+            static mapped_image create(std::string const& path, image_info const& info);
+
+            mapped_image(mapped_image&&) = default;
+            mapped_image& operator=(mapped_image&&) = default;
+
+            image_info const& info() const
+            {
+                return _info;
+            }
+
+            size_t width() const
+            {
+                return _info.width;
+            }
+
+            size_t height() const
+            {
+                return _info.height;
+            }
+
+            /** Returns the first pixel, in file row order. */
+            unsigned char* pixels() const
+            {
+                return static_cast<unsigned char*>(_file.data());
+            }
+
+            /** Returns the number of bytes of pixel data. */
+            size_t size() const
+            {
+                return _file.size();
+            }
+
+            /**
+             * Wraps the pixels in a buffer without copying them. The image
+             * must outlive the buffer.
+             *
+             * After a device wrote the buffer, acquire it on the host (for
+             * instance with <code>acquire_ro()</code>) before
+             * <code>flush()</code>, so that the runtime copies the results
+             * back into the mapping.
+             *
+             * @tparam T pixel type, <code>unsigned char</code> or
+             *           <code>char</code> for 8-bit gray.
+             */
+            template <typename T = unsigned char>
+            buffer_ptr<T> create_buffer(device_set const& likely_devices = device_set()) const
+            {
+                static_assert(sizeof(T) == 1 || alignof(T) == 1, "Image pixels are only byte-aligned");
+                HETCOMPUTE_API_THROW(_info.bytes_per_pixel % sizeof(T) == 0, "Pixel type does not divide the pixel size");
+                return ::hetcompute::create_buffer<T>(reinterpret_cast<T*>(pixels()), size() / sizeof(T), likely_devices);
+            }
+
+            /** Writes the pixels back to the file, see <code>mapped_file::flush()</code>. */
+            void flush(bool wait = true) const
+            {
+                _file.flush(wait);
+            }
+
+            HETCOMPUTE_DELETE_METHOD(mapped_image(mapped_image const&));
+            HETCOMPUTE_DELETE_METHOD(mapped_image& operator=(mapped_image const&));
+
+        private:
+            image_info  _info;
+            mapped_file _file;
+        }; // end of class mapped_image
+
+        /**
+         * One band of rows of an image streamed by <code>image_tile_stream</code>.
+         */
+        struct image_tile
+        {
+            /** Rows [first_row, last_row) are the ones to produce. */
+            size_t first_row;
+            size_t last_row;
+            /** Rows [first_input_row, last_input_row) of the input are mapped:
+                the tile plus up to halo_rows rows on each side. */
+            size_t first_input_row;
+            size_t last_input_row;
+            /** Geometry of the input image. */
+            image_info const* info;
+            /** Row first_input_row of the input. */
+            unsigned char const* input;
+            /** Row first_row of the output, nullptr without an output file. */
+            unsigned char* output;
+
+            unsigned char const* input_row(size_t y) const
+            {
+                return input + (y - first_input_row) * info->row_bytes();
+            }
+
+            unsigned char* output_row(size_t y) const
+            {
+                return output + (y - first_row) * info->row_bytes();
+            }
+        };
+
+        /**
+         * @brief Streams an image through memory in bands of rows.
+         *
+         * Maps one tile of the input, plus a halo of rows on each side for
+         * stencils, and the matching rows of the output at a time. The next
+         * tile is read ahead while the current one is processed, and the
+         * pages of the finished tiles are dropped, so that images larger
+         * than RAM can be processed with a bounded memory footprint.
+         *
+         * @code
+         * hetcompute::io::image_tile_stream stream("in.tga", "out.tga", 256, 3);
+         * stream.for_each([](hetcompute::io::image_tile const& tile) {
+         *     hetcompute::pfor_each(tile.first_row, tile.last_row, [&tile](size_t y) { ... });
+         * });
+         * @endcode
+         */
+        class image_tile_stream
+        {
+        public:
+            /**
+             * @param input_path    TGA or PGM image to read.
+             * @param output_path   image to create with the geometry of the
+             *                      input, or empty to only read.
+             * @param rows_per_tile number of rows produced per tile, > 0.
+             * @param halo_rows     number of extra input rows mapped above and
+             *                      below each tile.
+             */
+            image_tile_stream(std::string const& input_path, std::string const& output_path, size_t rows_per_tile, size_t halo_rows = 0)
+                : _info(read_image_info(input_path)),
+                  _input(internal::io::open_file(input_path, O_RDONLY)),
+                  _output(output_path.empty() ? internal::io::file_descriptor(-1) : create_output(output_path, input_path, _info)),
+                  _rows_per_tile(rows_per_tile),
+                  _halo_rows(halo_rows)
+            {
+                HETCOMPUTE_API_THROW(rows_per_tile > 0, "rows_per_tile must be > 0");
+            }
+
+            image_info const& info() const
+            {
+                return _info;
+            }
+
+            /**
+             * Invokes <code>fn(image_tile const&)</code> on each tile, from
+             * the first row of the file to the last. The tile mappings are
+             * only valid during the call.
+             */
+            template <typename Fn>
+            void for_each(Fn&& fn)
+            {
+                auto row_bytes = _info.row_bytes();
+                for (size_t first = 0; first < _info.height; first += _rows_per_tile)
+                {
+                    image_tile tile;
+                    tile.first_row       = first;
+                    tile.last_row        = std::min(first + _rows_per_tile, _info.height);
+                    tile.first_input_row = first - std::min(first, _halo_rows);
+                    tile.last_input_row  = std::min(tile.last_row + _halo_rows, _info.height);
+                    tile.info            = &_info;
+
+                    mapped_file in;
+                    in.map(_input.get(),
+                           map_mode::read_only,
+                           _info.data_offset + tile.first_input_row * row_bytes,
+                           (tile.last_input_row - tile.first_input_row) * row_bytes);
+                    in.advise_sequential();
+                    tile.input = static_cast<unsigned char const*>(in.data());
+
+                    // read the next tile ahead while this one is processed
+                    if (tile.last_row < _info.height)
+                    {
+                        auto next_last = std::min(tile.last_row + _rows_per_tile + _halo_rows, _info.height);
+                        ::posix_fadvise(_input.get(),
+                                        static_cast<off_t>(_info.data_offset + tile.last_input_row * row_bytes),
+                                        static_cast<off_t>((std::max(next_last, tile.last_input_row) - tile.last_input_row) * row_bytes),
+                                        POSIX_FADV_WILLNEED);
+                    }
+
+                    mapped_file out;
+                    tile.output = nullptr;
+                    if (_output.get() >= 0)
+                    {
+                        out.map(_output.get(),
+                                map_mode::read_write,
+                                _info.data_offset + tile.first_row * row_bytes,
+                                (tile.last_row - tile.first_row) * row_bytes);
+                        tile.output = static_cast<unsigned char*>(out.data());
+                    }
+
+                    fn(static_cast<image_tile const&>(tile));
+
+                    // start writing the tile back, and drop the input rows no later tile needs
+                    out.flush(false);
+                    auto next_first_input = tile.last_row - std::min(tile.last_row, _halo_rows);
+                    ::posix_fadvise(_input.get(),
+                                    static_cast<off_t>(_info.data_offset + tile.first_input_row * row_bytes),
+                                    static_cast<off_t>((next_first_input - tile.first_input_row) * row_bytes),
+                                    POSIX_FADV_DONTNEED);
+                }
+            }
+
+            HETCOMPUTE_DELETE_METHOD(image_tile_stream(image_tile_stream const&));
+            HETCOMPUTE_DELETE_METHOD(image_tile_stream& operator=(image_tile_stream const&));
+
+        private:
+            // Creates the output file with the header of the input and the size of the image.
+            static internal::io::file_descriptor create_output(std::string const& output_path, std::string const& input_path, image_info const& info)
+            {
+                auto out = internal::io::open_file(output_path, O_RDWR | O_CREAT | O_TRUNC);
+                auto in  = internal::io::open_file(input_path, O_RDONLY);
+
+                std::string header(info.data_offset, '\0');
+                HETCOMPUTE_API_THROW(::pread(in.get(), &header[0], header.size(), 0) == static_cast<ssize_t>(header.size()) &&
+                                         ::pwrite(out.get(), header.data(), header.size(), 0) == static_cast<ssize_t>(header.size()),
+                                     "Could not copy the image header to %s",
+                                     output_path.c_str());
+                HETCOMPUTE_API_THROW(::ftruncate(out.get(), static_cast<off_t>(info.data_offset + info.data_bytes())) == 0,
+                                     "Could not resize %s: %s",
+                                     output_path.c_str(),
+                                     strerror(errno));
+                return out;
+            }
+
+            image_info                    _info;
+            internal::io::file_descriptor _input;
+            internal::io::file_descriptor _output;
+            size_t                        _rows_per_tile;
+            size_t                        _halo_rows;
+        }; // end of class image_tile_stream
+
+        /** @} */ /* end_addtogroup mappedfile_doc */
+
+        inline image_info read_image_info(std::string const& path)
+        {
+            auto fd   = internal::io::open_file(path, O_RDONLY);
+            auto size = internal::io::file_size(fd.get());
+
+            // Large enough for a TGA header, or a PGM header with a few comment lines.
+            unsigned char header[512];
+            auto          n = ::pread(fd.get(), header, sizeof(header), 0);
+            HETCOMPUTE_API_THROW(n >= 2, "Could not read the header of %s", path.c_str());
+            auto len = static_cast<size_t>(n);
+
+            image_info info;
+            if (header[0] == 'P' && header[1] == '5')
+            {
+                // P5 <whitespace> width <whitespace> height <whitespace> maxval <one whitespace> pixels
+                size_t fields[3];
+                size_t pos = 2;
+                for (auto& field : fields)
+                {
+                    while (pos < len && (isspace(header[pos]) || header[pos] == '#'))
+                    {
+                        if (header[pos] == '#')
+                        {
+                            while (pos < len && header[pos] != '\n')
+                            {
+                                pos++;
+                            }
+                        }
+                        else
+                        {
+                            pos++;
+                        }
+                    }
+                    HETCOMPUTE_API_THROW(pos < len && isdigit(header[pos]), "Malformed PGM header in %s", path.c_str());
+                    field = 0;
+                    while (pos < len && isdigit(header[pos]))
+                    {
+                        field = field * 10 + (header[pos++] - '0');
+                    }
+                }
+                HETCOMPUTE_API_THROW(pos < len && isspace(header[pos]) && fields[2] > 0 && fields[2] < 65536,
+                                     "Malformed PGM header in %s",
+                                     path.c_str());
+
+                info.format          = image_format::pgm;
+                info.width           = fields[0];
+                info.height          = fields[1];
+                info.bytes_per_pixel = fields[2] < 256 ? 1 : 2;
+                info.data_offset     = pos + 1;
+            }
+            else
+            {
+                HETCOMPUTE_API_THROW(len >= 18, "%s is too short for a TGA header", path.c_str());
+                auto image_type = header[2];
+                HETCOMPUTE_API_THROW(image_type == 2 || image_type == 3,
+                                     "%s: only uncompressed TGA images are supported, found image type %d",
+                                     path.c_str(),
+                                     int(image_type));
+                HETCOMPUTE_API_THROW(header[16] % 8 == 0 && header[16] > 0, "%s: unsupported pixel depth %d", path.c_str(), int(header[16]));
+
+                size_t cmap_bytes = header[1] != 0 ? (header[5] | (header[6] << 8)) * ((header[7] + 7) / 8) : 0;
+
+                info.format          = image_format::tga;
+                info.width           = header[12] | (header[13] << 8);
+                info.height          = header[14] | (header[15] << 8);
+                info.bytes_per_pixel = header[16] / 8;
+                info.data_offset     = 18 + header[0] + cmap_bytes;
+            }
+
+            HETCOMPUTE_API_THROW(info.width > 0 && info.height > 0 && info.data_offset + info.data_bytes() <= size,
+                                 "%s is truncated: %zux%zu pixels need %zu bytes, the file has %zu",
+                                 path.c_str(),
+                                 info.width,
+                                 info.height,
+                                 info.data_offset + info.data_bytes(),
+                                 size);
+            return info;
+        }
+
+        inline mapped_image mapped_image::create(std::string const& path, image_info const& info)
+        {
+            HETCOMPUTE_API_THROW(info.width > 0 && info.height > 0 && info.bytes_per_pixel > 0, "Image must not be empty");
+
+            std::string header;
+            if (info.format == image_format::pgm)
+            {
+                HETCOMPUTE_API_THROW(info.bytes_per_pixel <= 2, "PGM images have 1 or 2 bytes per pixel");
+                char text[64];
+                snprintf(text, sizeof(text), "P5\n%zu %zu\n%d\n", info.width, info.height, info.bytes_per_pixel == 1 ? 255 : 65535);
+                header = text;
+            }
+            else
+            {
+                HETCOMPUTE_API_THROW(info.width < 65536 && info.height < 65536 && info.bytes_per_pixel <= 4,
+                                     "Image too large for a TGA file");
+                header.assign(18, '\0');
+                header[2]  = static_cast<char>(info.bytes_per_pixel == 1 ? 3 : 2);
+                header[12] = static_cast<char>(info.width & 0xff);
+                header[13] = static_cast<char>(info.width >> 8);
+                header[14] = static_cast<char>(info.height & 0xff);
+                header[15] = static_cast<char>(info.height >> 8);
+                header[16] = static_cast<char>(info.bytes_per_pixel * 8);
+            }
+
+            mapped_image image;
+            image._info             = info;
+            image._info.data_offset = header.size();
+            {
+                auto header_file = mapped_file::create(path, header.size() + info.data_bytes());
+                memcpy(header_file.data(), header.data(), header.size());
+            }
+            image._file = mapped_file(path, map_mode::read_write, header.size(), info.data_bytes());
+            return image;
+        }
+
+    }; // namespace io
+};     // namespace hetcompute
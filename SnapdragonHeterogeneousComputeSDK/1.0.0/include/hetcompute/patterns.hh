@@ -3,6 +3,7 @@
 
 #include <hetcompute/pdivide_and_conquer.hh>
 #include <hetcompute/pfor_each.hh>
+#include <hetcompute/pgemm.hh>
 #include <hetcompute/pipeline.hh>
 #include <hetcompute/preduce.hh>
 #include <hetcompute/pscan.hh>
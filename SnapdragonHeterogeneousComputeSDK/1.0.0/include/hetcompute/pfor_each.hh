@@ -79,6 +79,15 @@ namespace hetcompute
             // return absolute exec time (in microsec) of dsp task
             uint64_t get_dsp_task_time() const { return _dsp_task_time; }
 
+            // return work done by the cpu in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_cpu_chunk_stats() const { return _cpu_chunk_stats; }
+
+            // return work done by the gpu in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_gpu_chunk_stats() const { return _gpu_chunk_stats; }
+
+            // return work done by the dsp in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_dsp_chunk_stats() const { return _dsp_chunk_stats; }
+
 #ifndef _MSC_VER
             // MSVC is not friend with friends, so we make the data members public
         private:
@@ -97,14 +106,17 @@ namespace hetcompute
         public:
 #endif // _MSC_VER
 
-            T1       _ktpl;
-            T2       _atpl;
-            double   _gpu_profile;
-            double   _dsp_profile;
-            uint64_t _cpu_task_time;
-            uint64_t _gpu_task_time;
-            uint64_t _dsp_task_time;
-            size_t   _num_runs;
+            T1          _ktpl;
+            T2          _atpl;
+            double      _gpu_profile;
+            double      _dsp_profile;
+            uint64_t    _cpu_task_time;
+            uint64_t    _gpu_task_time;
+            uint64_t    _dsp_task_time;
+            chunk_stats _cpu_chunk_stats;
+            chunk_stats _gpu_chunk_stats;
+            chunk_stats _dsp_chunk_stats;
+            size_t      _num_runs;
 
             pfor(T1&& ktpl, T2&& atpl)
                 : _ktpl(ktpl),
@@ -114,6 +126,9 @@ namespace hetcompute
                   _cpu_task_time(0),
                   _gpu_task_time(0),
                   _dsp_task_time(0),
+                  _cpu_chunk_stats(),
+                  _gpu_chunk_stats(),
+                  _dsp_chunk_stats(),
                   _num_runs(0)
             {
             }
@@ -135,6 +150,14 @@ namespace hetcompute
             // @param absolute exec time for dsp task in microsec
             void set_dsp_task_time(uint64_t ht) { _dsp_task_time = ht; }
 
+            // @param work done by each device in a run with tuner::set_dynamic_hetero()
+            void set_chunk_stats(chunk_stats const& cs, chunk_stats const& gs, chunk_stats const& ds)
+            {
+                _cpu_chunk_stats = cs;
+                _gpu_chunk_stats = gs;
+                _dsp_chunk_stats = ds;
+            }
+
             // update number of runs
             void add_run() { _num_runs++; }
         };
@@ -177,6 +200,15 @@ namespace hetcompute
             // return absolute exec time (in microsec) of dsp task
             uint64_t get_dsp_task_time() const { return _dsp_task_time; }
 
+            // return work done by the cpu in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_cpu_chunk_stats() const { return _cpu_chunk_stats; }
+
+            // return work done by the gpu in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_gpu_chunk_stats() const { return _gpu_chunk_stats; }
+
+            // return work done by the dsp in the last run with tuner::set_dynamic_hetero()
+            chunk_stats get_dsp_chunk_stats() const { return _dsp_chunk_stats; }
+
 #ifndef _MSC_VER
             // As noted by @hanzhao, MSVC does not like friends, so we make the data members public
         private:
@@ -203,6 +235,9 @@ namespace hetcompute
             uint64_t          _cpu_task_time;
             uint64_t          _gpu_task_time;
             uint64_t          _dsp_task_time;
+            chunk_stats       _cpu_chunk_stats;
+            chunk_stats       _gpu_chunk_stats;
+            chunk_stats       _dsp_chunk_stats;
             size_t            _num_runs;
 
             pfor(pointkernel_type& pk, T2&& atpl)
@@ -213,6 +248,9 @@ namespace hetcompute
                   _cpu_task_time(0),
                   _gpu_task_time(0),
                   _dsp_task_time(0),
+                  _cpu_chunk_stats(),
+                  _gpu_chunk_stats(),
+                  _dsp_chunk_stats(),
                   _num_runs(0)
             {
             }
@@ -234,6 +272,14 @@ namespace hetcompute
             // @param absolute exec time for dsp task in microsec
             void set_dsp_task_time(uint64_t ht) { _dsp_task_time = ht; }
 
+            // @param work done by each device in a run with tuner::set_dynamic_hetero()
+            void set_chunk_stats(chunk_stats const& cs, chunk_stats const& gs, chunk_stats const& ds)
+            {
+                _cpu_chunk_stats = cs;
+                _gpu_chunk_stats = gs;
+                _dsp_chunk_stats = ds;
+            }
+
             // update number of runs
             void add_run() { _num_runs++; }
         };
@@ -0,0 +1,157 @@
+/** @file pgemm.hh */
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+#include <hetcompute/exceptions.hh>
+#include <hetcompute/gemm.h>
+#include <hetcompute/index.hh>
+#include <hetcompute/pfor_each.hh>
+#include <hetcompute/range.hh>
+#include <hetcompute/tuner.hh>
+#include <hetcompute/internal/util/memorder.hh>
+
+namespace hetcompute
+{
+    namespace internal
+    {
+        /**
+         * Runs a C GEMM kernel over the blocks of C in parallel. Each pfor_each
+         * iteration computes one cache block of HETCOMPUTE_GEMM_MC rows and
+         * HETCOMPUTE_GEMM_NC columns, so it packs its panel of B once.
+         */
+        template <typename T, typename Kernel>
+        void pgemm(size_t M, size_t N, size_t K, const T* a, const T* b, T* c, Kernel&& kernel, const hetcompute::pattern::tuner& t)
+        {
+            HETCOMPUTE_API_THROW(M > 0 && N > 0 && K > 0, "pgemm matrix sizes must be > 0.");
+            HETCOMPUTE_API_THROW(M <= INT_MAX / K && K <= INT_MAX / N && M <= INT_MAX / N,
+                                 "pgemm matrices must have at most INT_MAX elements.");
+
+            int m = static_cast<int>(M);
+            int n = static_cast<int>(N);
+            int k = static_cast<int>(K);
+
+            std::atomic<int>     status(0);
+            hetcompute::range<2> blocks((M + HETCOMPUTE_GEMM_MC - 1) / HETCOMPUTE_GEMM_MC, (N + HETCOMPUTE_GEMM_NC - 1) / HETCOMPUTE_GEMM_NC);
+            hetcompute::pfor_each(blocks,
+                                  [=, &kernel, &status](hetcompute::index<2> const& idx) {
+                                      int first_x = static_cast<int>(idx[0]) * HETCOMPUTE_GEMM_MC;
+                                      int first_y = static_cast<int>(idx[1]) * HETCOMPUTE_GEMM_NC;
+                                      int s       = kernel(first_x,
+                                                     first_x + HETCOMPUTE_GEMM_MC,
+                                                     first_y,
+                                                     first_y + HETCOMPUTE_GEMM_NC,
+                                                     a,
+                                                     m * k,
+                                                     b,
+                                                     k * n,
+                                                     c,
+                                                     m * n,
+                                                     m,
+                                                     n,
+                                                     k);
+                                      if (s != 0)
+                                      {
+                                          status.store(s, hetcompute::mem_order_relaxed);
+                                      }
+                                  },
+                                  t);
+
+            HETCOMPUTE_API_THROW(status.load(hetcompute::mem_order_relaxed) == 0, "pgemm could not allocate its packing buffers.");
+        }
+
+    }; // namespace internal
+
+    /** @addtogroup gemm_doc
+        @{ */
+
+    /**
+     * Parallel matrix multiplication, C = A * B on row-major float matrices,
+     * where A is M x K, B is K x N and C is M x N.
+     *
+     * Computes the blocks of C with <code>hetcompute::pfor_each</code>, each
+     * with <code>hetcompute_gemm_f32</code>, the kernel of the
+     * <code>hetcompute_dsp_gemm_f32</code> dsp kernel.
+     *
+     * @param M     rows of A and C.
+     * @param N     columns of B and C.
+     * @param K     columns of A and rows of B.
+     * @param a     matrix A.
+     * @param b     matrix B.
+     * @param c     matrix C, overwritten.
+     * @param tuner Qualcomm HetCompute pattern tuner object (optional).
+     *
+     * @throws api_exception if a size is 0, a matrix has more than INT_MAX
+     *         elements, or the packing buffers cannot be allocated.
+     */
+    inline void
+    pgemm(size_t M, size_t N, size_t K, const float* a, const float* b, float* c, const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        internal::pgemm(M, N, K, a, b, c, hetcompute_gemm_f32, tuner);
+    }
+
+    /**
+     * Parallel matrix multiplication, C = A * B on int16 fixed point matrices.
+     *
+     * Each element of C is the sum of the products, shifted right by
+     * <code>shift</code> bits with rounding, and saturated to int16.
+     *
+     * @param shift number of fractional bits to drop, e.g. 15 for Q15 matrices.
+     * @sa pgemm(size_t, size_t, size_t, const float*, const float*, float*, const hetcompute::pattern::tuner&)
+     */
+    inline void pgemm(size_t                          M,
+                      size_t                          N,
+                      size_t                          K,
+                      const int16_t*                  a,
+                      const int16_t*                  b,
+                      int16_t*                        c,
+                      int                             shift,
+                      const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        internal::pgemm(M,
+                        N,
+                        K,
+                        a,
+                        b,
+                        c,
+                        [shift](int fx, int lx, int fy, int ly, const int16_t* pa, int la, const int16_t* pb, int lb, int16_t* pc, int lc, int m, int n, int k) {
+                            return hetcompute_gemm_s16(fx, lx, fy, ly, pa, la, pb, lb, pc, lc, m, n, k, shift);
+                        },
+                        tuner);
+    }
+
+    /**
+     * Parallel matrix multiplication, C = A * B on int8 fixed point matrices.
+     *
+     * Each element of C is the sum of the products, shifted right by
+     * <code>shift</code> bits with rounding, and saturated to int8.
+     *
+     * @param shift number of fractional bits to drop, e.g. 7 for Q7 matrices.
+     * @sa pgemm(size_t, size_t, size_t, const float*, const float*, float*, const hetcompute::pattern::tuner&)
+     */
+    inline void pgemm(size_t                          M,
+                      size_t                          N,
+                      size_t                          K,
+                      const int8_t*                   a,
+                      const int8_t*                   b,
+                      int8_t*                         c,
+                      int                             shift,
+                      const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        internal::pgemm(M,
+                        N,
+                        K,
+                        a,
+                        b,
+                        c,
+                        [shift](int fx, int lx, int fy, int ly, const int8_t* pa, int la, const int8_t* pb, int lb, int8_t* pc, int lc, int m, int n, int k) {
+                            return hetcompute_gemm_s8(fx, lx, fy, ly, pa, la, pb, lb, pc, lc, m, n, k, shift);
+                        },
+                        tuner);
+    }
+
+    /** @} */ /* end_addtogroup gemm_doc */
+
+}; // namespace hetcompute
@@ -106,6 +106,12 @@ namespace hetcompute
 
             static constexpr size_t userdata_size = sizeof...(UserData);
             static_assert(userdata_size <= 1, "HetCompute pipeline can only have, at most, one type of context data.");
+
+            // stats record of the pipeline for a run with tuner t, nullptr if the run is not adaptive
+            std::shared_ptr<hetcompute::internal::pipeline_stats_record> get_stats_record(hetcompute::pattern::tuner const& t) const
+            {
+                return t.is_adaptive_pipeline() ? hetcompute::internal::pipeline_stats_table::get(c_ptr(_skeleton)) : nullptr;
+            }
             /** @endcond */
 
             /**
@@ -222,7 +228,7 @@ namespace hetcompute
              *
              * Destructor.
              */
-            virtual ~pipeline() {}
+            virtual ~pipeline() { hetcompute::internal::pipeline_stats_table::erase(c_ptr(_skeleton)); }
 
             /**
              * @brief Copy constructor.
@@ -245,6 +251,7 @@ namespace hetcompute
              */
             pipeline& operator=(pipeline const& other)
             {
+                hetcompute::internal::pipeline_stats_table::erase(c_ptr(_skeleton));
                 _skeleton = hetcompute::internal::hetcompute_shared_ptr<hetcompute::internal::pipeline_skeleton<UserData...>>(
                     new hetcompute::internal::pipeline_skeleton<UserData...>(*c_ptr(other._skeleton)));
 
@@ -258,6 +265,10 @@ namespace hetcompute
              */
             pipeline& operator=(pipeline&& other)
             {
+                if (c_ptr(_skeleton) != c_ptr(other._skeleton))
+                {
+                    hetcompute::internal::pipeline_stats_table::erase(c_ptr(_skeleton));
+                }
                 _skeleton       = other._skeleton;
                 other._skeleton = nullptr;
                 return *this;
@@ -268,12 +279,135 @@ namespace hetcompute
             /// add a stage
             ///
             template <typename... Args>
-            void add_stage(Args&&... args)
+            typename std::enable_if<!internal::pipeline_utility::check_dsp_kernel<Args...>::has_dsp_kernel, void>::type
+            add_stage(Args&&... args)
             {
                 add_cpu_stage(std::forward<Args>(args)...);
             }
+
+            template <typename... Args>
+            typename std::enable_if<internal::pipeline_utility::check_dsp_kernel<Args...>::has_dsp_kernel, void>::type
+            add_stage(Args&&... args)
+            {
+                add_dsp_stage(std::forward<Args>(args)...);
+            }
             /** @endcond     */
 
+            /**
+             * @brief Add a dsp stage.
+             *
+             * Add a dsp stage.
+             *
+             * @param args The features of the stage which should be the following:
+             *  <code>hetcompute::serial_stage</code> or <code>hetcompute::parallel_stage</code>;
+             *  <code>hetcompute::iteration_lag</code> (at most one);
+             *  <code>hetcompute::iteration_rate</code> (at most one);
+             *  <code>hetcompute::sliding_window_size</code> (at most one);
+             *  one lambda/functor/function pointer before the dsp kernel, which
+             *  takes a reference to the pipeline context (and the stage input,
+             *  unless the stage is the first one) and returns a std::tuple of a
+             *  <code>hetcompute::range</code> and the other arguments of the dsp kernel;
+             *  one dsp kernel created with <code>hetcompute::create_dsp_kernel</code>,
+             *  or a host stand-in for one created with
+             *  <code>hetcompute::create_dsp_stand_in</code>;
+             *  at most one lambda/functor/function pointer after the dsp kernel,
+             *  which takes a reference to the pipeline context and a reference to
+             *  the tuple returned by the lambda before the kernel, and returns the
+             *  output of the stage;
+             *  <code>hetcompute::pattern::tuner</code> (at most one), as for cpu stages.
+             *
+             *  The dsp kernel is passed the first and the last index of each
+             *  dimension of the range, followed by the other arguments, as for
+             *  heterogeneous pfor_each. Buffers are acquired for the dsp for the
+             *  duration of the kernel, by the stage iteration, and handed to the
+             *  dsp task, so that consecutive iterations on the same buffers do not
+             *  acquire or map them again. Each stage iteration waits for its
+             *  kernel, so lags, iteration rates and sliding windows behave as for
+             *  cpu stages.
+             *
+             * @sa template<typename... Args> void add_cpu_stage(Args&&... args)
+             */
+            template <typename... Args>
+            void add_dsp_stage(Args&&... args)
+            {
+                using check_dsp_kernel = typename hetcompute::internal::pipeline_utility::check_dsp_kernel<Args...>;
+                static_assert(check_dsp_kernel::has_dsp_kernel, "dsp stage should have a dsp kernel");
+
+                auto input_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+
+                using check_params =
+                    typename hetcompute::internal::pipeline_utility::check_add_dsp_stage_params<context&, decltype(input_tuple), Args...>;
+                static_assert(check_params::value, "add_dsp_stage has illegal parameters");
+
+                int const  stage_index         = check_params::stage_index;
+                int const  lag_index           = check_params::result::iteration_lag_index;
+                int const  rate_index          = check_params::result::iteration_rate_index;
+                int const  sws_index           = check_params::result::sliding_window_size_index;
+                int const  pattern_tuner_index = check_params::result::pattern_tuner_index;
+                bool const has_iteration_lag   = check_params::result::iteration_lag_num == 0 ? false : true;
+                using StageType                = typename check_params::StageType;
+
+                hetcompute::iteration_lag       lag(0);
+                hetcompute::iteration_rate      rate(1, 1);
+                hetcompute::sliding_window_size sws(0);
+                hetcompute::pattern::tuner      t;
+                auto                            default_tuple = std::forward_as_tuple(lag, rate, sws, t);
+
+                using stage_param_list_type = hetcompute::internal::pipeline_utility::stage_param_list_type;
+                using lag_mux               = typename hetcompute::internal::pipeline_utility::mux_param_value<hetcompute::iteration_lag,
+                                                                                                 decltype(input_tuple),
+                                                                                                 decltype(default_tuple),
+                                                                                                 lag_index,
+                                                                                                 stage_param_list_type::hetcompute_iteration_lag>;
+                using rate_mux =
+                    typename hetcompute::internal::pipeline_utility::mux_param_value<hetcompute::iteration_rate,
+                                                                                     decltype(input_tuple),
+                                                                                     decltype(default_tuple),
+                                                                                     rate_index,
+                                                                                     stage_param_list_type::hetcompute_iteration_rate>;
+                using sws_mux =
+                    typename hetcompute::internal::pipeline_utility::mux_param_value<hetcompute::sliding_window_size,
+                                                                                     decltype(input_tuple),
+                                                                                     decltype(default_tuple),
+                                                                                     sws_index,
+                                                                                     stage_param_list_type::hetcompute_sliding_window_size>;
+
+                using pattern_tuner_mux =
+                    typename hetcompute::internal::pipeline_utility::mux_param_value<hetcompute::pattern::tuner,
+                                                                                     decltype(input_tuple),
+                                                                                     decltype(default_tuple),
+                                                                                     pattern_tuner_index,
+                                                                                     stage_param_list_type::hetcompute_stage_pattern_tuner>;
+
+                const auto bbody_index = check_params::bbody_index;
+                using BeforeBody       = typename check_params::BeforeBody;
+
+                const auto abody_index = check_params::abody_index;
+                using AfterBody        = typename check_params::AfterBody;
+
+                const auto dkbody_index = check_params::dkbody_index;
+                using DKBody            = typename check_params::DKBody;
+
+                // add a dsp stage
+                c_ptr(_skeleton)
+                    ->template add_dsp_stage<StageType, BeforeBody, DKBody, AfterBody>(
+                        std::get<stage_index>(input_tuple),
+                        std::forward<BeforeBody>(
+                            hetcompute::internal::pipeline_utility::get_tuple_element_helper<bbody_index, decltype(input_tuple)>::get(
+                                input_tuple)),
+                        std::forward<DKBody>(
+                            hetcompute::internal::pipeline_utility::get_tuple_element_helper<dkbody_index, decltype(input_tuple)>::get(
+                                input_tuple)),
+                        std::forward<AfterBody>(
+                            hetcompute::internal::pipeline_utility::get_tuple_element_helper<abody_index, decltype(input_tuple)>::get(
+                                input_tuple)),
+                        has_iteration_lag,
+                        lag_mux::get(input_tuple, default_tuple),
+                        rate_mux::get(input_tuple, default_tuple),
+                        sws_mux::get(input_tuple, default_tuple),
+                        pattern_tuner_mux::get(input_tuple, default_tuple));
+            }
+
             /**
              * @brief Launch and wait for the pipeline.
              *
@@ -321,11 +455,10 @@ namespace hetcompute
                 hetcompute::internal::hetcompute_shared_ptr<hetcompute::internal::pipeline_instance<UserData...>> pinst(
                     new hetcompute::internal::pipeline_instance<UserData...>(_skeleton));
 
+                auto t1 = pattern_tuner_mux::get(input_tuple, default_tuple);
+
                 auto pipelineinst = c_ptr(pinst);
-                pipelineinst->launch(context_data...,
-                                     num_iterations,
-                                     skeleton->get_launch_type(),
-                                     pattern_tuner_mux::get(input_tuple, default_tuple));
+                pipelineinst->launch(context_data..., num_iterations, skeleton->get_launch_type(), t1, get_stats_record(t1));
 
 #ifndef HETCOMPUTE_DISABLE_EXCEPTIONS
                 try
@@ -397,10 +530,11 @@ namespace hetcompute
 
                 using launch_helper = typename hetcompute::internal::pipeline_utility::apply_launch<userdata_size + 1>;
 
-                auto ptask = hetcompute::create_task([pinst, datatp, launch_type, t1]() {
+                auto stats = get_stats_record(t1);
+                auto ptask = hetcompute::create_task([pinst, datatp, launch_type, t1, stats]() {
 
                     auto pipelineinst = c_ptr(pinst);
-                    launch_helper::apply(pipelineinst, launch_type, t1, datatp);
+                    launch_helper::apply(pipelineinst, launch_type, t1, stats, datatp);
                     pipelineinst->finish_after();
                 });
 
@@ -438,15 +572,39 @@ namespace hetcompute
 
                 auto launch_type = skeleton->get_launch_type();
 
-                auto ptask = hetcompute::create_task([pinst, launch_type, t](UserData*... context_data, size_t num_iterations) {
+                auto stats = get_stats_record(t);
+                auto ptask = hetcompute::create_task([pinst, launch_type, t, stats](UserData*... context_data, size_t num_iterations) {
                     auto pipelineinst = c_ptr(pinst);
-                    pipelineinst->launch(context_data..., num_iterations, launch_type, t);
+                    pipelineinst->launch(context_data..., num_iterations, launch_type, t, stats);
                     pipelineinst->finish_after();
                 });
 
                 return ptask;
             }
 
+            /**
+             * @brief Statistics of the stages in the last adaptive run.
+             *
+             * Statistics of the stages, in stage order, in the last run of the
+             * pipeline with <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>:
+             * the iterations executed, the measured cost of an iteration, and the
+             * chunk sizes and stage fusions chosen for it. The statistics of a run
+             * are available once the pipeline completes, e.g. when run() returns.
+             *
+             * Runs through <code>hetcompute::launch()</code> and
+             * <code>hetcompute::create_task()</code> with a
+             * <code>hetcompute::pattern::pipeline<></code> are not recorded, see
+             * <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>.
+             *
+             * @return std::vector<pipeline_stage_stats> The statistics of each
+             *         stage, empty if the pipeline never ran adaptively.
+             */
+            std::vector<pipeline_stage_stats> get_stage_stats() const
+            {
+                auto record = hetcompute::internal::pipeline_stats_table::find(c_ptr(_skeleton));
+                return record == nullptr ? std::vector<pipeline_stage_stats>() : record->get();
+            }
+
             /**
              * @brief Pipeline sanity check for stage IO types and sliding window size.
              *
@@ -513,6 +671,8 @@ namespace hetcompute
      *        @note1 if num_iterations == 0, the pipeline runs infinite number
      *               of iterations until the first stage stops the pipeline.
      * @param t One tuner object for the pipeline (optional).
+     * @note1 Defined in the runtime library; the pipeline does not adapt to
+     *        <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>.
      *
      * @return hetcompute::task_ptr<> The pointer to the task in which the pipeline is running
      *
@@ -531,6 +691,8 @@ namespace hetcompute
      *
      * @param p Reference to the pipeline object.
      * @param t One tuner object for the pipeline (optional).
+     * @note1 Defined in the runtime library; the pipeline does not adapt to
+     *        <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>.
      *
      * @return hetcompute::task_ptr<void(size_t)>
      *         The pointer to the task in which the pipeline is running.
@@ -546,6 +708,8 @@ namespace hetcompute
      * launch and wait for the pipeline
      * @param reference to the pipeline object
      * @param num_iterations the total number of iterations for the first stage
+     * @note1 Defined in the runtime library; the pipeline does not adapt to
+     *        <code>hetcompute::pattern::tuner::set_adaptive_pipeline()</code>.
      */
     void launch(const hetcompute::pattern::pipeline<>& p, size_t num_iterations, const hetcompute::pattern::tuner& t = hetcompute::pattern::tuner());
 
@@ -840,18 +1004,19 @@ namespace hetcompute
                 }
 
                 /**
-                 * @brief Add a CPU stage
+                 * @brief Add a CPU or DSP stage
                  *
-                 * Add a CPU stage.
+                 * Add a CPU stage, or a DSP stage if args include a dsp kernel.
                  *
-                 * @param args The features of the cpu stage.
+                 * @param args The features of the cpu or dsp stage.
                  * @sa template<typename... Args> void add_cpu_stage(Args&&... args)
+                 * @sa template<typename... Args> void add_dsp_stage(Args&&... args)
                  */
                 template <typename... Args>
                 typename std::enable_if<!internal::pipeline_utility::check_gpu_kernel<Args...>::has_gpu_kernel, void>::type
                 add_stage(Args&&... args)
                 {
-                    parent_type::add_cpu_stage(std::forward<Args>(args)...);
+                    parent_type::add_stage(std::forward<Args>(args)...);
                 }
 
                 /**
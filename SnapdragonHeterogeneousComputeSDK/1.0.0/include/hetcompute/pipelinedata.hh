@@ -23,6 +23,8 @@ namespace hetcompute
         class pipeline_cpu_stage_skeleton;
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UserData>
         class pipeline_gpu_stage_skeleton;
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UserData>
+        class pipeline_dsp_stage_skeleton;
 
         class pipeline_stage_instance;
         class pipeline_instance_base;
@@ -256,6 +258,9 @@ namespace hetcompute
 
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UserData>
         friend class hetcompute::internal::pipeline_gpu_stage_skeleton;
+
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UserData>
+        friend class hetcompute::internal::pipeline_dsp_stage_skeleton;
         /** @endcond */
     };
     // end of class iteration_lag
@@ -347,6 +352,9 @@ namespace hetcompute
 
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UD>
         friend class hetcompute::internal::pipeline_gpu_stage_skeleton;
+
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UD>
+        friend class hetcompute::internal::pipeline_dsp_stage_skeleton;
         /** @endcond */
     };
     // end of class iteration_rate
@@ -417,6 +425,9 @@ namespace hetcompute
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UserData>
         friend class hetcompute::internal::pipeline_gpu_stage_skeleton;
 
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UserData>
+        friend class hetcompute::internal::pipeline_dsp_stage_skeleton;
+
         template <typename... UserData>
         friend class hetcompute::internal::pipeline_skeleton;
         /** @endcond */
@@ -780,6 +791,8 @@ namespace hetcompute
         friend class hetcompute::internal::pipeline_cpu_stage_skeleton;
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UserData>
         friend class hetcompute::internal::pipeline_gpu_stage_skeleton;
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UserData>
+        friend class hetcompute::internal::pipeline_dsp_stage_skeleton;
         /** @endcond */
     };
     // end of class pipeline_context<>:public pipeline_context_base
@@ -847,6 +860,8 @@ namespace hetcompute
         friend class hetcompute::internal::pipeline_cpu_stage_skeleton;
         template <typename BeforeBody, typename GK, typename AfterBody, typename... UD>
         friend class hetcompute::internal::pipeline_gpu_stage_skeleton;
+        template <typename BeforeBody, typename DK, typename AfterBody, typename... UD>
+        friend class hetcompute::internal::pipeline_dsp_stage_skeleton;
         /** @endcond */
     };
     // end of class pipeline_context<UserData>:public pipeline_context_base
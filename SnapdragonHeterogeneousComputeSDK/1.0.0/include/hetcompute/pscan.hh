@@ -156,6 +156,234 @@ namespace hetcompute
         return hetcompute::internal::pscan_inclusive_async(std::forward<BinaryFn>(fn), first, last, tuner);
     }
 
+    /**
+     * Blocked parallel inclusive scan with an initial value.
+     *
+     * Performs an in-place prefix computation over [first, last), so that
+     * element i becomes init x v[0] x ... x v[i]. The range is split into
+     * blocks that are reduced in parallel; the block totals are scanned, and
+     * every block is then rescanned from its carry. Ranges below about 1<<16
+     * elements are scanned serially.
+     *
+     * <code>fn</code> should be associative, because the order of
+     * applications is not fixed.
+     *
+     * @par Examples
+     * @code
+     * // After: v' = { 10 + v[0], 10 + v[0] + v[1], ... }
+     * pscan_inclusive(begin(v), end(v), 10, std::plus<int>());
+     * @endcode
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param init  Value combined before the first element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename BinaryFn>
+    void pscan_inclusive(RandomAccessIterator                                                  first,
+                         RandomAccessIterator                                                  last,
+                         typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                         BinaryFn const&                                                       fn,
+                         const hetcompute::pattern::tuner&                                     tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        hetcompute::internal::pscan_blocked_internal<false>(nullptr, first, last, internal::scan::no_heads(), internal::scan::carry<T>(init), fn, tuner);
+    }
+
+    /**
+     * Create an asynchronous task from the blocked
+     * <code>hetcompute::pscan_inclusive</code> pattern with an initial value.
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param init  Value combined before the first element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename BinaryFn>
+    hetcompute::task_ptr<void()> pscan_inclusive_async(RandomAccessIterator                                                  first,
+                                                       RandomAccessIterator                                                  last,
+                                                       typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                                                       BinaryFn const&                                                       fn,
+                                                       const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        return hetcompute::internal::pscan_blocked_async<false>(first, last, internal::scan::no_heads(), internal::scan::carry<T>(init), fn, tuner);
+    }
+
+    /**
+     * Blocked parallel exclusive scan.
+     *
+     * Performs an in-place prefix computation over [first, last), so that
+     * element i becomes init x v[0] x ... x v[i - 1], and the first element
+     * becomes init.
+     *
+     * @par Examples
+     * @code
+     * // Turn per-bucket counts into bucket offsets
+     * pscan_exclusive(begin(counts), end(counts), size_t(0), std::plus<size_t>());
+     * @endcode
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param init  Value of the first element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename BinaryFn>
+    void pscan_exclusive(RandomAccessIterator                                                  first,
+                         RandomAccessIterator                                                  last,
+                         typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                         BinaryFn const&                                                       fn,
+                         const hetcompute::pattern::tuner&                                     tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        hetcompute::internal::pscan_blocked_internal<true>(nullptr, first, last, internal::scan::no_heads(), internal::scan::carry<T>(init), fn, tuner);
+    }
+
+    /**
+     * Create an asynchronous task from the <code>hetcompute::pscan_exclusive</code> pattern.
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param init  Value of the first element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename BinaryFn>
+    hetcompute::task_ptr<void()> pscan_exclusive_async(RandomAccessIterator                                                  first,
+                                                       RandomAccessIterator                                                  last,
+                                                       typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                                                       BinaryFn const&                                                       fn,
+                                                       const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        return hetcompute::internal::pscan_blocked_async<true>(first, last, internal::scan::no_heads(), internal::scan::carry<T>(init), fn, tuner);
+    }
+
+    /**
+     * Blocked parallel segmented inclusive scan.
+     *
+     * Like pscan_inclusive, but the range is divided into segments that are
+     * scanned independently. A segment starts at every element whose head
+     * flag is nonzero. The first element always starts a segment.
+     *
+     * @par Examples
+     * @code
+     * // v = { 1, 1, 1, 1, 1 }, heads = { 1, 0, 1, 0, 0 }
+     * // After: v' = { 1, 2, 1, 2, 3 }
+     * pscan_segmented_inclusive(begin(v), end(v), begin(heads), std::plus<int>());
+     * @endcode
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param heads Start of the head flags, one per element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename FlagIterator, typename BinaryFn>
+    void pscan_segmented_inclusive(RandomAccessIterator              first,
+                                   RandomAccessIterator              last,
+                                   FlagIterator                      heads,
+                                   BinaryFn const&                   fn,
+                                   const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        hetcompute::internal::pscan_blocked_internal<false>(nullptr,
+                                                            first,
+                                                            last,
+                                                            internal::scan::head_flags<FlagIterator>(heads),
+                                                            internal::scan::carry<T>(),
+                                                            fn,
+                                                            tuner);
+    }
+
+    /**
+     * Create an asynchronous task from the
+     * <code>hetcompute::pscan_segmented_inclusive</code> pattern.
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param heads Start of the head flags, one per element.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename FlagIterator, typename BinaryFn>
+    hetcompute::task_ptr<void()> pscan_segmented_inclusive_async(RandomAccessIterator              first,
+                                                                 RandomAccessIterator              last,
+                                                                 FlagIterator                      heads,
+                                                                 BinaryFn const&                   fn,
+                                                                 const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        return hetcompute::internal::pscan_blocked_async<false>(first,
+                                                                last,
+                                                                internal::scan::head_flags<FlagIterator>(heads),
+                                                                internal::scan::carry<T>(),
+                                                                fn,
+                                                                tuner);
+    }
+
+    /**
+     * Blocked parallel segmented exclusive scan.
+     *
+     * Like pscan_exclusive, but every element whose head flag is nonzero
+     * starts a new segment, and the scan restarts from init there.
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param heads Start of the head flags, one per element.
+     * @param init  Value of the first element of every segment.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename FlagIterator, typename BinaryFn>
+    void pscan_segmented_exclusive(RandomAccessIterator                                                  first,
+                                   RandomAccessIterator                                                  last,
+                                   FlagIterator                                                          heads,
+                                   typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                                   BinaryFn const&                                                       fn,
+                                   const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        hetcompute::internal::pscan_blocked_internal<true>(nullptr,
+                                                           first,
+                                                           last,
+                                                           internal::scan::head_flags<FlagIterator>(heads),
+                                                           internal::scan::carry<T>(init),
+                                                           fn,
+                                                           tuner);
+    }
+
+    /**
+     * Create an asynchronous task from the
+     * <code>hetcompute::pscan_segmented_exclusive</code> pattern.
+     *
+     * @param first Start of the range to scan.
+     * @param last  End of the range to scan.
+     * @param heads Start of the head flags, one per element.
+     * @param init  Value of the first element of every segment.
+     * @param fn    Binary function object to be applied.
+     * @param tuner HetCompute pattern tuner object (optional).
+     */
+    template <typename RandomAccessIterator, typename FlagIterator, typename BinaryFn>
+    hetcompute::task_ptr<void()> pscan_segmented_exclusive_async(RandomAccessIterator                                                  first,
+                                                                 RandomAccessIterator                                                  last,
+                                                                 FlagIterator                                                          heads,
+                                                                 typename std::iterator_traits<RandomAccessIterator>::value_type const& init,
+                                                                 BinaryFn const&                                                       fn,
+                                                                 const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+        return hetcompute::internal::pscan_blocked_async<true>(first,
+                                                               last,
+                                                               internal::scan::head_flags<FlagIterator>(heads),
+                                                               internal::scan::carry<T>(init),
+                                                               fn,
+                                                               tuner);
+    }
+
     /// @cond
     // Ignore this code fragment
     template <typename BinaryFn, typename... Args>
@@ -93,6 +93,10 @@ namespace hetcompute
      * Performs an unstable in-place comparison sort of a container using the
      * supplied cmp function.
      *
+     * Large arrays of integral or floating point values compared with
+     * std::less or std::greater are radix sorted instead. See
+     * hetcompute::pattern::tuner::set_sort_algorithm.
+     *
      * @par Examples
      * @code
      * // Sort vin using <code>hetcompute::psort</code>
@@ -180,6 +184,56 @@ namespace hetcompute
         return t;
     }
 
+    /**
+     * Parallel sort of keys with associated values.
+     *
+     * Sorts [kfirst, klast) using the supplied cmp function and applies the
+     * same permutation to the values starting at vfirst. The sort is unstable.
+     * Like psort, integral and floating point keys are radix sorted when
+     * cmp is std::less or std::greater, or when the tuner asks for it.
+     *
+     * @par Examples
+     * @code
+     * // Order particle indices by their cell id
+     * psort_by_key(cells.begin(), cells.end(), indices.begin(), std::less<uint32_t>());
+     * @endcode
+     *
+     * @param kfirst Start of the range of keys to sort.
+     * @param klast  End of the range of keys to sort.
+     * @param vfirst Start of the values. Values must be default constructible.
+     * @param cmp    User-customized compare function object applied to keys.
+     * @param tuner  Qualcomm HetCompute pattern tuner object (optional).
+     */
+    template <class KeyIterator, class ValueIterator, class Compare>
+    void psort_by_key(KeyIterator                       kfirst,
+                      KeyIterator                       klast,
+                      ValueIterator                     vfirst,
+                      Compare                           cmp,
+                      const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        internal::psort_by_key_internal(kfirst, klast, vfirst, cmp, tuner);
+    }
+
+    /**
+     * Parallel sort of keys with associated values.
+     *
+     * Equivalent to psort_by_key(kfirst, klast, vfirst, std::less<T>()) where T
+     * is the value type of the key iterators.
+     *
+     * @param kfirst Start of the range of keys to sort.
+     * @param klast  End of the range of keys to sort.
+     * @param vfirst Start of the values. Values must be default constructible.
+     * @param tuner  Qualcomm HetCompute pattern tuner object (optional).
+     */
+    template <class KeyIterator, class ValueIterator>
+    void psort_by_key(KeyIterator                       kfirst,
+                      KeyIterator                       klast,
+                      ValueIterator                     vfirst,
+                      const hetcompute::pattern::tuner& tuner = hetcompute::pattern::tuner())
+    {
+        internal::psort_by_key_internal(kfirst, klast, vfirst, std::less<typename std::iterator_traits<KeyIterator>::value_type>(), tuner);
+    }
+
     /// @cond
     // Ignore this code fragment
     template <typename Compare, typename... Args>
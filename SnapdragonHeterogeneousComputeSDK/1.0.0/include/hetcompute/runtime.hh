@@ -2,6 +2,7 @@
 #pragma once
 
 #include <hetcompute/internal/runtime-internal.hh>
+#include <hetcompute/internal/patterns/hetero/profile_cache.hh>
 
 namespace HetComputeApp
 {
@@ -31,11 +32,13 @@ namespace hetcompute
             Starts up HetCompute SDK's runtime.
         
             Initializes Hetcompute internal data structures, tasks, schedulers, and
-            thread pools. 
+            thread pools. Loads the profiles of heterogeneous pfor_each calls
+            from <code>HETCOMPUTE_PROFILE_CACHE_FILE</code>, if set.
         */
         inline void init()
         {
             hetcompute::internal::init_impl(HetComputeApp::features::supportException());
+            hetcompute::internal::hetero::profile_cache::get().load();
         }
 
         /**
@@ -20,6 +20,14 @@ namespace hetcompute
             valley
         };
 
+        // Sorting algorithm used by psort and psort_by_key
+        enum class sort_algorithm
+        {
+            automatic,
+            comparison,
+            radix
+        };
+
         /** @addtogroup pattern_tuner_doc
             @{ */
 
@@ -45,7 +53,10 @@ namespace hetcompute
                   _cpu_load(0),
                   _dsp_load(0),
                   _gpu_load(0),
-                  _profile(false)
+                  _profile(false),
+                  _dynamic_hetero(false),
+                  _sort_algorithm(sort_algorithm::automatic),
+                  _pipeline_target_us(0)
             {
                 HETCOMPUTE_INTERNAL_ASSERT(_max_doc > 0, "Degree of Concurrency must be > 0!");
                 HETCOMPUTE_INTERNAL_ASSERT(_min_chunk_size > 0, "Chunk size must be > 0!");
@@ -266,6 +277,15 @@ namespace hetcompute
              * Currently meaningful to hetero pfor_each pattern to generate
              * auto-tuned work distribution across heterogeneous devices.
              *
+             * The execution time per iteration measured on each device is kept
+             * in a profile cache, keyed by the kernels, their argument types and
+             * the shape and size of the range. Later calls with the same key split
+             * the work by the throughput of the devices right away. If the
+             * <code>HETCOMPUTE_PROFILE_CACHE_FILE</code> environment variable names
+             * a file, the cache is read from it by runtime::init() and written
+             * back at exit, so profiles carry over to later runs. Otherwise they
+             * are kept in memory only.
+             *
              * @return tuner& reference to the tuner object.
              */
             tuner& set_profile()
@@ -281,17 +301,139 @@ namespace hetcompute
              */
             bool has_profile() const { return _profile; }
 
+            /**
+             * Share the iterations of a heterogeneous pfor_each among devices
+             * at runtime.
+             *
+             * By default, heterogeneous pfor_each splits the iteration range
+             * once, in the proportions given by set_cpu_load(), set_gpu_load()
+             * and set_dsp_load(). If a device turns out slower than expected,
+             * e.g. because it is throttled or busy, the others go idle while it
+             * finishes its part. With dynamic sharing, every device that has a
+             * kernel keeps taking chunks of the range, sized to the throughput
+             * measured for it so far, until the range is drained. The loads are
+             * ignored. The work done by each device can be queried from the pfor
+             * object afterwards, e.g. with get_gpu_chunk_stats().
+             *
+             * The minimum chunk size can be set with set_chunk_size().
+             *
+             * @return tuner& reference to the tuner object.
+             */
+            tuner& set_dynamic_hetero()
+            {
+                _dynamic_hetero = true;
+                return *this;
+            }
+
+            /**
+             * Split the iterations of a heterogeneous pfor_each among devices
+             * once, according to the device loads (default).
+             *
+             * @return tuner& reference to the tuner object.
+             */
+            tuner& set_static_hetero()
+            {
+                _dynamic_hetero = false;
+                return *this;
+            }
+
+            /**
+             * Check if heterogeneous pfor_each shares iterations among devices at runtime.
+             *
+             * @return bool TRUE if iterations are shared at runtime and FALSE if
+             *         they are split according to the device loads.
+             */
+            bool is_dynamic_hetero() const { return _dynamic_hetero; }
+
+            /**
+             * Select the algorithm used by psort and psort_by_key.
+             *
+             * By default (sort_algorithm::automatic) large arrays of integral or
+             * floating point keys ordered by std::less or std::greater are radix
+             * sorted, and everything else is comparison sorted.
+             * sort_algorithm::radix also radix sorts arithmetic keys ordered by
+             * any other comparator, which must then order them the way std::less
+             * or std::greater does. Non-arithmetic keys are always comparison sorted.
+             *
+             * @param algorithm Sorting algorithm.
+             * @return tuner& reference to the tuner object.
+             */
+            tuner& set_sort_algorithm(sort_algorithm algorithm)
+            {
+                _sort_algorithm = algorithm;
+                return *this;
+            }
+
+            /**
+             * Query the algorithm used by psort and psort_by_key.
+             *
+             * @return sort_algorithm selected sorting algorithm.
+             */
+            sort_algorithm get_sort_algorithm() const { return _sort_algorithm; }
+
+            /**
+             * Adapt the stages of a pipeline to the cost of their iterations.
+             *
+             * Pass the tuner when running the pipeline. The runtime then measures
+             * the execution time of the iterations of each stage, and aims for
+             * tasks that run for about <code>target_us</code> on a stage:
+             * parallel stages hand out chunks of consecutive iterations, as many
+             * as fit in the target, up to their degree of concurrency; two adjacent
+             * serial CPU stages whose iterations together fit in the target are
+             * fused, i.e. the task that executes one goes on with the next one
+             * instead of launching another task. The decisions taken can be
+             * queried from the pipeline afterwards, with get_stage_stats().
+             *
+             * Chunk sizes set with set_chunk_size() on parallel stages are
+             * overridden.
+             *
+             * Only pipeline::run() and pipeline::create_task() adapt. The
+             * <code>hetcompute::launch()</code> and
+             * <code>hetcompute::create_task()</code> overloads for
+             * <code>hetcompute::pattern::pipeline<></code> are compiled into the
+             * runtime library and run the pipeline as configured, ignoring this
+             * setting.
+             *
+             * @param target_us Target duration of the work of a task on a stage,
+             *                  in microseconds. Must be larger than zero.
+             * @return tuner& reference to the tuner object.
+             */
+            tuner& set_adaptive_pipeline(size_t target_us = 100)
+            {
+                HETCOMPUTE_API_ASSERT(target_us > 0, "Target task duration must be > 0!");
+
+                _pipeline_target_us = target_us;
+                return *this;
+            }
+
+            /**
+             * Check if pipeline stages are adapted to the cost of their iterations.
+             *
+             * @return bool TRUE if the stages are adapted and FALSE otherwise.
+             */
+            bool is_adaptive_pipeline() const { return _pipeline_target_us > 0; }
+
+            /**
+             * Query the target duration of the work of a task on an adaptive pipeline stage.
+             *
+             * @return size_t target duration in microseconds, 0 if the pipeline is not adaptive.
+             */
+            size_t get_adaptive_pipeline_target() const { return _pipeline_target_us; }
+
         private:
-            size_t    _max_doc;
-            size_t    _min_chunk_size;
-            bool      _static;
-            shape     _shape;
-            bool      _serialize;
-            bool      _user_setbit;
-            load_type _cpu_load;
-            load_type _dsp_load;
-            load_type _gpu_load;
-            bool      _profile;
+            size_t         _max_doc;
+            size_t         _min_chunk_size;
+            bool           _static;
+            shape          _shape;
+            bool           _serialize;
+            bool           _user_setbit;
+            load_type      _cpu_load;
+            load_type      _dsp_load;
+            load_type      _gpu_load;
+            bool           _profile;
+            bool           _dynamic_hetero;
+            sort_algorithm _sort_algorithm;
+            size_t         _pipeline_target_us;
         };
 
         /** @} */ /* end_addtogroup pattern_tuner_doc */
@@ -65,9 +65,10 @@ include $(PREBUILT_SHARED_LIBRARY)
 
 ###############################################################################
 
-define hetcompute_add_sample
+# $1 module name, $2 source file in the samples directory, without .cc
+define hetcompute_add_executable
   include $(CLEAR_VARS)
-  LOCAL_MODULE := hetcompute_sample_$1
+  LOCAL_MODULE := $1
   LOCAL_C_INCLUDES := $(QSHETCOMPUTE_CORE_INCLUDE_PATH) \
                       $(QSHETCOMPUTE_OPENCL_INC_PATH) \
                       $(QSHETCOMPUTE_DSP_STUB_PATH)
@@ -79,7 +80,7 @@ define hetcompute_add_sample
   ifeq ($(TARGET_ARCH_ABI), arm64-v8a)
     LOCAL_LDFLAGS := -Wl,-allow-shlib-undefined
   endif
-  LOCAL_SRC_FILES := $(QSHETCOMPUTE_SAMPLES_SRC_PATH)/$1.cc
+  LOCAL_SRC_FILES := $(QSHETCOMPUTE_SAMPLES_SRC_PATH)/$2.cc
   include $(BUILD_EXECUTABLE)
 endef
 
@@ -89,8 +90,22 @@ sample_names :=  \
   MatrixAlgorithmDemo \
   ImageProcessingDemo \
   ParallelTaskDependencyDemo \
-  ParallelPatternsDemo
+  ParallelPatternsDemo \
+  LockFreeQueueBenchmark \
+  MutexContentionBenchmark \
+  BarrierBenchmark \
+  ChromeTraceDemo \
+  TraceDecoder \
+  HeteroSchedulingDemo \
+  DivideAndConquerBenchmark \
+  PipelineDspStageDemo \
+  PipelineAdaptiveDemo
+
+# benchmarks, built as hetcompute_benchmark_*
+benchmark_names := \
+  BenchmarkSuite
 
 ###############################################################################
 
-$(foreach ex,$(sample_names),$(eval $(call hetcompute_add_sample,$(ex))))
+$(foreach ex,$(sample_names),$(eval $(call hetcompute_add_executable,hetcompute_sample_$(ex),$(ex))))
+$(foreach ex,$(benchmark_names),$(eval $(call hetcompute_add_executable,hetcompute_benchmark_$(ex),$(ex))))
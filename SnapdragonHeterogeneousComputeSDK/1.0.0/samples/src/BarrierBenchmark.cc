@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include <hetcompute/internal/synchronization/barrier.hh>
+#include "BenchmarkHarness.hh"
+
+#define PHASES 2000
+
+// Runs a barrier with 2, 4, ... up to one participant per execution
+// context, PHASES times per run, with the single counter sense_barrier and
+// with the combining_tree_barrier, whose leaves group the participants of
+// the big and of the LITTLE cluster. Reports the latency of one phase.
+//
+// Each phase also checks that every participant reached it, the way the
+// sweeps of a Jacobi solver read the neighbours written in the last sweep.
+
+
+template <typename Wait>
+static bool run_barrier(size_t num_participants, Wait wait)
+{
+    std::vector<int> phase_of(num_participants, 0);
+    std::vector<int> ok(num_participants, 1);
+
+    auto g = hetcompute::create_group();
+    for (size_t p = 0; p < num_participants; p++) {
+        g->launch([&phase_of, &ok, &wait, num_participants, p] {
+            for (int phase = 1; phase <= PHASES; phase++) {
+                phase_of[p] = phase;
+                wait(p);
+                for (size_t q = 0; q < num_participants; q++) {
+                    ok[p] = ok[p] && phase_of[q] >= phase;
+                }
+                wait(p);
+            }
+        });
+    }
+    g->wait_for();
+
+    return std::all_of(ok.begin(), ok.end(), [](int v) { return v != 0; });
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_BarrierBenchmark");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    benchmark::harness bench("BarrierBenchmark");
+    bool ok = true;
+
+    size_t max_participants = std::max<size_t>(hetcompute::internal::num_execution_contexts(), 2);
+    HETCOMPUTE_ILOG("%zu execution contexts, %zu big", hetcompute::internal::num_execution_contexts(),
+                    hetcompute::internal::num_big_execution_contexts());
+
+    std::vector<size_t> counts;
+    for (size_t n = 2; n < max_participants; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_participants);
+
+    for (size_t n : counts) {
+        std::string sense_name = "sense_barrier/" + std::to_string(n);
+        bench.measure(sense_name, [&](benchmark::run&) {
+            hetcompute::barrier b(n);
+            ok = run_barrier(n, [&b](size_t) { b.wait(); }) && ok;
+        });
+        bench.set_work(sense_name, 2.0 * PHASES, 0);
+
+        std::string tree_name = "combining_barrier/" + std::to_string(n);
+        bench.measure(tree_name, [&](benchmark::run&) {
+            hetcompute::combining_barrier b(n);
+            ok = run_barrier(n, [&b](size_t p) { b.wait(p); }) && ok;
+        });
+        bench.set_work(tree_name, 2.0 * PHASES, 0);
+
+        HETCOMPUTE_ILOG("%zu participants: sense_barrier %.2f us, combining_barrier %.2f us per phase", n,
+                        bench.get(sense_name).median * 1e3 / (2 * PHASES), bench.get(tree_name).median * 1e3 / (2 * PHASES));
+    }
+
+    bench.report();
+    HETCOMPUTE_ILOG("Phases %s", ok ? "correct" : "WRONG");
+
+    hetcompute::runtime::shutdown();
+    return ok ? 0 : 1;
+}
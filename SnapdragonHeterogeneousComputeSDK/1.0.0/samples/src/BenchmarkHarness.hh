@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+
+// Benchmark harness shared by the samples.
+//
+// A benchmark body runs `warmup` times untimed and then `repetitions` times
+// timed. Each timed run records its total time and the time of any phase the
+// body marks (launch, wait, copy-in, copy-out, ...). report() logs
+// min/median/p95/p99 per benchmark and phase, and the throughput of the
+// benchmarks whose work was declared with set_work(). If an output path is
+// set, it also writes them as JSON, or as CSV if the path ends in ".csv".
+//
+// The defaults can be overridden from the environment:
+//   HETCOMPUTE_BENCH_WARMUP       untimed runs per benchmark
+//   HETCOMPUTE_BENCH_REPETITIONS  timed runs per benchmark
+//   HETCOMPUTE_BENCH_OUTPUT       results file (.json or .csv)
+//   HETCOMPUTE_BENCH_LABEL        free-form label, e.g. the build id
+
+namespace benchmark {
+
+// Monotonic clock in nanoseconds
+inline uint64_t
+now_ns()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+struct config
+{
+    size_t      warmup;
+    size_t      repetitions;
+    std::string output;
+    std::string label;
+
+    static config from_environment(size_t default_warmup = 1, size_t default_repetitions = 5)
+    {
+        config c;
+        c.warmup      = read_size("HETCOMPUTE_BENCH_WARMUP", default_warmup);
+        c.repetitions = std::max<size_t>(read_size("HETCOMPUTE_BENCH_REPETITIONS", default_repetitions), 1);
+        c.output      = read_string("HETCOMPUTE_BENCH_OUTPUT");
+        c.label       = read_string("HETCOMPUTE_BENCH_LABEL");
+        return c;
+    }
+
+private:
+    static size_t read_size(const char* name, size_t fallback)
+    {
+        const char* value = std::getenv(name);
+        return value != nullptr ? static_cast<size_t>(std::strtoul(value, nullptr, 10)) : fallback;
+    }
+
+    static std::string read_string(const char* name)
+    {
+        const char* value = std::getenv(name);
+        return value != nullptr ? value : "";
+    }
+};
+
+
+// Summary of the samples of one benchmark phase, in milliseconds
+struct statistics
+{
+    size_t samples;
+    double min;
+    double median;
+    double p95;
+    double p99;
+    double mean;
+};
+
+
+// Nearest-rank percentile of sorted samples
+inline double
+percentile(std::vector<uint64_t> const& sorted, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1] / 1e6;
+}
+
+
+inline statistics
+compute_statistics(std::vector<uint64_t> samples)
+{
+    statistics s = { samples.size(), 0, 0, 0, 0, 0 };
+    if (samples.empty()) {
+        return s;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (auto ns : samples) {
+        sum += ns;
+    }
+    s.min    = samples.front() / 1e6;
+    s.median = percentile(samples, 50);
+    s.p95    = percentile(samples, 95);
+    s.p99    = percentile(samples, 99);
+    s.mean   = sum / samples.size() / 1e6;
+    return s;
+}
+
+
+// Work done by one run of a benchmark, to derive its throughput from the
+// median time of a phase
+struct work
+{
+    double      elements;
+    double      bytes;
+    std::string phase;
+
+    // Elements per second and GB per second at a median time in ms
+    double elements_per_s(double median_ms) const
+    {
+        return median_ms > 0 ? elements / (median_ms / 1e3) : 0;
+    }
+
+    double gb_per_s(double median_ms) const
+    {
+        return median_ms > 0 ? bytes / 1e9 / (median_ms / 1e3) : 0;
+    }
+};
+
+
+// Timings of a single run of a benchmark body
+class run
+{
+public:
+    // Adds the time between its construction and destruction to a phase.
+    class phase_timer
+    {
+    public:
+        phase_timer(run* r, const char* name) : _run(r), _name(name), _begin(now_ns())
+        {
+        }
+
+        phase_timer(phase_timer&& other) : _run(other._run), _name(other._name), _begin(other._begin)
+        {
+            other._run = nullptr;
+        }
+
+        ~phase_timer()
+        {
+            stop();
+        }
+
+        // Ends the phase before the end of the scope
+        void stop()
+        {
+            if (_run != nullptr) {
+                _run->add(_name, now_ns() - _begin);
+                _run = nullptr;
+            }
+        }
+
+    private:
+        run*        _run;
+        const char* _name;
+        uint64_t    _begin;
+
+        phase_timer(phase_timer const&) = delete;
+        phase_timer& operator=(phase_timer const&) = delete;
+    };
+
+    // Starts timing a phase. The phase ends when the returned object goes out of scope.
+    phase_timer phase(const char* name)
+    {
+        return phase_timer(this, name);
+    }
+
+    // Times f as a phase.
+    template <typename F>
+    void time(const char* name, F&& f)
+    {
+        auto p = phase(name);
+        f();
+    }
+
+    // Adds ns to a phase. A phase timed several times in one run is summed.
+    void add(std::string const& name, uint64_t ns)
+    {
+        for (auto& entry : _phases) {
+            if (entry.first == name) {
+                entry.second += ns;
+                return;
+            }
+        }
+        _phases.emplace_back(name, ns);
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> const& phases() const
+    {
+        return _phases;
+    }
+
+private:
+    std::vector<std::pair<std::string, uint64_t>> _phases;
+};
+
+
+class harness
+{
+public:
+    explicit harness(std::string suite, config c = config::from_environment()) : _suite(std::move(suite)), _config(std::move(c))
+    {
+    }
+
+    // Runs body(run&) warmup times untimed and then repetitions times timed.
+    // Returns the statistics of the total time. Thread safe.
+    template <typename Body>
+    statistics measure(std::string const& name, Body&& body)
+    {
+        for (size_t i = 0; i < _config.warmup; i++) {
+            run r;
+            body(r);
+        }
+
+        std::vector<run> runs(_config.repetitions);
+        std::vector<uint64_t> totals;
+        for (auto& r : runs) {
+            uint64_t begin = now_ns();
+            body(r);
+            totals.push_back(now_ns() - begin);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& phases = get_benchmark(name);
+        auto& total = phases["total"];
+        total.insert(total.end(), totals.begin(), totals.end());
+        for (auto const& r : runs) {
+            for (auto const& entry : r.phases()) {
+                phases[entry.first].push_back(entry.second);
+            }
+        }
+        return compute_statistics(total);
+    }
+
+    // Returns the statistics of a phase of a benchmark measured so far
+    statistics get(std::string const& name, std::string const& phase = "total")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return compute_statistics(get_benchmark(name)[phase]);
+    }
+
+    // Declares the elements processed and the bytes moved by one run of a
+    // benchmark, timed by one of its phases
+    void set_work(std::string const& name, double elements, double bytes, std::string const& phase = "total")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _work[name] = work{ elements, bytes, phase };
+    }
+
+    // Logs all results and writes them to the configured output file, if any.
+    void report()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        HETCOMPUTE_ILOG("%s: %zu warm-up, %zu timed runs per benchmark (ms)", _suite.c_str(), _config.warmup, _config.repetitions);
+        for (auto const& benchmark : _results) {
+            for (auto const& phase : benchmark.second) {
+                auto s = compute_statistics(phase.second);
+                HETCOMPUTE_ILOG("  %-32s %-10s min %10.3f  median %10.3f  p95 %10.3f  p99 %10.3f",
+                                benchmark.first.c_str(), phase.first.c_str(), s.min, s.median, s.p95, s.p99);
+            }
+            auto w = _work.find(benchmark.first);
+            if (w != _work.end()) {
+                auto s = phase_statistics(benchmark.second, w->second.phase);
+                HETCOMPUTE_ILOG("  %-32s %-10s %.3e elements/s  %.3f GB/s", benchmark.first.c_str(), w->second.phase.c_str(),
+                                w->second.elements_per_s(s.median), w->second.gb_per_s(s.median));
+            }
+        }
+
+        if (_config.output.empty()) {
+            return;
+        }
+        bool csv = _config.output.size() >= 4 && _config.output.compare(_config.output.size() - 4, 4, ".csv") == 0;
+        FILE* file = std::fopen(_config.output.c_str(), "w");
+        if (file == nullptr) {
+            HETCOMPUTE_ILOG("Could not open benchmark output file %s", _config.output.c_str());
+            return;
+        }
+        if (csv) {
+            write_csv(file);
+        } else {
+            write_json(file);
+        }
+        std::fclose(file);
+        HETCOMPUTE_ILOG("Benchmark results written to %s", _config.output.c_str());
+    }
+
+    config const& get_config() const
+    {
+        return _config;
+    }
+
+private:
+    typedef std::map<std::string, std::vector<uint64_t>> phase_map;
+
+    // Benchmarks are reported in the order they were first measured
+    phase_map& get_benchmark(std::string const& name)
+    {
+        for (auto& benchmark : _results) {
+            if (benchmark.first == name) {
+                return benchmark.second;
+            }
+        }
+        _results.emplace_back(name, phase_map());
+        return _results.back().second;
+    }
+
+    static statistics phase_statistics(phase_map const& phases, std::string const& phase)
+    {
+        auto p = phases.find(phase);
+        return compute_statistics(p != phases.end() ? p->second : std::vector<uint64_t>());
+    }
+
+    void write_csv(FILE* file)
+    {
+        std::fprintf(file, "suite,label,benchmark,phase,samples,min_ms,median_ms,p95_ms,p99_ms,mean_ms,elements_per_s,gb_per_s\n");
+        for (auto const& benchmark : _results) {
+            auto w = _work.find(benchmark.first);
+            for (auto const& phase : benchmark.second) {
+                auto s = compute_statistics(phase.second);
+                std::fprintf(file, "%s,%s,%s,%s,%zu,%.6f,%.6f,%.6f,%.6f,%.6f,",
+                             _suite.c_str(), _config.label.c_str(), benchmark.first.c_str(), phase.first.c_str(),
+                             s.samples, s.min, s.median, s.p95, s.p99, s.mean);
+                if (w != _work.end() && w->second.phase == phase.first) {
+                    std::fprintf(file, "%.6e,%.6f\n", w->second.elements_per_s(s.median), w->second.gb_per_s(s.median));
+                } else {
+                    std::fprintf(file, ",\n");
+                }
+            }
+        }
+    }
+
+    void write_json(FILE* file)
+    {
+        std::fprintf(file, "{\n  \"suite\": \"%s\",\n  \"label\": \"%s\",\n  \"timestamp\": %lld,\n", _suite.c_str(),
+                     _config.label.c_str(), static_cast<long long>(std::time(nullptr)));
+        std::fprintf(file, "  \"warmup\": %zu,\n  \"repetitions\": %zu,\n  \"benchmarks\": [", _config.warmup, _config.repetitions);
+        for (size_t b = 0; b < _results.size(); b++) {
+            std::fprintf(file, "%s\n    { \"name\": \"%s\",", b == 0 ? "" : ",", _results[b].first.c_str());
+            auto w = _work.find(_results[b].first);
+            if (w != _work.end()) {
+                auto s = phase_statistics(_results[b].second, w->second.phase);
+                std::fprintf(file, " \"throughput\": { \"phase\": \"%s\", \"elements\": %.0f, \"bytes\": %.0f, "
+                             "\"elements_per_s\": %.6e, \"gb_per_s\": %.6f },", w->second.phase.c_str(), w->second.elements,
+                             w->second.bytes, w->second.elements_per_s(s.median), w->second.gb_per_s(s.median));
+            }
+            std::fprintf(file, " \"phases\": {");
+            size_t p = 0;
+            for (auto const& phase : _results[b].second) {
+                auto s = compute_statistics(phase.second);
+                std::fprintf(file, "%s\n      \"%s\": { \"samples\": %zu, \"min_ms\": %.6f, \"median_ms\": %.6f, "
+                             "\"p95_ms\": %.6f, \"p99_ms\": %.6f, \"mean_ms\": %.6f }",
+                             p++ == 0 ? "" : ",", phase.first.c_str(), s.samples, s.min, s.median, s.p95, s.p99, s.mean);
+            }
+            std::fprintf(file, "\n    } }");
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+
+    std::string _suite;
+    config _config;
+    std::mutex _mutex;
+    std::vector<std::pair<std::string, phase_map>> _results;
+    std::map<std::string, work> _work;
+};
+
+} // namespace benchmark
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
+
+#define DEFAULT_MIN_SIZE (1 << 10)
+#define DEFAULT_MAX_SIZE (1 << 26)
+#define SIZE_STEP 4
+#define GEMM_MAX_SIZE (1 << 20)
+#define PIPELINE_BLOCK 4096
+
+// Sweeps problem sizes, from 1K to 64M elements by default, over elementwise,
+// reduction, scan, sort, stencil, GEMM and pipeline workloads, each at a range
+// of degrees of concurrency, i.e. the number of tasks the pattern runs in
+// parallel. Reports the throughput of each run in elements/s and GB/s, and
+// its speedup over the smallest degree of concurrency, and checks the results.
+//
+// The bytes are the minimum traffic of the workload, each input read once and
+// each output written once. GEMM counts one element per multiply-add, and runs
+// up to GEMM_MAX_SIZE elements of C.
+//
+// Besides the variables of BenchmarkHarness.hh, the sweep can be narrowed from
+// the environment:
+//   HETCOMPUTE_BENCH_MIN_SIZE   smallest problem size, in elements
+//   HETCOMPUTE_BENCH_MAX_SIZE   largest problem size, in elements
+//   HETCOMPUTE_BENCH_THREADS    comma-separated degrees of concurrency,
+//                               by default 1, 2, 4, ... up to the number of cores
+//   HETCOMPUTE_BENCH_WORKLOADS  comma-separated workloads, by default all of
+//                               elementwise,reduction,scan,sort,stencil,gemm,pipeline
+
+using context = hetcompute::pattern::pipeline<>::context;
+
+static benchmark::harness bench("BenchmarkSuite");
+
+struct result {
+    std::string workload;
+    size_t size;
+    size_t threads;
+    double median_ms;
+    double elements_per_s;
+    double gb_per_s;
+};
+
+static std::vector<result> results;
+static bool all_correct = true;
+
+
+static size_t
+read_size(const char* name, size_t fallback)
+{
+    const char* value = std::getenv(name);
+    return value != nullptr ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : fallback;
+}
+
+static std::vector<std::string>
+read_list(const char* name, std::string const& fallback)
+{
+    const char* value = std::getenv(name);
+    std::string list = value != nullptr ? value : fallback;
+    std::vector<std::string> items;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = std::min(list.find(',', begin), list.size());
+        if (end > begin) {
+            items.push_back(list.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+    return items;
+}
+
+static std::vector<size_t>
+thread_counts()
+{
+    std::vector<size_t> threads;
+    for (auto const& t : read_list("HETCOMPUTE_BENCH_THREADS", "")) {
+        size_t n = static_cast<size_t>(std::strtoul(t.c_str(), nullptr, 10));
+        if (n > 0) {
+            threads.push_back(n);
+        }
+    }
+    if (threads.empty()) {
+        size_t cores = hetcompute::internal::num_execution_contexts();
+        for (size_t n = 1; n < cores; n *= 2) {
+            threads.push_back(n);
+        }
+        threads.push_back(cores);
+    }
+    return threads;
+}
+
+static hetcompute::pattern::tuner
+make_tuner(size_t threads)
+{
+    return hetcompute::pattern::tuner().set_max_doc(threads);
+}
+
+// Measures body(run&) for a workload, problem size and degree of concurrency,
+// and records the throughput of the given phase
+template <typename Body>
+static void
+measure(const char* workload, size_t size, size_t threads, double elements, double bytes, const char* phase, Body&& body)
+{
+    std::string name = std::string(workload) + "/" + std::to_string(size) + "/t" + std::to_string(threads);
+    bench.set_work(name, elements, bytes, phase);
+    bench.measure(name, body);
+
+    benchmark::work w = { elements, bytes, phase };
+    double median = bench.get(name, phase).median;
+    results.push_back(result{ workload, size, threads, median, w.elements_per_s(median), w.gb_per_s(median) });
+}
+
+static void
+check(const char* workload, size_t size, bool ok)
+{
+    if (!ok) {
+        HETCOMPUTE_ILOG("%s of %zu elements: WRONG result", workload, size);
+        all_correct = false;
+    }
+}
+
+
+// z = a * x + y
+static void
+run_elementwise(size_t n, std::vector<size_t> const& threads)
+{
+    std::vector<float> x(n), y(n), z(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = static_cast<float>(i % 1000);
+        y[i] = static_cast<float>(i % 7);
+    }
+    const float a = 0.5f;
+
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("elementwise", n, t, n, 3.0 * n * sizeof(float), "total", [&](benchmark::run&) {
+            hetcompute::pfor_each(size_t(0), n, [&](size_t i) { z[i] = a * x[i] + y[i]; }, tuner);
+        });
+    }
+    check("elementwise", n, std::fabs(z[n - 1] - (a * x[n - 1] + y[n - 1])) <= 1e-3f &&
+                                std::fabs(z[n / 2] - (a * x[n / 2] + y[n / 2])) <= 1e-3f);
+}
+
+// sum of x
+static void
+run_reduction(size_t n, std::vector<size_t> const& threads)
+{
+    std::vector<int32_t> x(n);
+    int64_t expected = 0;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = static_cast<int32_t>(i % 1000);
+        expected += x[i];
+    }
+
+    int64_t sum = 0;
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("reduction", n, t, n, 1.0 * n * sizeof(int32_t), "total", [&](benchmark::run&) {
+            sum = hetcompute::preduce(size_t(0), n, int64_t(0),
+                [&x](size_t first, size_t last, int64_t& acc) {
+                    for (size_t i = first; i < last; i++) {
+                        acc += x[i];
+                    }
+                },
+                [](int64_t l, int64_t r) { return l + r; }, tuner);
+        });
+    }
+    check("reduction", n, sum == expected);
+}
+
+// inclusive prefix sum of x
+static void
+run_scan(size_t n, std::vector<size_t> const& threads)
+{
+    std::vector<uint32_t> x(n), y(n);
+    uint32_t expected = 0;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = static_cast<uint32_t>(i % 3);
+        expected += x[i];
+    }
+
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("scan", n, t, n, 2.0 * n * sizeof(uint32_t), "scan", [&](benchmark::run& run) {
+            run.time("copy-in", [&] { std::copy(x.begin(), x.end(), y.begin()); });
+            run.time("scan", [&] {
+                hetcompute::pscan_inclusive(y.begin(), y.end(), [](uint32_t const& l, uint32_t const& r) { return l + r; }, tuner);
+            });
+        });
+    }
+    check("scan", n, y[n - 1] == expected);
+}
+
+// sort of random keys
+static void
+run_sort(size_t n, std::vector<size_t> const& threads)
+{
+    std::vector<uint32_t> x(n), y(n);
+    std::mt19937 generator(2019);
+    for (auto& v : x) {
+        v = generator();
+    }
+
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("sort", n, t, n, 2.0 * n * sizeof(uint32_t), "sort", [&](benchmark::run& run) {
+            run.time("copy-in", [&] { std::copy(x.begin(), x.end(), y.begin()); });
+            run.time("sort", [&] { hetcompute::psort(y.begin(), y.end(), tuner); });
+        });
+    }
+    check("sort", n, std::is_sorted(y.begin(), y.end()));
+}
+
+// 5-point Jacobi step on a square grid of about n points
+static void
+run_stencil(size_t n, std::vector<size_t> const& threads)
+{
+    size_t side = std::max<size_t>(static_cast<size_t>(std::sqrt(static_cast<double>(n))), 3);
+    size_t points = side * side;
+    std::vector<float> in(points), out(points, 0.0f);
+    for (size_t i = 0; i < points; i++) {
+        in[i] = static_cast<float>((i * 7) % 256);
+    }
+
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("stencil", n, t, points, 2.0 * points * sizeof(float), "total", [&](benchmark::run&) {
+            hetcompute::pfor_each(size_t(1), side - 1, [&](size_t r) {
+                const float* above = &in[(r - 1) * side];
+                const float* row = &in[r * side];
+                const float* below = &in[(r + 1) * side];
+                float* o = &out[r * side];
+                for (size_t c = 1; c < side - 1; c++) {
+                    o[c] = 0.2f * (row[c] + row[c - 1] + row[c + 1] + above[c] + below[c]);
+                }
+            }, tuner);
+        });
+    }
+    size_t r = side / 2, c = side / 2;
+    float expected = 0.2f * (in[r * side + c] + in[r * side + c - 1] + in[r * side + c + 1] + in[(r - 1) * side + c] +
+                             in[(r + 1) * side + c]);
+    check("stencil", n, std::fabs(out[r * side + c] - expected) <= 1e-3f);
+}
+
+// C = A * B on square matrices with about n elements
+static void
+run_gemm(size_t n, std::vector<size_t> const& threads)
+{
+    if (n > GEMM_MAX_SIZE) {
+        return;
+    }
+    size_t side = std::max<size_t>(static_cast<size_t>(std::sqrt(static_cast<double>(n))), 1);
+    size_t elements = side * side;
+    std::vector<float> a(elements), b(elements), c(elements);
+    std::mt19937 generator(2019);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (size_t i = 0; i < elements; i++) {
+        a[i] = dist(generator);
+        b[i] = dist(generator);
+    }
+
+    for (auto t : threads) {
+        auto tuner = make_tuner(t);
+        measure("gemm", n, t, static_cast<double>(elements) * side, 3.0 * elements * sizeof(float), "total", [&](benchmark::run&) {
+            hetcompute::pgemm(side, side, side, a.data(), b.data(), c.data(), tuner);
+        });
+    }
+    size_t i = side / 2, j = side / 3;
+    float expected = 0.0f;
+    for (size_t k = 0; k < side; k++) {
+        expected += a[i * side + k] * b[k * side + j];
+    }
+    check("gemm", n, std::fabs(c[i * side + j] - expected) <= 1e-3f * std::max(1.0f, std::fabs(expected)));
+}
+
+// three-stage pipeline over blocks of PIPELINE_BLOCK elements: a serial stage
+// hands out blocks, a parallel stage computes them, a serial stage counts them
+static void
+run_pipeline(size_t n, std::vector<size_t> const& threads)
+{
+    std::vector<float> in(n), out(n);
+    for (size_t i = 0; i < n; i++) {
+        in[i] = static_cast<float>(i % 1000);
+    }
+    size_t blocks = (n + PIPELINE_BLOCK - 1) / PIPELINE_BLOCK;
+
+    std::atomic<size_t> counted(0);
+    for (auto t : threads) {
+        hetcompute::pattern::pipeline<> p;
+        p.add_stage(hetcompute::serial_stage(), [](context& ctx) { return ctx.get_iter_id(); });
+        p.add_stage(hetcompute::parallel_stage(t), [&in, &out, n](context&, hetcompute::stage_input<size_t>& block) {
+            size_t first = block[0] * PIPELINE_BLOCK;
+            size_t last = std::min(first + PIPELINE_BLOCK, n);
+            for (size_t i = first; i < last; i++) {
+                out[i] = std::sqrt(in[i]);
+            }
+            return block[0];
+        });
+        p.add_stage(hetcompute::serial_stage(), [&counted](context&, hetcompute::stage_input<size_t>&) { counted++; });
+
+        measure("pipeline", n, t, n, 2.0 * n * sizeof(float), "total", [&](benchmark::run&) {
+            counted = 0;
+            p.run(blocks);
+        });
+    }
+    check("pipeline", n, counted.load() == blocks && out[n - 1] == std::sqrt(in[n - 1]));
+}
+
+
+struct workload {
+    const char* name;
+    void (*run)(size_t, std::vector<size_t> const&);
+};
+
+static const workload workloads[] = {
+    { "elementwise", run_elementwise },
+    { "reduction", run_reduction },
+    { "scan", run_scan },
+    { "sort", run_sort },
+    { "stencil", run_stencil },
+    { "gemm", run_gemm },
+    { "pipeline", run_pipeline },
+};
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_benchmark_BenchmarkSuite");
+        HETCOMPUTE_ILOG("eg: HETCOMPUTE_BENCH_MAX_SIZE=1048576 HETCOMPUTE_BENCH_WORKLOADS=scan,sort \\");
+        HETCOMPUTE_ILOG("      HETCOMPUTE_BENCH_THREADS=1,4 HETCOMPUTE_BENCH_OUTPUT=suite.csv \\");
+        HETCOMPUTE_ILOG("      ./hetcompute_benchmark_BenchmarkSuite");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    size_t min_size = std::max<size_t>(read_size("HETCOMPUTE_BENCH_MIN_SIZE", DEFAULT_MIN_SIZE), 1);
+    size_t max_size = read_size("HETCOMPUTE_BENCH_MAX_SIZE", DEFAULT_MAX_SIZE);
+    auto threads = thread_counts();
+    auto selected = read_list("HETCOMPUTE_BENCH_WORKLOADS", "elementwise,reduction,scan,sort,stencil,gemm,pipeline");
+
+    for (auto const& w : workloads) {
+        if (std::find(selected.begin(), selected.end(), w.name) == selected.end()) {
+            continue;
+        }
+        for (size_t n = min_size; n <= max_size; n *= SIZE_STEP) {
+            w.run(n, threads);
+        }
+    }
+
+    bench.report();
+
+    // Throughput, and speedup over the first degree of concurrency of the same size
+    HETCOMPUTE_ILOG("%-12s %10s %7s %12s %14s %10s %8s", "workload", "size", "threads", "median ms", "elements/s", "GB/s",
+                    "speedup");
+    for (size_t i = 0; i < results.size(); i++) {
+        auto const& r = results[i];
+        size_t base = i;
+        while (base > 0 && results[base - 1].workload == r.workload && results[base - 1].size == r.size) {
+            base--;
+        }
+        double speedup = r.median_ms > 0 ? results[base].median_ms / r.median_ms : 0;
+        HETCOMPUTE_ILOG("%-12s %10zu %7zu %12.3f %14.3e %10.3f %8.2f", r.workload.c_str(), r.size, r.threads, r.median_ms,
+                        r.elements_per_s, r.gb_per_s, speedup);
+    }
+    HETCOMPUTE_ILOG("results %s", all_correct ? "correct" : "WRONG");
+
+    hetcompute::runtime::shutdown();
+    return all_correct ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <numeric>
+#include <string>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include <hetcompute/internal/log/chrometracelogger.hh>
+
+#ifdef __ANDROID__
+#define DEFAULT_TRACE_FILE "/mnt/sdcard/hetcompute_trace.json"
+#else
+#define DEFAULT_TRACE_FILE "hetcompute_trace.json"
+#endif // __ANDROID__
+
+#define NUM_TASKS 64
+#define ARRAY_SIZE (1 << 20)
+
+// Records a few groups of tasks, a chain of dependent tasks and a pfor_each
+// with chrome_trace_logger and writes the trace, which can be
+// opened with chrome://tracing or ui.perfetto.dev. Each phase is also marked
+// with add_trace_entry; the markers are logged, or written to
+// $HETCOMPUTE_TRACE_FILE for the TraceDecoder sample, by dump_trace_entries().
+
+using hetcompute::internal::log::chrome_trace_logger;
+
+static void mark(char const* phase)
+{
+    std::string entry(phase);
+    hetcompute::internal::log::add_trace_entry(entry);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 2) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_ChromeTraceDemo [trace.json]");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+    char const* trace_file = argc == 2 ? argv[1] : DEFAULT_TRACE_FILE;
+
+    chrome_trace_logger::start();
+
+    // Independent tasks in a group
+    mark("group");
+    std::vector<size_t> sums(NUM_TASKS, 0);
+    auto g = hetcompute::create_group();
+    for (size_t i = 0; i < NUM_TASKS; i++) {
+        g->launch([&sums, i] {
+            for (size_t j = 0; j < (i + 1) * 10000; j++) {
+                sums[i] += j % 7;
+            }
+        });
+    }
+    g->wait_for();
+
+    // A chain of dependent tasks
+    mark("chain");
+    size_t chain = 0;
+    auto first = hetcompute::create_task([&chain] { chain++; });
+    auto last = first;
+    for (size_t i = 1; i < NUM_TASKS; i++) {
+        auto t = hetcompute::create_task([&chain] { chain++; });
+        last->then(t);
+        last = t;
+    }
+    first->launch();
+    last->wait_for();
+
+    // A data-parallel loop
+    mark("pfor_each");
+    std::vector<int> values(ARRAY_SIZE);
+    hetcompute::pfor_each(size_t(0), size_t(ARRAY_SIZE), [&values](size_t i) { values[i] = static_cast<int>(i % 3); });
+
+    mark("done");
+    chrome_trace_logger::stop();
+
+    size_t total = std::accumulate(sums.begin(), sums.end(), size_t(0));
+    HETCOMPUTE_ILOG("group sum %zu, chain length %zu, loop sum %d", total, chain,
+                    std::accumulate(values.begin(), values.end(), 0));
+
+    bool ok = chrome_trace_logger::write_trace(trace_file);
+    if (ok) {
+        HETCOMPUTE_ILOG("Chrome trace written to %s", trace_file);
+    } else {
+        HETCOMPUTE_ILOG("No trace written to %s: no events were recorded or the file could not be written",
+                        trace_file);
+    }
+
+    hetcompute::internal::log::dump_trace_entries();
+
+    hetcompute::runtime::shutdown();
+    return ok ? 0 : 1;
+}
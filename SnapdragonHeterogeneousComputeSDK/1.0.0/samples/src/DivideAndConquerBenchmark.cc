@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
+
+#define FIBONACCI_N 32
+#define FIBONACCI_CUTOFF 14
+#define NQUEENS_N 10
+#define NQUEENS_SEQUENTIAL_ROWS 3
+#define SORT_SIZE (1 << 20)
+#define SORT_CUTOFF 4096
+
+// Solves recursive problems with the solution-returning pdivide_and_conquer,
+// whose work tree nodes are bump allocated from one arena per invocation,
+// and with a copy of the work tree it used to build, with a make_shared per
+// subproblem and a vector of shared_ptrs per node. Reports the time and the
+// heap allocations of both.
+
+static std::atomic<size_t> num_allocations(0);
+
+void*
+operator new(size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+// The work tree pdivide_and_conquer used to build, for comparison
+namespace shared_tree {
+
+template <typename Problem, typename Solution>
+struct node {
+    explicit node(Problem p) : problem(p), solution(), subproblems() {}
+
+    Problem problem;
+    Solution solution;
+    std::vector<std::shared_ptr<node>> subproblems;
+};
+
+template <typename Problem, typename Solution, typename IsBase, typename Base, typename Split, typename Merge>
+void
+solve_node(hetcompute::task_ptr<> c, node<Problem, Solution>* n, IsBase is_base, Base base, Split split, Merge merge,
+           bool is_base_n)
+{
+    if (is_base_n) {
+        n->solution = base(n->problem);
+        return;
+    }
+    for (auto i : split(n->problem)) {
+        auto node_i = std::make_shared<node<Problem, Solution>>(i);
+        n->subproblems.push_back(node_i);
+        auto is_base_i = is_base(i);
+        auto cont_child = is_base_i ? nullptr : hetcompute::create_task([=] {
+            std::vector<Solution> sols;
+            for (auto const& m : node_i->subproblems) {
+                sols.push_back(m->solution);
+            }
+            node_i->solution = merge(i, sols);
+        });
+        auto task_child = hetcompute::create_task([=] {
+            solve_node(cont_child, node_i.get(), is_base, base, split, merge, is_base_i);
+        });
+        task_child->launch();
+        (is_base_i ? task_child : cont_child)->then(c);
+    }
+    c->launch();
+}
+
+template <typename Problem, typename Solution, typename IsBase, typename Base, typename Split, typename Merge>
+Solution
+solve(Problem p, IsBase is_base, Base base, Split split, Merge merge)
+{
+    if (is_base(p)) {
+        return base(p);
+    }
+    auto n = std::make_shared<node<Problem, Solution>>(p);
+    auto cont = hetcompute::create_task([n, p, merge] {
+        std::vector<Solution> sols;
+        for (auto const& m : n->subproblems) {
+            sols.push_back(m->solution);
+        }
+        return merge(p, sols);
+    });
+    solve_node(cont, n.get(), is_base, base, split, merge, false);
+    return cont->move_value();
+}
+
+} // namespace shared_tree
+
+
+// Fibonacci with a cut-off to sequential recursion
+static size_t
+fibonacci(size_t n)
+{
+    return n < 2 ? n : fibonacci(n - 1) + fibonacci(n - 2);
+}
+
+static auto fib_is_base = [](size_t n) { return n <= FIBONACCI_CUTOFF; };
+static auto fib_base = [](size_t n) { return fibonacci(n); };
+static auto fib_split = [](size_t n) { return std::vector<size_t>{ n - 1, n - 2 }; };
+static auto fib_merge = [](size_t, std::vector<size_t>& sols) { return sols[0] + sols[1]; };
+
+
+// N-Queens: a problem is a board with the first rows filled; it splits into
+// one subproblem per safe column of the next row.
+struct Board {
+    size_t rows;
+    int column[NQUEENS_N];
+};
+
+static bool
+is_safe(Board const& b, int column)
+{
+    for (size_t r = 0; r < b.rows; r++) {
+        int d = b.column[r] - column;
+        if (d == 0 || std::abs(d) == static_cast<int>(b.rows - r)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<Board>
+place_queen(Board const& b)
+{
+    std::vector<Board> next;
+    for (int c = 0; c < NQUEENS_N; c++) {
+        if (is_safe(b, c)) {
+            Board n = b;
+            n.column[n.rows++] = c;
+            next.push_back(n);
+        }
+    }
+    return next;
+}
+
+static size_t
+count_solutions(Board const& b)
+{
+    if (b.rows == NQUEENS_N) {
+        return 1;
+    }
+    size_t count = 0;
+    for (auto const& n : place_queen(b)) {
+        count += count_solutions(n);
+    }
+    return count;
+}
+
+static auto queens_is_base = [](Board const& b) { return b.rows >= NQUEENS_SEQUENTIAL_ROWS; };
+static auto queens_base = [](Board const& b) { return count_solutions(b); };
+static auto queens_split = [](Board const& b) { return place_queen(b); };
+static auto queens_merge = [](Board const&, std::vector<size_t>& sols) {
+    size_t count = 0;
+    for (auto s : sols) {
+        count += s;
+    }
+    return count;
+};
+
+
+// Merge sort of a slice of an array; the solution only signals completion
+struct Slice {
+    int* data;
+    size_t size;
+};
+
+static auto sort_is_base = [](Slice const& s) { return s.size <= SORT_CUTOFF; };
+static auto sort_base = [](Slice const& s) {
+    std::sort(s.data, s.data + s.size);
+    return true;
+};
+static auto sort_split = [](Slice const& s) {
+    size_t half = s.size / 2;
+    return std::vector<Slice>{ Slice{ s.data, half }, Slice{ s.data + half, s.size - half } };
+};
+static auto sort_merge = [](Slice const& s, std::vector<bool>&) {
+    std::inplace_merge(s.data, s.data + s.size / 2, s.data + s.size);
+    return true;
+};
+
+
+// Measures body with the benchmark harness and returns the heap allocations of one run
+template <typename Body>
+static size_t
+measure(benchmark::harness& bench, std::string const& name, Body body)
+{
+    size_t allocations = 0;
+    bench.measure(name, [&](benchmark::run&) {
+        size_t before = num_allocations.load();
+        body();
+        allocations = num_allocations.load() - before;
+    });
+    return allocations;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_DivideAndConquerBenchmark");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    benchmark::harness bench("DivideAndConquerBenchmark");
+    bool ok = true;
+
+    // Fibonacci
+    size_t expected_fib = fibonacci(FIBONACCI_N);
+    size_t fib = 0, fib_shared = 0;
+    size_t fib_arena_allocs = measure(bench, "fibonacci/arena", [&] {
+        fib = hetcompute::pdivide_and_conquer<size_t, size_t>(size_t(FIBONACCI_N), fib_is_base, fib_base, fib_split, fib_merge);
+    });
+    size_t fib_shared_allocs = measure(bench, "fibonacci/shared_ptr", [&] {
+        fib_shared = shared_tree::solve<size_t, size_t>(size_t(FIBONACCI_N), fib_is_base, fib_base, fib_split, fib_merge);
+    });
+    ok = ok && fib == expected_fib && fib_shared == expected_fib;
+
+    // N-Queens
+    Board empty = Board();
+    size_t expected_queens = count_solutions(empty);
+    size_t queens = 0, queens_shared = 0;
+    size_t queens_arena_allocs = measure(bench, "nqueens/arena", [&] {
+        queens = hetcompute::pdivide_and_conquer<Board, size_t>(empty, queens_is_base, queens_base, queens_split, queens_merge);
+    });
+    size_t queens_shared_allocs = measure(bench, "nqueens/shared_ptr", [&] {
+        queens_shared = shared_tree::solve<Board, size_t>(empty, queens_is_base, queens_base, queens_split, queens_merge);
+    });
+    ok = ok && queens == expected_queens && queens_shared == expected_queens;
+
+    // Merge sort, the shape of a parallel sort's recursion
+    std::vector<int> input(SORT_SIZE);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<int>((i * 2654435761u) % SORT_SIZE);
+    }
+    std::vector<int> expected_sort = input;
+    std::sort(expected_sort.begin(), expected_sort.end());
+    std::vector<int> data;
+    size_t sort_arena_allocs = measure(bench, "mergesort/arena", [&] {
+        data = input;
+        hetcompute::pdivide_and_conquer<Slice, bool>(Slice{ data.data(), data.size() }, sort_is_base, sort_base, sort_split, sort_merge);
+    });
+    ok = ok && data == expected_sort;
+    size_t sort_shared_allocs = measure(bench, "mergesort/shared_ptr", [&] {
+        data = input;
+        shared_tree::solve<Slice, bool>(Slice{ data.data(), data.size() }, sort_is_base, sort_base, sort_split, sort_merge);
+    });
+    ok = ok && data == expected_sort;
+
+    bench.report();
+    HETCOMPUTE_ILOG("heap allocations per run (arena / shared_ptr tree), tasks included:");
+    HETCOMPUTE_ILOG("  fibonacci(%d): %zu / %zu", FIBONACCI_N, fib_arena_allocs, fib_shared_allocs);
+    HETCOMPUTE_ILOG("  nqueens(%d):   %zu / %zu", NQUEENS_N, queens_arena_allocs, queens_shared_allocs);
+    HETCOMPUTE_ILOG("  mergesort(%d): %zu / %zu", SORT_SIZE, sort_arena_allocs, sort_shared_allocs);
+    HETCOMPUTE_ILOG("results %s", ok ? "correct" : "WRONG");
+
+    hetcompute::runtime::shutdown();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
+
+#define NUM_ITERATIONS (1 << 20)
+// Time a stand-in device takes per iteration, on top of computing it
+#define GPU_NS_PER_ITERATION 2
+#define DSP_NS_PER_ITERATION 20
+// The dsp stand-in gets this much slower half-way through a run, like a throttled device
+#define DSP_THROTTLE_FACTOR 4
+// Stride of the strided check, and the value of the elements it skips
+#define STRIDE 3
+#define PASS_THROUGH -1.0f
+
+// Shares NUM_ITERATIONS iterations of a kernel among the CPU and stand-ins for
+// a GPU and a DSP, first split statically by 33/33/34 loads like a
+// heterogeneous pfor_each does by default, then dynamically like it does with
+// tuner::set_dynamic_hetero(). The stand-ins compute their chunk on the CPU
+// and then wait for as long as the device they stand for would take, so this
+// runs on any host.
+//
+// A last run shares a strided range the way pfor_each_dynamic does: the gpu
+// and dsp stand-ins write into local copies of the output, which get the
+// elements skipped by the stride once before the run, and their chunks are
+// copied back once the range is drained.
+
+using hetcompute::internal::hetero::device_kind;
+using hetcompute::internal::hetero::dynamic_scheduler;
+
+static void
+kernel(const std::vector<float>& in, std::vector<float>& out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        out[i] = std::sqrt(in[i]) * 0.5f + in[i];
+    }
+}
+
+
+// Launchers of the cpu and the stand-ins. The dsp stand-in slows down once
+// half of the iterations are done.
+struct devices {
+    const std::vector<float>& in;
+    std::vector<float>&       out;
+    std::atomic<size_t>       done;
+
+    devices(const std::vector<float>& i, std::vector<float>& o) : in(i), out(o), done(0) {}
+
+    void cpu(size_t begin, size_t end) {
+        hetcompute::pfor_each(begin, end, [this](size_t i) { kernel(in, out, i, i + 1); });
+        done += end - begin;
+    }
+
+    void gpu(size_t begin, size_t end) {
+        emulate(begin, end, GPU_NS_PER_ITERATION);
+    }
+
+    void dsp(size_t begin, size_t end) {
+        bool throttled = done.load() > NUM_ITERATIONS / 2;
+        emulate(begin, end, DSP_NS_PER_ITERATION * (throttled ? DSP_THROTTLE_FACTOR : 1));
+    }
+
+    void emulate(size_t begin, size_t end, uint64_t ns_per_iteration) {
+        uint64_t start = benchmark::now_ns();
+        kernel(in, out, begin, end);
+        uint64_t device_time = (end - begin) * ns_per_iteration;
+        uint64_t elapsed = benchmark::now_ns() - start;
+        if (elapsed < device_time) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(device_time - elapsed));
+        }
+        done += end - begin;
+    }
+};
+
+
+// Each device executes its share of the range in one go
+static void
+run_static(devices& d)
+{
+    size_t gpu_end = NUM_ITERATIONS * 33 / 100;
+    size_t dsp_end = gpu_end + NUM_ITERATIONS * 34 / 100;
+
+    auto g = hetcompute::create_group();
+    g->launch([&d, gpu_end] { d.gpu(0, gpu_end); });
+    g->launch([&d, gpu_end, dsp_end] { d.dsp(gpu_end, dsp_end); });
+    d.cpu(dsp_end, NUM_ITERATIONS);
+    g->wait_for();
+}
+
+
+// Devices take chunks sized to their throughput until the range is drained
+static void
+run_dynamic(devices& d, hetcompute::pattern::chunk_stats* stats)
+{
+    dynamic_scheduler scheduler(0, NUM_ITERATIONS, 1, 1024);
+    scheduler.add_dispatcher(device_kind::cpu, [&d](size_t begin, size_t end) { d.cpu(begin, end); });
+    scheduler.add_dispatcher(device_kind::gpu, [&d](size_t begin, size_t end) { d.gpu(begin, end); });
+    scheduler.add_dispatcher(device_kind::dsp, [&d](size_t begin, size_t end) { d.dsp(begin, end); });
+    scheduler.run();
+
+    stats[0] = scheduler.get_stats(device_kind::cpu);
+    stats[1] = scheduler.get_stats(device_kind::gpu);
+    stats[2] = scheduler.get_stats(device_kind::dsp);
+}
+
+
+// Only every STRIDE-th element is computed; the others must pass through
+static bool
+run_strided(const std::vector<float>& in)
+{
+    std::vector<float> out(NUM_ITERATIONS, PASS_THROUGH);
+    std::vector<float> expected(out);
+    for (size_t i = 0; i < NUM_ITERATIONS; i += STRIDE) {
+        kernel(in, expected, i, i + 1);
+    }
+
+    auto strided = [&in](std::vector<float>& o, size_t begin, size_t end) {
+        for (size_t i = (begin + STRIDE - 1) / STRIDE * STRIDE; i < end; i += STRIDE) {
+            kernel(in, o, i, i + 1);
+        }
+    };
+
+    // Local outputs of the stand-ins, with the pass-through elements of the whole range
+    std::vector<float> gpu_out(out);
+    std::vector<float> dsp_out(out);
+
+    dynamic_scheduler scheduler(0, NUM_ITERATIONS, 1, 1024);
+    scheduler.add_dispatcher(device_kind::cpu, [&](size_t begin, size_t end) { strided(out, begin, end); });
+    size_t gpu_dispatcher = scheduler.num_dispatchers();
+    scheduler.add_dispatcher(device_kind::gpu, [&](size_t begin, size_t end) { strided(gpu_out, begin, end); });
+    size_t dsp_dispatcher = scheduler.num_dispatchers();
+    scheduler.add_dispatcher(device_kind::dsp, [&](size_t begin, size_t end) { strided(dsp_out, begin, end); });
+    scheduler.run();
+
+    for (auto const& chunk : scheduler.get_chunks(gpu_dispatcher)) {
+        std::copy(gpu_out.begin() + chunk.first, gpu_out.begin() + chunk.second, out.begin() + chunk.first);
+    }
+    for (auto const& chunk : scheduler.get_chunks(dsp_dispatcher)) {
+        std::copy(dsp_out.begin() + chunk.first, dsp_out.begin() + chunk.second, out.begin() + chunk.first);
+    }
+    return out == expected;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_HeteroSchedulingDemo");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    std::vector<float> in(NUM_ITERATIONS);
+    for (size_t i = 0; i < NUM_ITERATIONS; i++) {
+        in[i] = static_cast<float>(i % 1000);
+    }
+    std::vector<float> expected(NUM_ITERATIONS);
+    kernel(in, expected, 0, NUM_ITERATIONS);
+
+    benchmark::harness bench("HeteroSchedulingDemo");
+    std::vector<float> out(NUM_ITERATIONS);
+    hetcompute::pattern::chunk_stats stats[3];
+
+    bench.measure("static", [&](benchmark::run&) {
+        devices d(in, out);
+        run_static(d);
+    });
+    bool static_ok = out == expected;
+
+    std::fill(out.begin(), out.end(), 0.0f);
+    bench.measure("dynamic", [&](benchmark::run&) {
+        devices d(in, out);
+        run_dynamic(d, stats);
+    });
+    bool dynamic_ok = out == expected;
+
+    HETCOMPUTE_ILOG("static split:   %f ms, %s", bench.get("static").median, static_ok ? "correct" : "WRONG");
+    HETCOMPUTE_ILOG("dynamic shares: %f ms, %s", bench.get("dynamic").median, dynamic_ok ? "correct" : "WRONG");
+
+    bool strided_ok = run_strided(in);
+    HETCOMPUTE_ILOG("strided range:  %s", strided_ok ? "correct" : "WRONG");
+
+    const char* names[] = { "cpu", "gpu", "dsp" };
+    for (size_t i = 0; i < 3; i++) {
+        HETCOMPUTE_ILOG("  %s: %zu chunks, %zu iterations (%.1f%%), busy %llu us", names[i], stats[i].chunks, stats[i].iterations,
+            100.0 * stats[i].iterations / NUM_ITERATIONS, static_cast<unsigned long long>(stats[i].busy_time));
+    }
+    bench.report();
+
+    hetcompute::runtime::shutdown();
+    return static_ok && dynamic_ok && strided_ok ? 0 : 1;
+}
@@ -1,11 +1,13 @@
+#include <algorithm>
 #include <cmath>
-#include <fstream>
 #include <string.h>
-#include <sys/time.h>
+#include <vector>
 #include <hetcompute/hetcompute.hh>　　//1.0.0/include/hetcompute
 // header to include the dsp bindings, it is generated by the Hexagon SDK
 #include <include/hetcompute_dsp.h>   //3.3.3/examples/common/HetCompute_dsp/android_Debug_aarch64/ship  or /external/dsp/include
 #include <hetcompute/gpukernel.hh>    //1.0.0/include/hetcompute
+#include <hetcompute/mappedfile.hh>
+#include "BenchmarkHarness.hh"
 
 #ifdef __ANDROID__
 #define DEFAULT_INPUT_FILE "/mnt/sdcard/SampleGrayImageUncompressed.tga"
@@ -35,33 +37,16 @@ struct Point
     int y; // the row, height
 };
 
-// Describes the header structure of uncompressed TGA images.
-struct tgaheadertype
-{
-    unsigned char  _id_length, _color_map_type, _image_type;
-    unsigned short _cmap_start, _cmap_length;
-    unsigned char  _cmap_depth;
-    unsigned short _xOffset, _yOffset, _width, _height;
-    unsigned char  _pixel_depth, _image_descriptor;
-} __attribute__((packed));
-
-static unsigned char pixel_depth;
-static unsigned char image_type;
 static unsigned int  img_width;
 static unsigned int  img_height;
 static unsigned int  input_buffer_size;
 static unsigned int  output_buffer_size;
 static float*        similarity_weights;
 
-static unsigned long process_calc_time_cpu = 0;
-static unsigned long process_calc_time_gpu = 0;
-static unsigned long process_calc_time_dsp = 0;
+static benchmark::harness bench("ImageProcessingDemo", benchmark::config::from_environment(1, 3));
 using namespace hetcompute;
 
-long getCurrentTimeMsec();
 void compute_intensity_dist_weight_table();
-void read_tga(char const* file_name, Pixel*& src);
-void write_tga(char const* file_name, Pixel*& data);
 
 
 Point
@@ -77,102 +62,169 @@ clamp_to_reflection(Point p)
 }
 
 
-int
-get_neighbor_dist_to_current(Point ref, Point p, Pixel* input)
+#define SEARCH_RADIUS (SEARCH_WINDOW_SIZE / 2)
+#define PATCH_RADIUS (SIMILARITY_WINDOW_SIZE / 2)
+#define NUM_OFFSETS (SEARCH_WINDOW_SIZE * SEARCH_WINDOW_SIZE)
+// Margin of the padded copy: a patch around any pixel of a search window.
+#define PAD_MARGIN (SEARCH_RADIUS + PATCH_RADIUS)
+#define ROWS_PER_TILE 16
+
+// Reflected copy of the input with PAD_MARGIN pixels on every side, so that
+// patch reads never need clamp_to_reflection.
+struct PaddedImage
 {
-    int area = SIMILARITY_WINDOW_SIZE * SIMILARITY_WINDOW_SIZE;
-    Point p_neighbor;
-    Point ref_neighbor;
-    int   color_dist_sum = 0;
-    for (int i = 0; i < SIMILARITY_WINDOW_SIZE; i++)
+    std::vector<int> data;
+    int              stride;
+
+    int at(int x, int y) const
     {
-        for (int j = 0; j < SIMILARITY_WINDOW_SIZE; j++)
-        {
-            p_neighbor.y   = p.y - SIMILARITY_WINDOW_SIZE / 2 + i;
-            p_neighbor.x   = p.x - SIMILARITY_WINDOW_SIZE / 2 + j;
-            p_neighbor     = clamp_to_reflection(p_neighbor);
-            ref_neighbor.y = ref.y - SIMILARITY_WINDOW_SIZE / 2 + i;
-            ref_neighbor.x = ref.x - SIMILARITY_WINDOW_SIZE / 2 + j;
-            ref_neighbor   = clamp_to_reflection(ref_neighbor);
-            int dist       = input[p_neighbor.y * img_width + p_neighbor.x] - input[ref_neighbor.y * img_width + ref_neighbor.x];
-            color_dist_sum += dist * dist;
-        }
+        return data[(y + PAD_MARGIN) * stride + x + PAD_MARGIN];
     }
-    color_dist_sum /= area;
-    return color_dist_sum;
-}
+};
 
 
 void
-compute_weights(Pixel* input, Point point, float* w)
+build_padded_image(Pixel* input, PaddedImage& pad)
 {
-    /*
-     * Compute similarity using Euclidian distance in the similarity window,
-     * using equation above. reads from the input, writes int the array weights.
-     */
-    for (int i = 0; i < SEARCH_WINDOW_SIZE; i++)
+    int width  = img_width;
+    int height = img_height;
+    pad.stride = width + 2 * PAD_MARGIN;
+    pad.data.resize(pad.stride * (height + 2 * PAD_MARGIN));
+    for (int y = -PAD_MARGIN; y < height + PAD_MARGIN; y++)
     {
-        for (int j = 0; j < SEARCH_WINDOW_SIZE; j++)
+        for (int x = -PAD_MARGIN; x < width + PAD_MARGIN; x++)
         {
-            Point neighbor;
-            neighbor.x                    = point.x - SEARCH_WINDOW_SIZE / 2 + i;
-            neighbor.y                    = point.y - SEARCH_WINDOW_SIZE / 2 + j;
-            neighbor                      = clamp_to_reflection(neighbor);
-            int dist                      = get_neighbor_dist_to_current(point, neighbor, input);
-            w[i * SEARCH_WINDOW_SIZE + j] = similarity_weights[dist];
+            // Within a patch of the image this matches clamp_to_reflection. The extra
+            // clamping only keeps tiny images in bounds for offsets that are never used.
+            Point p = clamp_to_reflection(Point{ x, y });
+            p.x     = std::min(std::max(p.x, 0), width - 1);
+            p.y     = std::min(std::max(p.y, 0), height - 1);
+            pad.data[(y + PAD_MARGIN) * pad.stride + x + PAD_MARGIN] = input[p.y * img_width + p.x];
         }
     }
 }
 
 
+// Squared difference between (x, y) and (x + ox, y + oy)
+inline int
+squared_diff(PaddedImage const& pad, int x, int y, int ox, int oy)
+{
+    int dist = pad.at(x + ox, y + oy) - pad.at(x, y);
+    return dist * dist;
+}
+
+
 /*
- * Create task for processing each pixel:
+ * Denoises the rows [y_begin, y_end).
+ *
+ * For every search offset the patch distance is a 7x7 box sum of squared
+ * differences between the image and its shifted copy. We keep the vertical
+ * sums of each column running down the tile and slide a horizontal window
+ * over them, so each pixel costs O(1) per offset instead of a full patch
+ * comparison. The weighted average then walks the search window in the same
+ * order as before, so the output is bit-identical.
  */
 void
-denoise_image_process_for_cpu(Pixel* input, Pixel* output)
+denoise_rows(Pixel* input, Pixel* output, PaddedImage const& pad, int y_begin, int y_end)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    int width = img_width;
+    int area  = SIMILARITY_WINDOW_SIZE * SIMILARITY_WINDOW_SIZE;
+    // Columns whose vertical sums feed the horizontal windows of a row
+    int span = width + 2 * PATCH_RADIUS;
 
-    // Create a reusable: w[SEARCH_WINDOW_SIZE][SEARCH_WINDOW_SIZE].
-    float w[SEARCH_WINDOW_SIZE * SEARCH_WINDOW_SIZE];
+    // Scratch owned by this tile: running column sums per offset, and the
+    // patch distances of the current row, laid out per pixel.
+    std::vector<int> column_sums(NUM_OFFSETS * span);
+    std::vector<int> dists(width * NUM_OFFSETS);
 
-    auto g = hetcompute::create_group("denoise_task_per_pixel");
-    // Iterate through all points in the input image
-    for (int y = 0; y < img_height; y++)
+    for (int y = y_begin; y < y_end; y++)
     {
-        for (int x = 0; x < img_width; x++)
+        for (int k = 0; k < NUM_OFFSETS; k++)
         {
-            g->launch([x, y, &w, input, &output] {
-                // Compute weights for points in the search window.
-                compute_weights(input, Point{ x, y }, w);
-                float weight_sum = 0;
-                float temp       = 0;
-                // Denoise: compute the weighted average for this point.
-                for (int i = 0; i < SEARCH_WINDOW_SIZE; i++)
+            int  ox   = k / SEARCH_WINDOW_SIZE - SEARCH_RADIUS;
+            int  oy   = k % SEARCH_WINDOW_SIZE - SEARCH_RADIUS;
+            int* sums = &column_sums[k * span];
+
+            for (int c = 0; c < span; c++)
+            {
+                int x = c - PATCH_RADIUS;
+                if (y == y_begin)
                 {
-                    for (int j = 0; j < SEARCH_WINDOW_SIZE; j++)
+                    sums[c] = 0;
+                    for (int dy = -PATCH_RADIUS; dy <= PATCH_RADIUS; dy++)
                     {
-                        Point neighbor;
-                        neighbor.x = x - SEARCH_WINDOW_SIZE / 2 + i;
-                        neighbor.y = y - SEARCH_WINDOW_SIZE / 2 + j;
-                        neighbor   = clamp_to_reflection(neighbor);
-                        temp += w[i * SEARCH_WINDOW_SIZE + j] * input[neighbor.y * img_width + neighbor.x];
-                        weight_sum += w[i * SEARCH_WINDOW_SIZE + j];
+                        sums[c] += squared_diff(pad, x, y + dy, ox, oy);
                     }
                 }
+                else
+                {
+                    sums[c] += squared_diff(pad, x, y + PATCH_RADIUS, ox, oy) - squared_diff(pad, x, y - PATCH_RADIUS - 1, ox, oy);
+                }
+            }
+
+            int sum = 0;
+            for (int c = 0; c < 2 * PATCH_RADIUS; c++)
+            {
+                sum += sums[c];
+            }
+            for (int x = 0; x < width; x++)
+            {
+                sum += sums[x + 2 * PATCH_RADIUS];
+                dists[x * NUM_OFFSETS + k] = sum / area;
+                sum -= sums[x];
+            }
+        }
+
+        for (int x = 0; x < width; x++)
+        {
+            // Search window positions are reflected at the border, which maps
+            // them to other offsets of the same window.
+            int map_x[SEARCH_WINDOW_SIZE];
+            int map_y[SEARCH_WINDOW_SIZE];
+            for (int i = 0; i < SEARCH_WINDOW_SIZE; i++)
+            {
+                Point neighbor = clamp_to_reflection(Point{ x - SEARCH_RADIUS + i, y - SEARCH_RADIUS + i });
+                map_x[i]       = neighbor.x;
+                map_y[i]       = neighbor.y;
+            }
 
-                temp /= weight_sum;
-                output[y * img_width + x] = static_cast<Pixel>(temp);
-            });
+            int const* d          = &dists[x * NUM_OFFSETS];
+            float      weight_sum = 0;
+            float      temp       = 0;
+            for (int i = 0; i < SEARCH_WINDOW_SIZE; i++)
+            {
+                for (int j = 0; j < SEARCH_WINDOW_SIZE; j++)
+                {
+                    int   k = (map_x[i] - x + SEARCH_RADIUS) * SEARCH_WINDOW_SIZE + (map_y[j] - y + SEARCH_RADIUS);
+                    float w = similarity_weights[d[k]];
+                    temp += w * input[map_y[j] * img_width + map_x[i]];
+                    weight_sum += w;
+                }
+            }
+
+            temp /= weight_sum;
+            output[y * img_width + x] = static_cast<Pixel>(temp);
         }
     }
+}
 
-    begin_process_time = getCurrentTimeMsec();
-    g->wait_for(); // wait for all the tasks to complete
-    end_process_time = getCurrentTimeMsec();
 
-    process_calc_time_cpu += (end_process_time - begin_process_time);
+/*
+ * Split the image into row tiles and denoise them in parallel:
+ */
+void
+denoise_image_process_for_cpu(Pixel* input, Pixel* output, benchmark::run& run)
+{
+    PaddedImage pad;
+    run.time("pad", [input, &pad] { build_padded_image(input, pad); });
+
+    auto compute = run.phase("compute");
+    int num_tiles = (img_height + ROWS_PER_TILE - 1) / ROWS_PER_TILE;
+    hetcompute::pfor_each(0, num_tiles, [input, output, &pad](int tile) {
+        int y_begin = tile * ROWS_PER_TILE;
+        int y_end   = std::min(y_begin + ROWS_PER_TILE, static_cast<int>(img_height));
+        denoise_rows(input, output, pad, y_begin, y_end);
+    });
 }
 
 
@@ -287,29 +339,24 @@ OCL_KERNEL(image_kernel,
 });
 
 void
-denoise_image_process_for_gpu(Pixel* input, Pixel* output)
+denoise_image_process_for_gpu(Pixel* input, Pixel* output, benchmark::run& run)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    auto copy_in = run.phase("copy-in");
 
-    // create HetComputeSDK buffer
-    auto input_buffer = hetcompute::create_buffer<unsigned char>(input_buffer_size, hetcompute::device_set({ hetcompute::gpu }));
+    // create HetComputeSDK buffer, the input one directly on the mapped image pixels
+    auto input_buffer = hetcompute::create_buffer<unsigned char>(input, input_buffer_size, hetcompute::device_set({ hetcompute::gpu }));
     auto output_buffer = hetcompute::create_buffer<float>(output_buffer_size, hetcompute::device_set({ hetcompute::gpu }));
     auto similarity_weights_buffer = hetcompute::create_buffer<float>(MAX_DIST, hetcompute::device_set({ hetcompute::gpu }));
 
     // Init HetComputeSDK buffer
-    input_buffer.acquire_wi();
     similarity_weights_buffer.acquire_wi();
-    for (size_t x = 0; x < input_buffer_size; x++) {
-        input_buffer[x] = input[x];
-    }
-
     for (size_t y = 0; y < MAX_DIST; y++) {
         similarity_weights_buffer[y] = similarity_weights[y];
     }
-    input_buffer.release();
     similarity_weights_buffer.release();
+    copy_in.stop();
 
+    auto launch = run.phase("launch");
     // create GPU kernel
     auto gk = hetcompute::create_gpu_kernel<hetcompute::buffer_ptr<const unsigned char>, 
                                             hetcompute::buffer_ptr<float>, 
@@ -331,14 +378,12 @@ denoise_image_process_for_gpu(Pixel* input, Pixel* output)
 
     // Launch the task on the gpu
     gpu_task->launch();
+    launch.stop();
 
     // Wait for task completion.
-    begin_process_time = getCurrentTimeMsec();
-    gpu_task->wait_for();
-    end_process_time = getCurrentTimeMsec();
-
-    process_calc_time_gpu += (end_process_time - begin_process_time);
+    run.time("wait", [&gpu_task] { gpu_task->wait_for(); });
 
+    auto copy_out = run.phase("copy-out");
     output_buffer.acquire_ro();
     for (size_t count = 0; count < output_buffer.size(); count++) {
         output[count] = static_cast<Pixel>(output_buffer[count]);
@@ -348,33 +393,31 @@ denoise_image_process_for_gpu(Pixel* input, Pixel* output)
 
 
 void
-denoise_image_process_for_dsp(Pixel* input, Pixel* output)
+denoise_image_process_for_dsp(Pixel* input, Pixel* output, benchmark::run& run)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    auto copy_in = run.phase("copy-in");
 
-    // create HetComputeSDK buffer
-    auto input_buffer = hetcompute::create_buffer<char>(input_buffer_size, hetcompute::device_set({ hetcompute::dsp }));
+    // create HetComputeSDK buffer, the input one directly on the mapped image pixels
+    auto input_buffer = hetcompute::create_buffer<char>(reinterpret_cast<char*>(input), input_buffer_size, hetcompute::device_set({ hetcompute::dsp }));
     auto output_buffer = hetcompute::create_buffer<float>(output_buffer_size, hetcompute::device_set({ hetcompute::dsp }));
     auto similarity_weights_buffer = hetcompute::create_buffer<float>(MAX_DIST, hetcompute::device_set({ hetcompute::dsp }));
 
     // Init HetComputeSDK buffer
-    input_buffer.acquire_wi();
     similarity_weights_buffer.acquire_wi();
-    for (size_t x = 0; x < input_buffer_size; x++) {
-        input_buffer[x] = static_cast<Pixel>(input[x]);
-    }
-
     for (size_t y = 0; y < MAX_DIST; y++) {
         similarity_weights_buffer[y] = similarity_weights[y];
     }
-    input_buffer.release();
     similarity_weights_buffer.release();
+    copy_in.stop();
 
+    auto launch = run.phase("launch");
     // Create task group
     auto dg = hetcompute::create_group();
 
     // create DSP kernel
+    // hetcompute_dsp_denoise_image_process_tile denoises a band of rows per call, but the
+    // prebuilt stub and skel libraries in external/dsp do not export it yet (see the
+    // README there), so the sample keeps launching one task per pixel.
     auto dk = hetcompute::create_dsp_kernel<>(hetcompute_dsp_denoise_image_process);
 
     // Launch the task on the dsp
@@ -386,12 +429,11 @@ denoise_image_process_for_dsp(Pixel* input, Pixel* output)
         }
     }
 
-    begin_process_time = getCurrentTimeMsec();
-    dg->wait_for();
-    end_process_time = getCurrentTimeMsec();
+    launch.stop();
 
-    process_calc_time_dsp += (end_process_time - begin_process_time);
+    run.time("wait", [&dg] { dg->wait_for(); });
 
+    auto copy_out = run.phase("copy-out");
     output_buffer.acquire_ro();
     for (size_t count = 0; count < output_buffer.size(); count++) {
         output[count] = static_cast<Pixel>(output_buffer[count]);
@@ -419,41 +461,65 @@ main(int argc, char *argv[])
             inputfile = DEFAULT_INPUT_FILE;
         }
 
-        // Load image file
-        Pixel* input_img_data = nullptr;
-        read_tga(inputfile, input_img_data);                           //函数调用
-        output_buffer_size = img_width * img_height * sizeof(Pixel);
-        Pixel* output_img_data = new Pixel[output_buffer_size];
+        // Map the image file: pixels are paged in as they are read, and fed to the
+        // gpu and dsp buffers without copies.
+        hetcompute::io::mapped_image input_img(inputfile);
+        img_width  = input_img.width();
+        img_height = input_img.height();
+        HETCOMPUTE_ILOG("image format: %s, bytes per pixel: %d, width: %d, height: %d\n",
+                        input_img.info().format == hetcompute::io::image_format::tga ? "tga" : "pgm",
+                        int(input_img.info().bytes_per_pixel),
+                        int(img_width),
+                        int(img_height));
+        if (input_img.info().bytes_per_pixel != 1)
+            HETCOMPUTE_FATAL("PROCESSING GRAY IMAGE WITH DEPTH OF 1 BYTE ONLY\n");
+
+        Pixel* input_img_data = input_img.pixels();
+        input_buffer_size     = input_img.size();
+        output_buffer_size    = img_width * img_height * sizeof(Pixel);
+
+        // The outputs are mapped too, and written back when flushed.
+        auto output_img_cpu = hetcompute::io::mapped_image::create(output_filename_cpu, input_img.info());
+        auto output_img_gpu = hetcompute::io::mapped_image::create(output_filename_gpu, input_img.info());
+        auto output_img_dsp = hetcompute::io::mapped_image::create(output_filename_dsp, input_img.info());
 
         // Begin process image
         // Create a table for note dist weight
         compute_intensity_dist_weight_table();                          //! == !
 
         // Begin cpu process
-        memset(output_img_data, 0, output_buffer_size);
-        denoise_image_process_for_cpu(input_img_data, output_img_data);
-        write_tga(output_filename_cpu, output_img_data);
+        Pixel* output_cpu_data = output_img_cpu.pixels();
+        bench.measure("cpu", [input_img_data, output_cpu_data](benchmark::run& run) {
+            memset(output_cpu_data, 0, output_buffer_size);
+            denoise_image_process_for_cpu(input_img_data, output_cpu_data, run);
+        });
+        output_img_cpu.flush();
         HETCOMPUTE_ILOG("denoise_image_cpu Completed.");
 
 
         // Begin gpu process
-        memset(output_img_data, 0, output_buffer_size);
-        denoise_image_process_for_gpu(input_img_data, output_img_data);
-        write_tga(output_filename_gpu, output_img_data);
+        Pixel* output_gpu_data = output_img_gpu.pixels();
+        bench.measure("gpu", [input_img_data, output_gpu_data](benchmark::run& run) {
+            memset(output_gpu_data, 0, output_buffer_size);
+            denoise_image_process_for_gpu(input_img_data, output_gpu_data, run);
+        });
+        output_img_gpu.flush();
         HETCOMPUTE_ILOG("denoise_image_gpu Completed.");
 
         // Begin dsp process
-        memset(output_img_data, 0, output_buffer_size);
-        denoise_image_process_for_dsp(input_img_data, output_img_data);
-        write_tga(output_filename_dsp, output_img_data);
+        Pixel* output_dsp_data = output_img_dsp.pixels();
+        bench.measure("dsp", [input_img_data, output_dsp_data](benchmark::run& run) {
+            memset(output_dsp_data, 0, output_buffer_size);
+            denoise_image_process_for_dsp(input_img_data, output_dsp_data, run);
+        });
+        output_img_dsp.flush();
         HETCOMPUTE_ILOG("denoise_image_dsp Completed.");
 
-        delete [] input_img_data;
-        delete [] output_img_data;
         delete [] similarity_weights;
-        HETCOMPUTE_ILOG("******CPU -- Running CPU proccess image total time is: %ld ms", process_calc_time_cpu);
-        HETCOMPUTE_ILOG("@@@@@@GPU -- Running GPU proccess image total time is: %ld ms", process_calc_time_gpu);
-        HETCOMPUTE_ILOG("&&&&&&DSP -- Running DSP proccess image total time is: %ld ms", process_calc_time_dsp);
+        HETCOMPUTE_ILOG("******CPU -- Running CPU proccess image median time is: %f ms", bench.get("cpu").median);
+        HETCOMPUTE_ILOG("@@@@@@GPU -- Running GPU proccess image median time is: %f ms", bench.get("gpu").median);
+        HETCOMPUTE_ILOG("&&&&&&DSP -- Running DSP proccess image median time is: %f ms", bench.get("dsp").median);
+        bench.report();
     }
 
     
@@ -461,23 +527,6 @@ main(int argc, char *argv[])
     return 0;
 }
 
-long
-getCurrentTimeMsec()
-{
-    long msec = 0;
-    char str[20] = {0};
-    struct timeval stuCurrentTime;
-
-    gettimeofday(&stuCurrentTime, NULL);
-    sprintf(str, "%ld%03ld", stuCurrentTime.tv_sec, (stuCurrentTime.tv_usec) / 1000);
-
-    for (int i = 0; i < strlen(str); i++) {
-        msec = msec * 10 + (str[i] - '0');
-    }
-
-    return msec;
-}
-
 void
 compute_intensity_dist_weight_table()
 {
@@ -494,54 +543,3 @@ compute_intensity_dist_weight_table()
         similarity_weights[dist] = w;
     }
 }
-
-void
-read_tga(char const* file_name, Pixel*& src)
-{
-    std::ifstream tga(file_name, std::ios::binary);
-    if (!tga.is_open())
-    {
-        HETCOMPUTE_FATAL("Could not open src image file: %s", file_name);
-    }
-    tgaheadertype tga_header;
-    tga.read(reinterpret_cast<char*>(&tga_header), sizeof(tga_header));
-    img_width  = tga_header._width;
-    img_height = tga_header._height;
-
-    pixel_depth = tga_header._pixel_depth;
-    image_type  = tga_header._image_type;
-    HETCOMPUTE_ILOG("image format: %d, pixel depth: %d, width: %d, height: %d\n",
-                    int(tga_header._image_type),
-                    int(tga_header._pixel_depth),
-                    int(img_width),
-                    int(img_height));
-
-    if (pixel_depth != 8)
-        HETCOMPUTE_FATAL("PROCESSING GRAY IMAGE WITH DEPTH OF 1 BYTE ONLY\n");
-
-    int bytes_per_pixel = int(tga_header._pixel_depth) / 8;
-    input_buffer_size = img_width * img_height * bytes_per_pixel * sizeof(Pixel);
-    src = new Pixel[input_buffer_size];
-    tga.read(reinterpret_cast<char*>(src), img_width * img_height * bytes_per_pixel * sizeof(Pixel));
-}
-
-void
-write_tga(char const* file_name, Pixel*& data)
-{
-    tgaheadertype tga_header;
-    HETCOMPUTE_ILOG("tga header size: %d\n", int(sizeof(tga_header)));
-    memset(&tga_header, 0, sizeof(tga_header));
-    tga_header._image_type  = image_type;
-    tga_header._width       = img_width;
-    tga_header._height      = img_height;
-    tga_header._pixel_depth = pixel_depth; // grey image 8
-
-    std::ofstream tga(file_name, std::ios::binary);
-    if (!tga.is_open())
-    {
-        HETCOMPUTE_FATAL("Could not open output image file: %s", file_name);
-    }
-
-    tga.write(reinterpret_cast<char*>(&tga_header), sizeof(tga_header));
-    tga.write(reinterpret_cast<char*>(data), img_width * img_height * sizeof(Pixel));
-}
\ No newline at end of file
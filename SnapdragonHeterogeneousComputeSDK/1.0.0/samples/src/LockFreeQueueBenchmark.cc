@@ -0,0 +1,130 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include <hetcompute/bounded_lfqueue.hh>
+
+#define QUEUE_LOG_SIZE 10
+#define ITEMS_PER_PRODUCER 200000
+#define MAX_THREAD_PAIRS 8
+
+// Pipeline style payload that does not fit in a machine word, up to a cache line.
+struct QueueItem {
+    size_t index;
+    size_t iteration;
+    double value[6];
+};
+
+
+double run_slot_queue(size_t thread_pairs);
+double run_boxed_queue(size_t thread_pairs);
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_LockFreeQueueBenchmark");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    HETCOMPUTE_ILOG("bounded_lfqueue push/pop of a %zu byte item, %d items per producer.",
+        sizeof(QueueItem), ITEMS_PER_PRODUCER);
+
+    for (size_t pairs = 1; pairs <= MAX_THREAD_PAIRS; pairs *= 2) {
+        // Slot path: bounded_lfqueue<QueueItem> recycles its preallocated slots.
+        double slot_time = run_slot_queue(pairs);
+        // Boxed path: every push allocates and every pop frees, like the queue used to do internally.
+        double boxed_time = run_boxed_queue(pairs);
+
+        HETCOMPUTE_ILOG("%zu producers / %zu consumers: slots %f ms, new/delete %f ms, speedup %.2fx",
+            pairs, pairs, slot_time, boxed_time, boxed_time / slot_time);
+    }
+
+    hetcompute::runtime::shutdown();
+    return 0;
+}
+
+
+// Runs thread_pairs producers and consumers over queue and returns the elapsed time in ms.
+template <typename Queue, typename Push, typename Pop>
+double run_queue(Queue& queue, size_t thread_pairs, Push push, Pop pop)
+{
+    std::atomic<size_t> popped(0);
+    size_t total = thread_pairs * ITEMS_PER_PRODUCER;
+    std::vector<std::thread> threads;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    for (size_t t = 0; t < thread_pairs; t++) {
+        threads.emplace_back([&queue, push, t] {
+            for (size_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                while (!push(queue, t, i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&queue, &popped, pop, total] {
+            while (popped.load(std::memory_order_relaxed) < total) {
+                if (pop(queue)) {
+                    popped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+
+double run_slot_queue(size_t thread_pairs)
+{
+    hetcompute::bounded_lfqueue<QueueItem> queue(QUEUE_LOG_SIZE);
+
+    return run_queue(queue, thread_pairs,
+                     [](hetcompute::bounded_lfqueue<QueueItem>& q, size_t t, size_t i) {
+                         QueueItem item = {i, t, {0}};
+                         return q.push(item);
+                     },
+                     [](hetcompute::bounded_lfqueue<QueueItem>& q) {
+                         QueueItem item;
+                         return q.pop(item);
+                     });
+}
+
+
+double run_boxed_queue(size_t thread_pairs)
+{
+    hetcompute::bounded_lfqueue<QueueItem*> queue(QUEUE_LOG_SIZE);
+
+    return run_queue(queue, thread_pairs,
+                     [](hetcompute::bounded_lfqueue<QueueItem*>& q, size_t t, size_t i) {
+                         QueueItem* item = new QueueItem{i, t, {0}};
+                         if (!q.push(item)) {
+                             delete item;
+                             return false;
+                         }
+                         return true;
+                     },
+                     [](hetcompute::bounded_lfqueue<QueueItem*>& q) {
+                         QueueItem* item;
+                         if (!q.pop(item)) {
+                             return false;
+                         }
+                         QueueItem copy = *item;
+                         HETCOMPUTE_UNUSED(copy);
+                         delete item;
+                         return true;
+                     });
+}
@@ -1,12 +1,13 @@
 #include <pthread.h>
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <string.h>
-#include <sys/time.h>
 #include <hetcompute/hetcompute.hh>
 // header to include the dsp bindings, it is generated by the Hexagon SDK
 #include <include/hetcompute_dsp.h>
 #include <hetcompute/gpukernel.hh>
+#include "BenchmarkHarness.hh"
 
 static int array_size = 0;
 static int loop_number = 0;
@@ -16,36 +17,28 @@ static bool thread_flag_cpu = false;
 static bool thread_flag_gpu = false;
 static bool thread_flag_dsp = false;
 
-static unsigned long process_calc_time_cpu = 0;
-static unsigned long process_calc_time_gpu = 0;
-static unsigned long process_calc_time_dsp = 0;
-
 static unsigned int arrayDivisor = 0;
 
 pthread_mutex_t mutex_lock;
 
-long getCurrentTimeMsec()
-{
-    long msec = 0;
-    char str[20] = {0};
-    struct timeval stuCurrentTime;
+// Slices of the shared input and output buffers processed by one device
+struct partition {
+    hetcompute::buffer_ptr<int> in;
+    hetcompute::buffer_ptr<int> out;
+};
 
-    gettimeofday(&stuCurrentTime, NULL);
-    sprintf(str, "%ld%03ld", stuCurrentTime.tv_sec, (stuCurrentTime.tv_usec) / 1000);
+static partition cpu_partition;
+static partition gpu_partition;
+static partition dsp_partition;
 
-    for (int i = 0; i < strlen(str); i++) {
-        msec = msec * 10 + (str[i] - '0');
-    }
-
-    return msec;
-}
+static benchmark::harness bench("MatrixAlgorithmDemo", benchmark::config::from_environment(1, 5));
 
 
 void run_CPU(hetcompute::buffer_ptr<const int> matrixA,  
-             hetcompute::buffer_ptr<int> matrixB)
+             hetcompute::buffer_ptr<int> matrixB,
+             benchmark::run& run)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    auto copy_in = run.phase("copy-in");
     int arrayLen = matrixA.size();
 
     int* input_data = new int[arrayLen * sizeof(int)];
@@ -56,6 +49,9 @@ void run_CPU(hetcompute::buffer_ptr<const int> matrixA,
         input_data[index] = matrixA[index];
     }
     matrixA.release();
+    copy_in.stop();
+
+    auto launch = run.phase("launch");
     // The CPU kernel infers the access directions
     auto cg = hetcompute::create_group("Calculate array value");
 
@@ -71,10 +67,9 @@ void run_CPU(hetcompute::buffer_ptr<const int> matrixA,
         });
     }
 
-    begin_process_time = getCurrentTimeMsec();
-    cg->wait_for();
-    end_process_time = getCurrentTimeMsec();
-    process_calc_time_cpu += (end_process_time - begin_process_time);
+    launch.stop();
+
+    run.time("wait", [&cg] { cg->wait_for(); });
 
     /*// print matrixB
     matrixB.acquire_ro();
@@ -100,10 +95,10 @@ OCL_KERNEL(matrix_kernel, __kernel void user_function_gpu(__global int* A, __glo
 });
 
 void run_GPU(hetcompute::buffer_ptr<const int> matrixA, 
-             hetcompute::buffer_ptr<int> matrixB)
+             hetcompute::buffer_ptr<int> matrixB,
+             benchmark::run& run)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    auto launch = run.phase("launch");
 
     // create GPU kernel
     auto gk = hetcompute::create_gpu_kernel<hetcompute::buffer_ptr<const int>, 
@@ -113,11 +108,9 @@ void run_GPU(hetcompute::buffer_ptr<const int> matrixA,
     // launch GPU kernel over 2D range
     auto t = hetcompute::launch(gk, hetcompute::range<2>(matrixB.size(), loop_number), matrixA, matrixB);
 
-    begin_process_time = getCurrentTimeMsec();
-    t->wait_for();
-    end_process_time = getCurrentTimeMsec();
+    launch.stop();
 
-    process_calc_time_gpu += (end_process_time - begin_process_time);
+    run.time("wait", [&t] { t->wait_for(); });
 
     /*// print matrixB
     matrixB.acquire_ro();
@@ -129,10 +122,10 @@ void run_GPU(hetcompute::buffer_ptr<const int> matrixA,
 
 
 void run_DSP(hetcompute::buffer_ptr<const int> matrixA, 
-             hetcompute::buffer_ptr<int> matrixB)
+             hetcompute::buffer_ptr<int> matrixB,
+             benchmark::run& run)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    auto launch = run.phase("launch");
 
     auto dg = hetcompute::create_group();
     auto dk = hetcompute::create_dsp_kernel<>(hetcompute_dsp_matrix_buffer);
@@ -141,11 +134,9 @@ void run_DSP(hetcompute::buffer_ptr<const int> matrixA,
         dg->launch(dk, matrixA, matrixB);
     }
 
-    begin_process_time = getCurrentTimeMsec();
-    dg->wait_for();
-    end_process_time = getCurrentTimeMsec();
+    launch.stop();
 
-    process_calc_time_dsp += (end_process_time - begin_process_time);
+    run.time("wait", [&dg] { dg->wait_for(); });
 
     /*// print matrixB
     matrixB.acquire_ro();
@@ -156,23 +147,93 @@ void run_DSP(hetcompute::buffer_ptr<const int> matrixA,
 }
 
 
+// GEMM: matrixC = matrixA * matrixB on side x side float matrices, with the
+// blocked GEMM kernels instead of hand-rolled loops
+void run_GEMM_CPU(hetcompute::buffer_ptr<const float> matrixA,
+                  hetcompute::buffer_ptr<const float> matrixB,
+                  hetcompute::buffer_ptr<float> matrixC,
+                  int side,
+                  benchmark::run& run)
+{
+    auto acquire = run.phase("acquire");
+    matrixA.acquire_ro();
+    matrixB.acquire_ro();
+    matrixC.acquire_wi();
+    acquire.stop();
+
+    run.time("gemm", [&] {
+        hetcompute::pgemm(side, side, side, static_cast<const float*>(matrixA.host_data()),
+                          static_cast<const float*>(matrixB.host_data()), static_cast<float*>(matrixC.host_data()));
+    });
+
+    matrixA.release();
+    matrixB.release();
+    matrixC.release();
+}
+
+
+void run_GEMM_DSP(hetcompute::buffer_ptr<const float> matrixA,
+                  hetcompute::buffer_ptr<const float> matrixB,
+                  hetcompute::buffer_ptr<float> matrixC,
+                  int side,
+                  benchmark::run& run)
+{
+    auto launch = run.phase("launch");
+
+    auto dg = hetcompute::create_group();
+    // hetcompute_dsp_matmul is exported by the prebuilt stub and skel libraries.
+    // Rebuilt from external/dsp, it runs the blocked hetcompute_gemm_f32 kernel.
+    auto dk = hetcompute::create_dsp_kernel<>(hetcompute_dsp_matmul);
+
+    // One band of rows of C per DSP hardware thread, over the same 2D range
+    // (rows, columns) as the CPU kernel. matmul takes the sizes as M, K, N.
+    int num_tiles = std::max(static_cast<int>(hetcompute::internal::num_dsp_execution_contexts()), 1);
+    int rows_per_tile = (side + num_tiles - 1) / num_tiles;
+    for (int first_x = 0; first_x < side; first_x += rows_per_tile) {
+        dg->launch(dk, first_x, std::min(first_x + rows_per_tile, side), 0, side,
+                   matrixA, matrixB, matrixC, side, side, side);
+    }
+
+    launch.stop();
+
+    run.time("wait", [&dg] { dg->wait_for(); });
+}
+
+
+// Compares C with a naive product, with a tolerance since the sums are reordered
+static bool check_GEMM(hetcompute::buffer_ptr<const float> matrixA,
+                       hetcompute::buffer_ptr<const float> matrixB,
+                       hetcompute::buffer_ptr<float> matrixC,
+                       int side)
+{
+    bool ok = true;
+    matrixA.acquire_ro();
+    matrixB.acquire_ro();
+    matrixC.acquire_ro();
+    for (int i = 0; i < side && ok; i++) {
+        for (int j = 0; j < side && ok; j++) {
+            float expected = 0.0f;
+            for (int k = 0; k < side; k++) {
+                expected += matrixA[i * side + k] * matrixB[k * side + j];
+            }
+            ok = std::abs(matrixC[i * side + j] - expected) <= 1e-3f * std::max(1.0f, std::abs(expected));
+        }
+    }
+    matrixA.release();
+    matrixB.release();
+    matrixC.release();
+    return ok;
+}
+
+
 // function for processor thread
 // CPU thread
 static void* cpu_pthread(void *arg)
 {
-    unsigned int* tmp = (unsigned int*)arg;
-
-    auto A = hetcompute::create_buffer<int>(arrayDivisor, hetcompute::device_set({ hetcompute::cpu }));
-    auto B = hetcompute::create_buffer<int>(arrayDivisor, hetcompute::device_set({ hetcompute::cpu }));
-    // initialize the input array
-    A.acquire_wi();
-    for (size_t count = 0; count < arrayDivisor; count++) {
-        A[count] = tmp[count];
-    }
-    A.release();
+    partition* part = (partition*)arg;
 
     pthread_mutex_lock(&mutex_lock);
-    run_CPU(A, B);
+    bench.measure("cpu", [part](benchmark::run& run) { run_CPU(part->in, part->out, run); });
     pthread_mutex_unlock(&mutex_lock);
 
     thread_flag_cpu = true;
@@ -183,19 +244,10 @@ static void* cpu_pthread(void *arg)
 // GPU thread
 static void* gpu_pthread(void *arg)
 {
-    unsigned int* tmp = (unsigned int*)arg;
-
-    auto A = hetcompute::create_buffer<int>(arrayDivisor, hetcompute::device_set({ hetcompute::gpu }));
-    auto B = hetcompute::create_buffer<int>(arrayDivisor, hetcompute::device_set({ hetcompute::gpu }));
-    // initialize the input array
-    A.acquire_wi();
-    for (size_t count = arrayDivisor; count < (2 * arrayDivisor); count++) {
-        A[count - arrayDivisor] = tmp[count];
-    }
-    A.release();
+    partition* part = (partition*)arg;
 
     pthread_mutex_lock(&mutex_lock);
-    run_GPU(A, B);
+    bench.measure("gpu", [part](benchmark::run& run) { run_GPU(part->in, part->out, run); });
     pthread_mutex_unlock(&mutex_lock);
 
     thread_flag_gpu = true;
@@ -206,19 +258,10 @@ static void* gpu_pthread(void *arg)
 // DSP thread
 static void* dsp_pthread(void *arg)
 {
-    unsigned int* tmp = (unsigned int*)arg;
-
-    auto A = hetcompute::create_buffer<int>((array_size - (2 * arrayDivisor)), hetcompute::device_set({ hetcompute::dsp }));
-    auto B = hetcompute::create_buffer<int>((array_size - (2 * arrayDivisor)), hetcompute::device_set({ hetcompute::dsp }));
-    // initialize the input array
-    A.acquire_wi();
-    for (size_t count = 2 * arrayDivisor; count < array_size; count++) {
-        A[count - (2 * arrayDivisor)] = tmp[count];
-    }
-    A.release();
+    partition* part = (partition*)arg;
 
     pthread_mutex_lock(&mutex_lock);
-    run_DSP(A, B);
+    bench.measure("dsp", [part](benchmark::run& run) { run_DSP(part->in, part->out, run); });
     pthread_mutex_unlock(&mutex_lock);
 
     thread_flag_dsp = true;
@@ -240,6 +283,7 @@ main(int argc, char *argv[])
             HETCOMPUTE_ILOG("eg: array_size: is create buffer size.");
             HETCOMPUTE_ILOG("eg: loop_number: is Number of cycles calculated work_method");
             HETCOMPUTE_ILOG("eg: work_method: is processor method. 1 is serial(cpu->gpu->dsp). 2 is parallel(cpu&gpu&dsp)");
+            HETCOMPUTE_ILOG("eg:              3 is matrix multiplication of array_size x array_size matrices (cpu->dsp)");
             HETCOMPUTE_ILOG("./hetcompute_sample_MatrixAlgorithmDemo 1000 20 1");
             HETCOMPUTE_ILOG("******************************************************************************************");
 
@@ -260,10 +304,48 @@ main(int argc, char *argv[])
 
         work_method = atoi(argv[3]);
         if (work_method <= 0) {
-            HETCOMPUTE_ILOG("Input work_method <= 0 is wrong. Please re-input work_method. 1 or 2");
+            HETCOMPUTE_ILOG("Input work_method <= 0 is wrong. Please re-input work_method. 1, 2 or 3");
             return -1;
         }
 
+        if (work_method == 3) {
+            HETCOMPUTE_ILOG("******************************************************************************************");
+            HETCOMPUTE_ILOG("We will multiply two random %d x %d float matrices with the blocked GEMM kernels.", array_size, array_size);
+            HETCOMPUTE_ILOG("CPU->DSP will running matrixC = matrixA * matrixB, with hetcompute::pgemm and hetcompute_dsp_matmul.");
+            HETCOMPUTE_ILOG("******************************************************************************************");
+
+            int side = array_size;
+            auto devices = hetcompute::device_set({ hetcompute::dsp, hetcompute::cpu });
+            auto GA = hetcompute::create_buffer<float>(side * side, devices);
+            auto GB = hetcompute::create_buffer<float>(side * side, devices);
+            auto GC = hetcompute::create_buffer<float>(side * side, devices);
+
+            std::mt19937 generator(2019);
+            std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+            GA.acquire_wi();
+            GB.acquire_wi();
+            for (int i = 0; i < side * side; i++) {
+                GA[i] = dist(generator);
+                GB[i] = dist(generator);
+            }
+            GA.release();
+            GB.release();
+
+            bench.measure("gemm-cpu", [&](benchmark::run& run) { run_GEMM_CPU(GA, GB, GC, side, run); });
+            bool cpu_ok = check_GEMM(GA, GB, GC, side);
+
+            bench.measure("gemm-dsp", [&](benchmark::run& run) { run_GEMM_DSP(GA, GB, GC, side, run); });
+            bool dsp_ok = check_GEMM(GA, GB, GC, side);
+
+            double gflop = 2.0 * side * side * side / 1e9;
+            HETCOMPUTE_ILOG("******CPU -- pgemm %d x %d median time is: %f ms, %f GFLOPS, %s", side, side, bench.get("gemm-cpu").median,
+                            gflop / (bench.get("gemm-cpu").median / 1000.0), cpu_ok ? "correct" : "WRONG");
+            HETCOMPUTE_ILOG("&&&&&&DSP -- matmul %d x %d median time is: %f ms, %f GFLOPS, %s", side, side, bench.get("gemm-dsp").median,
+                            gflop / (bench.get("gemm-dsp").median / 1000.0), dsp_ok ? "correct" : "WRONG");
+            bench.report();
+            goto exit;
+        }
+
         // create the buffers including the devices that will use them
         auto A = hetcompute::create_buffer<int>(array_size, hetcompute::device_set({ hetcompute::dsp, hetcompute::cpu, hetcompute::gpu }));
 
@@ -290,13 +372,13 @@ main(int argc, char *argv[])
             auto B = hetcompute::create_buffer<int>(array_size, hetcompute::device_set({ hetcompute::dsp, hetcompute::cpu, hetcompute::gpu }));
 
             // Begin CPU process matrix []
-            run_CPU(A, B);
+            bench.measure("cpu", [A, B](benchmark::run& run) { run_CPU(A, B, run); });
 
             // Begin GPU process matrix []
-            run_GPU(A, B);
+            bench.measure("gpu", [A, B](benchmark::run& run) { run_GPU(A, B, run); });
 
             // Begin DSP process matrix []
-            run_DSP(A, B);
+            bench.measure("dsp", [A, B](benchmark::run& run) { run_DSP(A, B, run); });
 
             HETCOMPUTE_ILOG("Show all processors serial calc time:");
         } else if (work_method == 2) {
@@ -307,13 +389,18 @@ main(int argc, char *argv[])
             // Init thread mute
             pthread_mutex_init(&mutex_lock,NULL);
 
-            // split array to 3 array for cpu, gpu, dsp
+            // split the buffers in 3 slices for gpu, cpu, dsp, without copying them. The gpu
+            // gets the first slice, which needs no sub-buffer alignment.
             arrayDivisor = array_size / 3;
-            unsigned int* array_buffer = new unsigned int[array_size * sizeof(unsigned int)];
+            auto B = hetcompute::create_buffer<int>(array_size, hetcompute::device_set({ hetcompute::dsp, hetcompute::cpu, hetcompute::gpu }));
+            gpu_partition = partition{ A.slice(0, arrayDivisor), B.slice(0, arrayDivisor) };
+            cpu_partition = partition{ A.slice(arrayDivisor, arrayDivisor), B.slice(arrayDivisor, arrayDivisor) };
+            dsp_partition = partition{ A.slice(2 * arrayDivisor, array_size - (2 * arrayDivisor)),
+                                       B.slice(2 * arrayDivisor, array_size - (2 * arrayDivisor)) };
 
             HETCOMPUTE_ILOG("******************************************************************************************");
-            HETCOMPUTE_ILOG("We will create a in_buffer[%d] and init random value. Then split it to 3 array.", array_size);
-            HETCOMPUTE_ILOG("cpu_buffer[0 to %d], gpu_buffer[%d to %d], dsp_buffer[%d to %d], ", 
+            HETCOMPUTE_ILOG("We will create a in_buffer[%d] and init random value. Then split it to 3 slices.", array_size);
+            HETCOMPUTE_ILOG("gpu_slice[0 to %d], cpu_slice[%d to %d], dsp_slice[%d to %d], ", 
                             arrayDivisor - 1, arrayDivisor, ((2 * arrayDivisor) - 1), (2 * arrayDivisor), array_size - 1);
             HETCOMPUTE_ILOG("CPU & GPU & DSP will running a calculate and recipe runnig %d times.", loop_number);
             HETCOMPUTE_ILOG("out_buffer = in_buffer[i] + in_buffer[i] and out_buffer = in_buffer[i] * in_buffer[i].");
@@ -321,22 +408,19 @@ main(int argc, char *argv[])
 
             // lock the mute for wait create all thread.
             pthread_mutex_lock(&mutex_lock);
-            for (size_t count = 0; count < array_size; count++) {
-                array_buffer[count] = A[count];
-            }
 
             // create cpu, gpu, dsp thread.
-            if (pthread_create(&cpu_thread, NULL, cpu_pthread, (void*)array_buffer)) {
+            if (pthread_create(&cpu_thread, NULL, cpu_pthread, (void*)&cpu_partition)) {
                 HETCOMPUTE_ILOG("error - can't create cpu thread.");
                 goto exit;
             }
 
-            if (pthread_create(&gpu_thread, NULL, gpu_pthread, (void*)array_buffer)) {
+            if (pthread_create(&gpu_thread, NULL, gpu_pthread, (void*)&gpu_partition)) {
                 HETCOMPUTE_ILOG("error - can't create cpu thread.");
                 goto exit;
             }
 
-            if (pthread_create(&dsp_thread, NULL, dsp_pthread, (void*)array_buffer)) {
+            if (pthread_create(&dsp_thread, NULL, dsp_pthread, (void*)&dsp_partition)) {
                 HETCOMPUTE_ILOG("error - can't create cpu thread.");
                 goto exit;
             }
@@ -356,19 +440,23 @@ main(int argc, char *argv[])
                     break;
                 }
             } while (true);
-
-            delete [] array_buffer;
         } else {
-            HETCOMPUTE_ILOG("WARNING: Input processor method is wrong. Please re-input 1 or 2.");
+            HETCOMPUTE_ILOG("WARNING: Input processor method is wrong. Please re-input 1, 2 or 3.");
             goto exit;
         }
 
-        HETCOMPUTE_ILOG("******CPU -- Running CPU calc addition and multiplication %d times and total time is: %ld ms", loop_number, process_calc_time_cpu);
-        HETCOMPUTE_ILOG("@@@@@@GPU -- Running GPU calc addition and multiplication %d times and total time is: %ld ms", loop_number, process_calc_time_gpu);
-        HETCOMPUTE_ILOG("&&&&&&DSP -- Running DSP calc addition and multiplication %d times and total time is: %ld ms", loop_number, process_calc_time_dsp);
+        HETCOMPUTE_ILOG("******CPU -- Running CPU calc addition and multiplication %d times and median time is: %f ms", loop_number, bench.get("cpu").median);
+        HETCOMPUTE_ILOG("@@@@@@GPU -- Running GPU calc addition and multiplication %d times and median time is: %f ms", loop_number, bench.get("gpu").median);
+        HETCOMPUTE_ILOG("&&&&&&DSP -- Running DSP calc addition and multiplication %d times and median time is: %f ms", loop_number, bench.get("dsp").median);
+        bench.report();
     }
 
 exit:
+    // the slices hold on to the buffers
+    cpu_partition = partition();
+    gpu_partition = partition();
+    dsp_partition = partition();
+
     hetcompute::runtime::shutdown();
     return 0;
 }
@@ -0,0 +1,100 @@
+#include <mutex>
+#include <string>
+#include <hetcompute/hetcompute.hh>
+#include <hetcompute/internal/synchronization/condition_variable.hh>
+#include <hetcompute/internal/synchronization/mutex.hh>
+#include "BenchmarkHarness.hh"
+
+#define LOCKS_PER_TASK 20000
+#define PASSES_PER_TASK 500
+#define MAX_TASKS 16
+
+// N tasks hammer one mutex, and then pass a token around a ring of N tasks
+// with one condition_variable, so that every pass wakes up all the waiters.
+// Both block through the futex wait queue once spinning on the mutex fails.
+
+
+// Each task increments a shared counter LOCKS_PER_TASK times under the mutex
+static bool run_mutex(size_t num_tasks)
+{
+    hetcompute::internal::mutex m;
+    size_t counter = 0;
+
+    auto g = hetcompute::create_group();
+    for (size_t t = 0; t < num_tasks; t++) {
+        g->launch([&m, &counter] {
+            for (size_t i = 0; i < LOCKS_PER_TASK; i++) {
+                std::lock_guard<hetcompute::internal::mutex> lock(m);
+                counter++;
+            }
+        });
+    }
+    g->wait_for();
+
+    return counter == num_tasks * LOCKS_PER_TASK;
+}
+
+
+// Task t waits for the token to reach it, passes it on to task t + 1 and
+// wakes up all the tasks, PASSES_PER_TASK times
+static bool run_condition_variable(size_t num_tasks)
+{
+    hetcompute::internal::mutex m;
+    hetcompute::internal::condvar_mutex cv;
+    size_t token = 0;
+    size_t total = num_tasks * PASSES_PER_TASK;
+
+    auto g = hetcompute::create_group();
+    for (size_t t = 0; t < num_tasks; t++) {
+        g->launch([&m, &cv, &token, num_tasks, t] {
+            for (size_t i = 0; i < PASSES_PER_TASK; i++) {
+                std::unique_lock<hetcompute::internal::mutex> lock(m);
+                cv.wait(lock, [&token, num_tasks, t] { return token % num_tasks == t; });
+                token++;
+                lock.unlock();
+                cv.notify_all();
+            }
+        });
+    }
+    g->wait_for();
+
+    return token == total;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_MutexContentionBenchmark");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    benchmark::harness bench("MutexContentionBenchmark");
+    bool ok = true;
+
+    for (size_t num_tasks = 1; num_tasks <= MAX_TASKS; num_tasks *= 2) {
+        std::string mutex_name = "mutex/" + std::to_string(num_tasks);
+        bench.measure(mutex_name, [&](benchmark::run&) { ok = run_mutex(num_tasks) && ok; });
+        bench.set_work(mutex_name, static_cast<double>(num_tasks * LOCKS_PER_TASK), 0);
+
+        std::string cv_name = "condition_variable/" + std::to_string(num_tasks);
+        bench.measure(cv_name, [&](benchmark::run&) { ok = run_condition_variable(num_tasks) && ok; });
+        bench.set_work(cv_name, static_cast<double>(num_tasks * PASSES_PER_TASK), 0);
+
+        HETCOMPUTE_ILOG("%zu tasks: lock/unlock %.1f ns, token pass %.1f us", num_tasks,
+                        bench.get(mutex_name).median * 1e6 / (num_tasks * LOCKS_PER_TASK),
+                        bench.get(cv_name).median * 1e3 / (num_tasks * PASSES_PER_TASK));
+    }
+
+    bench.report();
+    HETCOMPUTE_ILOG("Counters %s", ok ? "correct" : "WRONG");
+
+    hetcompute::runtime::shutdown();
+    return ok ? 0 : 1;
+}
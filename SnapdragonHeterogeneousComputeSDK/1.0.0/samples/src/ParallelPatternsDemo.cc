@@ -1,35 +1,20 @@
 #include <random>
 #include <string.h>
-#include <sys/time.h>
 #include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
 
 #define RANDOM_MAX_VALUE 20000
 #define VEC_MATRIX_SIZE 10
 #define LOOP_NUM 100
+#define SCAN_SIZE (1 << 20)
 
-static float process_calc_time = 0;
+static benchmark::harness bench("ParallelPatternsDemo", benchmark::config::from_environment(2, 10));
 
 
 void matrix_parallel_scan(std::vector<int> inputData);
 void matrix_iteration_process(std::vector<int> DataA, std::vector<int> DataB);
 void matrix_preduce_process(std::vector<int> inputData);
-
-
-long getCurrentTimeMsec()
-{
-    unsigned long msec = 0;
-    char str[20] = {0};
-    struct timeval stuCurrentTime;
-
-    gettimeofday(&stuCurrentTime, NULL);
-    sprintf(str, "%ld%03ld", stuCurrentTime.tv_sec, (stuCurrentTime.tv_usec) / 1000);
-
-    for (int i = 0; i < strlen(str); i++) {
-        msec = msec * 10 + (str[i] - '0');
-    }
-
-    return msec;
-}
+void blocked_scan_process();
 
 
 int
@@ -71,6 +56,11 @@ main(int argc, char *argv[])
     // Summing all matrix[x] value
     matrix_preduce_process(matrixDataA);　　　　            //数组的加和
 
+    // CPU - pscan_exclusive compared with a serial loop on a large array
+    blocked_scan_process();
+
+    bench.report();
+
     hetcompute::runtime::shutdown();
     return 0;
 }
@@ -78,65 +68,79 @@ main(int argc, char *argv[])
 
 void matrix_iteration_process(std::vector<int> DataA, std::vector<int> DataB)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
-
-    int parallel_sum = 0;
-
     // Run parallel calc from pfor_each
-    begin_process_time = getCurrentTimeMsec();
+    auto stats = bench.measure("pfor_each", [&DataA, &DataB](benchmark::run&) {
+        for (size_t x = 0; x < LOOP_NUM; x++) {
 
-    for (size_t x = 0; x < LOOP_NUM; x++) {
+            hetcompute::pfor_each(size_t(0), DataA.size(), [DataA, &DataB](size_t i) {
+                DataB[i] += DataA[i] * 2;
+            });
+        }
+    });
 
-        hetcompute::pfor_each(size_t(0), DataA.size(), [DataA, &DataB](size_t i) {
-            DataB[i] += DataA[i] * 2;
-        });
-    }
-
-    end_process_time = getCurrentTimeMsec();
-    process_calc_time = (float)(end_process_time - begin_process_time);
-
-    HETCOMPUTE_ILOG("matrix_iteration_process function copy matrix A data to B, 100 times consume time: %f ms.", process_calc_time);
+    HETCOMPUTE_ILOG("matrix_iteration_process function copy matrix A data to B, %d times consume time: %f ms (median).", LOOP_NUM, stats.median);
 }
 
 
 void matrix_preduce_process(std::vector<int> inputData)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
-
     const int identity = 0;
     int parallel_sum = 0;
 
     // Run parallel calc from preduce
-    begin_process_time = getCurrentTimeMsec();
-
-    for (size_t x = 0; x < LOOP_NUM; x++) {
-        parallel_sum = hetcompute::preduce(size_t(0), inputData.size(), identity, 
-                                           [inputData](size_t f, size_t l, int& init) {
-                                               for (size_t k = f; k < l; ++k) {
-                                                   init += inputData[k];
-                                               }
-                                           }, 
-                                           std::plus<int>());
-    }
-    end_process_time = getCurrentTimeMsec();
-    process_calc_time = (float)(end_process_time - begin_process_time);
-
-    HETCOMPUTE_ILOG("matrix_preduce_process function matrix[0] + .. + matrix[%d], %d times consume time: %f ms, sum: %d.", 
-        VEC_MATRIX_SIZE - 1, LOOP_NUM, process_calc_time, parallel_sum);
+    auto stats = bench.measure("preduce", [&inputData, &parallel_sum, identity](benchmark::run&) {
+        for (size_t x = 0; x < LOOP_NUM; x++) {
+            parallel_sum = hetcompute::preduce(size_t(0), inputData.size(), identity, 
+                                               [inputData](size_t f, size_t l, int& init) {
+                                                   for (size_t k = f; k < l; ++k) {
+                                                       init += inputData[k];
+                                                   }
+                                               }, 
+                                               std::plus<int>());
+        }
+    });
+
+    HETCOMPUTE_ILOG("matrix_preduce_process function matrix[0] + .. + matrix[%d], %d times consume time: %f ms (median), sum: %d.", 
+        VEC_MATRIX_SIZE - 1, LOOP_NUM, stats.median, parallel_sum);
 }
 
 
 void matrix_parallel_scan(std::vector<int> inputData)
 {
-    unsigned long begin_process_time = 0;
-    unsigned long end_process_time = 0;
+    // Every run scans a fresh copy of the input
+    auto stats = bench.measure("pscan_inclusive", [&inputData](benchmark::run& r) {
+        std::vector<int> data;
+        r.time("copy-in", [&] { data = inputData; });
+        r.time("scan", [&] { hetcompute::pscan_inclusive(data.begin(), data.end(), std::plus<int>()); });
+    });
+
+    HETCOMPUTE_ILOG("matrix_parallel_scan function matrix[x] = matrix[x - 1] + matrix[x]. Consume time: %f ms (median).", stats.median);
+}
+
+
+void blocked_scan_process()
+{
+    std::vector<int> inputData(SCAN_SIZE, 1);
+
+    auto serial = bench.measure("scan_serial", [&inputData](benchmark::run& r) {
+        std::vector<int> data;
+        r.time("copy-in", [&] { data = inputData; });
+        r.time("scan", [&] {
+            int sum = 0;
+            for (size_t i = 0; i < data.size(); i++) {
+                int x = data[i];
+                data[i] = sum;
+                sum += x;
+            }
+        });
+    });
 
-    begin_process_time = getCurrentTimeMsec();
-    hetcompute::pscan_inclusive(inputData.begin(), inputData.end(), std::plus<int>());//向量数组初始化
-    end_process_time = getCurrentTimeMsec();
-    process_calc_time = (float)(end_process_time - begin_process_time);
+    auto blocked = bench.measure("pscan_exclusive", [&inputData](benchmark::run& r) {
+        std::vector<int> data;
+        r.time("copy-in", [&] { data = inputData; });
+        r.time("scan", [&] { hetcompute::pscan_exclusive(data.begin(), data.end(), 0, std::plus<int>()); });
+    });
 
-    HETCOMPUTE_ILOG("matrix_parallel_scan function matrix[x] = matrix[x - 1] + matrix[x]. Consume time: %f ms.", process_calc_time);
-}
\ No newline at end of file
+    HETCOMPUTE_ILOG("blocked_scan_process function exclusive scan of %d elements. Serial: %f ms, pscan_exclusive: %f ms (median).",
+        SCAN_SIZE, serial.median, blocked.median);
+}
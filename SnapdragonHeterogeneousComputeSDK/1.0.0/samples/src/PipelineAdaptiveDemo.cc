@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cmath>
+#include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
+
+#define NUM_ITERATIONS 100000
+#define PARALLEL_DOC 16
+#define TARGET_TASK_US 50
+
+// Runs a fine-grained pipeline, whose stages take well below a microsecond
+// per iteration, first as is, then with tuner::set_adaptive_pipeline(). The
+// adaptive run hands out chunks of iterations of the parallel stage and fuses
+// the cheap serial stages, and reports what it chose for each stage.
+
+using context = hetcompute::pattern::pipeline<>::context;
+
+static float
+work(size_t x, size_t rounds)
+{
+    float f = static_cast<float>(x);
+    for (size_t i = 0; i < rounds; i++) {
+        f = std::sqrt(f + 1.0f);
+    }
+    return f;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_PipelineAdaptiveDemo");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    std::atomic<size_t> checked(0);
+
+    hetcompute::pattern::pipeline<> p;
+    p.add_stage(hetcompute::serial_stage(), [](context& ctx) { return ctx.get_iter_id(); });
+    p.add_stage(hetcompute::parallel_stage(PARALLEL_DOC), [](context&, hetcompute::stage_input<size_t>& in) {
+        return work(in[0], 16);
+    });
+    p.add_stage(hetcompute::serial_stage(), [](context&, hetcompute::stage_input<float>& in) { return in[0] * 2.0f; });
+    p.add_stage(hetcompute::serial_stage(), [&checked](context&, hetcompute::stage_input<float>& in) {
+        if (in[0] > 0.0f) {
+            checked++;
+        }
+    });
+
+    benchmark::harness bench("PipelineAdaptiveDemo");
+
+    bool default_ok = true;
+    bench.measure("default", [&](benchmark::run&) {
+        p.run(NUM_ITERATIONS);
+        default_ok = checked.exchange(0) == NUM_ITERATIONS && default_ok;
+    });
+
+    bool adaptive_ok = true;
+    hetcompute::pattern::tuner t;
+    t.set_adaptive_pipeline(TARGET_TASK_US);
+    bench.measure("adaptive", [&](benchmark::run&) {
+        p.run(NUM_ITERATIONS, t);
+        adaptive_ok = checked.exchange(0) == NUM_ITERATIONS && adaptive_ok;
+    });
+
+    HETCOMPUTE_ILOG("default:  %f ms, %s", bench.get("default").median, default_ok ? "correct" : "WRONG");
+    HETCOMPUTE_ILOG("adaptive: %f ms, %s", bench.get("adaptive").median, adaptive_ok ? "correct" : "WRONG");
+
+    auto stats = p.get_stage_stats();
+    for (size_t i = 0; i < stats.size(); i++) {
+        HETCOMPUTE_ILOG("  stage %zu: %zu iterations in %zu chunks, %llu ns each, chunk size %zu%s", i, stats[i].iterations,
+            stats[i].chunks, static_cast<unsigned long long>(stats[i].iteration_time), stats[i].chunk_size,
+            stats[i].fused_with_next ? ", fused with next" : "");
+    }
+    bench.report();
+
+    hetcompute::runtime::shutdown();
+    return default_ok && adaptive_ok ? 0 : 1;
+}
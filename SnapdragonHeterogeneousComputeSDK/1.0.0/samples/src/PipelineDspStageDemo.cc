@@ -0,0 +1,122 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include <hetcompute/hetcompute.hh>
+#include "BenchmarkHarness.hh"
+
+#define NUM_FRAMES 64
+#define FRAME_SIZE (1 << 16)
+#define FILTER_RADIUS 4
+
+// Runs a three-stage pipeline over NUM_FRAMES frames: a cpu stage generates a
+// frame, a dsp stage box-filters it, and a cpu stage checks the result. The dsp
+// stage runs a host stand-in for the dsp kernel, created with
+// hetcompute::create_dsp_stand_in, so this runs on any host. On a device, the
+// stand-in is replaced by the kernel generated from the IDL, created with
+// hetcompute::create_dsp_kernel, with no other change to the pipeline.
+
+using context = hetcompute::pattern::pipeline<>::context;
+
+// Same signature as a dsp kernel generated from the IDL: the first and the last
+// index of the range, then each buffer as a pointer and a length.
+static int
+box_filter(int first, int last, const float* in, int in_len, float* out, int out_len, int radius)
+{
+    if (in_len != out_len) {
+        return -1;
+    }
+    for (int i = first; i < last; i++) {
+        float sum = 0.0f;
+        int count = 0;
+        for (int j = i - radius; j <= i + radius; j++) {
+            if (j >= 0 && j < in_len) {
+                sum += in[j];
+                count++;
+            }
+        }
+        out[i] = sum / count;
+    }
+    return 0;
+}
+
+static float
+pixel(size_t frame, size_t i)
+{
+    return static_cast<float>((i * 7 + frame * 13) % 256);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    hetcompute::runtime::init();
+
+    if (argc > 1) {
+        HETCOMPUTE_ILOG("********************************************");
+        HETCOMPUTE_ILOG("eg: ./hetcompute_sample_PipelineDspStageDemo");
+        HETCOMPUTE_ILOG("********************************************");
+
+        return -1;
+    }
+
+    // One pair of buffers per frame, so that frames in flight do not share them
+    std::vector<hetcompute::buffer_ptr<float>> in, out;
+    for (size_t f = 0; f < NUM_FRAMES; f++) {
+        in.push_back(hetcompute::create_buffer<float>(FRAME_SIZE));
+        out.push_back(hetcompute::create_buffer<float>(FRAME_SIZE));
+    }
+
+    std::atomic<size_t> num_wrong(0);
+
+    hetcompute::pattern::pipeline<> p;
+
+    p.add_stage(hetcompute::serial_stage(), [&in](context& ctx) {
+        size_t f = ctx.get_iter_id();
+        in[f].acquire_wi();
+        for (size_t i = 0; i < FRAME_SIZE; i++) {
+            in[f][i] = pixel(f, i);
+        }
+        in[f].release();
+        return f;
+    });
+
+    // The lambda before the kernel returns the range and the arguments of the
+    // kernel, the one after it the output of the stage.
+    p.add_dsp_stage(hetcompute::parallel_stage(4),
+        [&in, &out](context&, hetcompute::stage_input<size_t>& frame) {
+            size_t f = frame[0];
+            return std::make_tuple(hetcompute::range<1>(0, FRAME_SIZE), in[f], out[f], FILTER_RADIUS);
+        },
+        hetcompute::create_dsp_stand_in(box_filter),
+        [](context& ctx, std::tuple<hetcompute::range<1>, hetcompute::buffer_ptr<float>, hetcompute::buffer_ptr<float>, int>&) {
+            return ctx.get_iter_id();
+        });
+
+    p.add_stage(hetcompute::serial_stage(), [&out, &num_wrong](context&, hetcompute::stage_input<size_t>& frame) {
+        size_t f = frame[0];
+        std::vector<float> in_f(FRAME_SIZE), expected(FRAME_SIZE);
+        for (size_t i = 0; i < FRAME_SIZE; i++) {
+            in_f[i] = pixel(f, i);
+        }
+        box_filter(0, FRAME_SIZE, in_f.data(), FRAME_SIZE, expected.data(), FRAME_SIZE, FILTER_RADIUS);
+
+        out[f].acquire_ro();
+        for (size_t i = 0; i < FRAME_SIZE; i++) {
+            if (std::fabs(out[f][i] - expected[i]) > 1e-3f) {
+                num_wrong++;
+                break;
+            }
+        }
+        out[f].release();
+    });
+
+    benchmark::harness bench("PipelineDspStageDemo");
+    bench.measure("pipeline", [&](benchmark::run&) { p.run(NUM_FRAMES); });
+
+    HETCOMPUTE_ILOG("%d frames of %d pixels: %f ms, %zu wrong", NUM_FRAMES, FRAME_SIZE, bench.get("pipeline").median,
+        num_wrong.load());
+    bench.report();
+
+    hetcompute::runtime::shutdown();
+    return num_wrong.load() == 0 ? 0 : 1;
+}
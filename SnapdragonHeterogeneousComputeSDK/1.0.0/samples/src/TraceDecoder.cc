@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <hetcompute/internal/log/sharded_buffer.hh>
+
+// Offline decoder for the binary trace written by log::dump_trace_entries()
+// when the HETCOMPUTE_TRACE_FILE environment variable is set. It only needs the
+// headers and the C++ library, so it can also be built for the host:
+//   g++ -std=c++11 -Iinclude samples/src/TraceDecoder.cc
+
+using hetcompute::internal::log::sharded_buffer;
+using hetcompute::internal::log::trace_record;
+
+
+int
+main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::printf("********************************************\n");
+        std::printf("eg: ./hetcompute_sample_TraceDecoder trace.bin\n");
+        std::printf("********************************************\n");
+
+        return -1;
+    }
+
+    std::vector<sharded_buffer::thread_entry> threads;
+    std::vector<trace_record> records;
+    if (!sharded_buffer::read_binary_file(argv[1], threads, records)) {
+        std::printf("Unable to read trace file %s\n", argv[1]);
+        return -1;
+    }
+
+    std::printf("%zu threads, %zu records\n", threads.size(), records.size());
+    for (auto const& thread : threads) {
+        std::printf("t%u\tthread %llx\n", static_cast<unsigned>(thread._thread_index),
+            static_cast<unsigned long long>(thread._thread_hash));
+    }
+
+    if (records.empty()) {
+        return 0;
+    }
+
+    std::map<event_id, size_t> histogram;
+    auto first = records.front()._timestamp;
+    for (auto const& record : records) {
+        std::printf("%s\n", sharded_buffer::to_string(record, first).c_str());
+        histogram[record._event_id]++;
+    }
+
+    std::printf("\nEvent summary:\n");
+    for (auto const& entry : histogram) {
+        std::printf("%-40s %zu\n", sharded_buffer::get_event_name(entry.first), entry.second);
+    }
+    return 0;
+}